@@ -52,6 +52,7 @@
 #include "gjs/gerror-result.h"
 #include "gjs/jsapi-class.h"
 #include "gjs/jsapi-util.h"
+#include "gjs/profiler-private.h"
 #include "util/log.h"
 
 using mozilla::Maybe, mozilla::Some;
@@ -332,10 +333,32 @@ void BoxedInstance<Base, Prototype, Instance>::copy_memory(Instance* source) {
     copy_memory(source->ptr());
 }
 
+// Records the creation of this wrapper in the profile, if allocations are
+// being sampled
+template <class Base, class Prototype, class Instance>
+void BoxedInstance<Base, Prototype, Instance>::record_allocation(
+    JSContext* cx) const {
+    GjsProfiler* profiler = GjsContextPrivate::from_cx(cx)->profiler();
+    if (!profiler || !gjs_profiler_sample_allocation(profiler))
+        return;
+
+    std::string label{Base::DEBUG_TAG};
+    label += " wrapper ";
+    label += format_name();
+    gjs_profiler_add_allocation(profiler, m_ptr, info().size(), label.c_str());
+}
+
 // See GIWrapperBase::constructor().
 template <class Base, class Prototype, class Instance>
 bool BoxedInstance<Base, Prototype, Instance>::constructor_impl(
     JSContext* cx, JS::HandleObject obj, const JS::CallArgs& args) {
+    // If construction is delegated to a JS constructor, the pointer stays null
+    // and the wrapper that it returns is recorded instead
+    auto record = mozilla::MakeScopeExit([this, cx]() {
+        if (m_ptr)
+            record_allocation(cx);
+    });
+
     // Short-circuit copy-construction in the case where we can use copy_boxed()
     // or copy_memory()
     Base* source_priv;
@@ -921,6 +944,7 @@ JSObject* BoxedInstance<Base, Prototype, Instance>::new_for_c_struct_impl(
     if (!priv->init_from_c_struct(cx, gboxed, std::forward<Args>(args)...))
         return nullptr;
 
+    priv->record_allocation(cx);
     return obj;
 }
 
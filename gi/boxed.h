@@ -208,6 +208,7 @@ class BoxedInstance : public GIWrapperInstance<Base, Prototype, Instance> {
 
     // Helper methods
 
+    void record_allocation(JSContext*) const;
     GJS_JSAPI_RETURN_CONVENTION
     bool invoke_static_method(JSContext*, JS::HandleObject,
                               JS::HandleId method_name, const JS::CallArgs&);
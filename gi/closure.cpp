@@ -6,8 +6,14 @@
 
 #include <config.h>
 
+#include <memory>   // for unique_ptr, make_unique
+#include <utility>  // for move
+
+#include <glib-object.h>
 #include <glib.h>  // for g_assert
 
+#include <mozilla/Maybe.h>
+
 #include <js/CallAndConstruct.h>
 #include <js/Realm.h>
 #include <js/RootingAPI.h>
@@ -15,7 +21,9 @@
 #include <js/Value.h>
 
 #include "gi/closure.h"
+#include "gi/gjs_gi_trace.h"
 #include "gjs/context-private.h"
+#include "gjs/cross-thread-queue.h"
 #include "gjs/jsapi-util-root.h"
 #include "gjs/jsapi-util.h"
 #include "gjs/mem-private.h"
@@ -128,6 +136,7 @@ void Closure::global_context_finalized() {
  */
 void Closure::closure_invalidated() {
     GJS_DEC_COUNTER(closure);
+    TRACE(GJS_CLOSURE_INVALIDATE(this, /* is_signal = */ false));
     gjs_debug_closure("Invalidating closure %p which calls callable %p", this,
                       m_callable.debug_addr());
 
@@ -151,6 +160,7 @@ void Closure::closure_invalidated() {
 }
 
 void Closure::closure_set_invalid() {
+    TRACE(GJS_CLOSURE_INVALIDATE(this, /* is_signal = */ true));
     gjs_debug_closure("Invalidating signal closure %p which calls callable %p",
                       this, m_callable.debug_addr());
 
@@ -199,4 +209,72 @@ bool Closure::invoke(JS::HandleObject this_obj,
     return true;
 }
 
+/* Called when a signal is emitted on a thread other than the one owning the
+ * JSContext. If the context was set up to forward such calls, copies the
+ * parameters and queues the emission to be marshalled on the owner thread.
+ * Returns false if the emission cannot be forwarded (if the signal has a return
+ * value or gpointer parameters), in which case it will be blocked. */
+bool Closure::forward_to_owner_thread(GjsContextPrivate* gjs,
+                                      GValue* return_value,
+                                      unsigned n_param_values,
+                                      const GValue* param_values,
+                                      void* invocation_hint,
+                                      void* marshal_data) {
+    CrossThreadQueue* queue = gjs->cross_thread_queue();
+    if (!queue)
+        return false;
+
+    // The emitting thread cannot wait for the handler's return value
+    if (return_value)
+        return false;
+
+    // g_value_copy() only copies the address of a plain pointer, which may not
+    // be valid any more once the emission has returned
+    for (unsigned ix = 0; ix < n_param_values; ix++) {
+        if (G_TYPE_FUNDAMENTAL(G_VALUE_TYPE(&param_values[ix])) ==
+            G_TYPE_POINTER)
+            return false;
+    }
+
+    struct DeferredMarshal : CrossThreadQueue::Call {
+        Closure::Ptr closure;
+        unsigned n_values;
+        std::unique_ptr<GValue[]> values;
+        mozilla::Maybe<GSignalInvocationHint> hint;
+        void* marshal_data;
+
+        DeferredMarshal(Closure* c, unsigned n, const GValue* params,
+                        void* invocation_hint, void* data)
+            : closure(c, TakeOwnership{}),
+              n_values(n),
+              values(std::make_unique<GValue[]>(n)),
+              marshal_data(data) {
+            for (unsigned ix = 0; ix < n; ix++) {
+                values[ix] = G_VALUE_INIT;
+                g_value_init(&values[ix], G_VALUE_TYPE(&params[ix]));
+                g_value_copy(&params[ix], &values[ix]);
+            }
+            if (invocation_hint)
+                hint.emplace(
+                    *static_cast<GSignalInvocationHint*>(invocation_hint));
+        }
+
+        ~DeferredMarshal() override {
+            for (unsigned ix = 0; ix < n_values; ix++)
+                g_value_unset(&values[ix]);
+        }
+
+        void run() override {
+            closure->marshal(nullptr, n_values, values.get(),
+                             hint ? hint.ptr() : nullptr, marshal_data);
+        }
+    };
+
+    gjs_debug_closure("Forwarding marshal of closure %p from thread %p", this,
+                      g_thread_self());
+
+    return queue->enqueue(std::make_unique<DeferredMarshal>(
+        this, n_param_values, param_values, invocation_hint, marshal_data));
+}
+
 }  // namespace Gjs
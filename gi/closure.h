@@ -21,6 +21,7 @@
 #include "gjs/jsapi-util-root.h"
 #include "gjs/macros.h"
 
+class GjsContextPrivate;
 class JSTracer;
 namespace JS {
 class HandleValueArray;
@@ -118,6 +119,11 @@ class Closure : public GClosure {
     void marshal(GValue* return_value, unsigned n_param_values,
                  const GValue* param_values, void* invocation_hint,
                  void* marshal_data);
+    [[nodiscard]]
+    bool forward_to_owner_thread(GjsContextPrivate*, GValue* return_value,
+                                 unsigned n_param_values,
+                                 const GValue* param_values,
+                                 void* invocation_hint, void* marshal_data);
 
     //  The saved context is used for lifetime management, so that the closure
     //  will be torn down with the context that created it.
@@ -11,7 +11,8 @@
 #include <sstream>
 #include <string>
 #include <type_traits>
-#include <utility>  // for move
+#include <unordered_set>
+#include <utility>  // for move, exchange
 #include <vector>
 
 #ifndef G_DISABLE_ASSERT
@@ -19,6 +20,7 @@
 #endif
 
 #include <ffi.h>
+#include <gio/gio.h>
 #include <girepository/girepository.h>
 #include <girepository/girffi.h>
 #include <glib-object.h>
@@ -30,6 +32,7 @@
 #include <js/ErrorReport.h>  // for JS_ReportOutOfMemory
 #include <js/Exception.h>
 #include <js/HeapAPI.h>  // for RuntimeHeapIsCollecting
+#include <js/Promise.h>
 #include <js/PropertyAndElement.h>
 #include <js/PropertyDescriptor.h>  // for JSPROP_PERMANENT
 #include <js/PropertySpec.h>
@@ -57,12 +60,15 @@
 #include "gi/cwrapper.h"
 #include "gi/function.h"
 #include "gi/gerror.h"
+#include "gi/gjs_gi_trace.h"
 #include "gi/info.h"
 #include "gi/inline-array.h"
 #include "gi/object.h"
 #include "gi/utils-inl.h"
 #include "gjs/auto.h"
+#include "gjs/call-stats.h"
 #include "gjs/context-private.h"
+#include "gjs/cross-thread-queue.h"
 #include "gjs/gerror-result.h"
 #include "gjs/global.h"
 #include "gjs/jsapi-util.h"
@@ -93,6 +99,8 @@ class Function : public CWrapper<Function> {
     uint8_t m_js_in_argc = 0;
     uint8_t m_js_out_argc = 0;
     GIFunctionInvoker m_invoker{};
+    // Looked up on the first call if GJS_CALL_STATS is set
+    CallStats::Entry* m_call_stats = nullptr;
 
     explicit Function(const GI::CallableInfo& info) : m_info(info) {
         GJS_INC_COUNTER(function);
@@ -139,10 +147,46 @@ class Function : public CWrapper<Function> {
     bool to_string_impl(JSContext* cx, JS::MutableHandleValue rval);
 
     GJS_JSAPI_RETURN_CONVENTION
-    bool finish_invoke(JSContext* cx, const JS::CallArgs& args,
+    bool check_js_argc(JSContext* cx, const JS::CallArgs& args);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool marshal_instance_in(JSContext* cx, JS::HandleObject obj,
+                             GjsFunctionCallState* state,
+                             void** ffi_arg_pointers,
+                             ObjectBase** gobject_instance);
+
+    [[nodiscard]]
+    const char* profiler_label(JSContext*, const ObjectBase* gobject_instance);
+
+    [[nodiscard]] CallStats::Entry* call_stats(JSContext*);
+
+    unsigned marshal_args_in(JSContext* cx, const JS::CallArgs& args,
+                             GjsFunctionCallState* state,
+                             void** ffi_arg_pointers);
+
+    void marshal_out(JSContext* cx, GjsFunctionCallState* state,
+                     GIArgument* r_value = nullptr);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool finish_invoke(JSContext* cx, JS::MutableHandleValue rval,
                        GjsFunctionCallState* state,
                        GIArgument* r_value = nullptr);
 
+    struct ThreadCall;
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool can_call_in_thread(JSContext* cx);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool call_in_thread_impl(JSContext* cx, JS::HandleObject function,
+                             const JS::CallArgs& args);
+
+    static void on_thread_call_done(GObject*, GAsyncResult*, void* data);
+    static void on_thread_call_context_destroyed(JSContext*, void* data);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    static bool call_in_thread(JSContext* cx, unsigned argc, JS::Value* vp);
+
     GJS_JSAPI_RETURN_CONVENTION
     static JSObject* inherit_builtin_function(JSContext* cx, JSProtoKey) {
         JS::RootedObject builtin_function_proto(
@@ -331,6 +375,9 @@ void GjsCallbackTrampoline::callback_closure(GIArgument** args, void* result) {
     }
 
     if (G_UNLIKELY(!gjs->is_owner_thread())) {
+        if (forward_to_owner_thread(gjs, args))
+            return;
+
         warn_about_illegal_js_callback("on a different thread",
                                        "an API not intended to be used in JS",
                                        false);
@@ -412,6 +459,174 @@ void GjsCallbackTrampoline::callback_closure(GIArgument** args, void* result) {
     }
 }
 
+template <typename TAG>
+static inline void copy_basic_arg(GIArgument* src, GIArgument* dest) {
+    gjs_arg_member<TAG>(dest) = gjs_arg_member<TAG>(src);
+}
+
+/* Called when an async callback is invoked on a thread other than the one
+ * owning the JSContext. If the context was set up to forward such calls, takes
+ * a copy of the arguments (a reference for GObjects and a duplicate for
+ * strings not owned by the callback) and queues the call to be run on the
+ * owner thread. Returns false if the call cannot be forwarded, in which case it
+ * will be blocked. */
+bool GjsCallbackTrampoline::forward_to_owner_thread(GjsContextPrivate* gjs,
+                                                    GIArgument** args) {
+    Gjs::CrossThreadQueue* queue = gjs->cross_thread_queue();
+    if (!queue)
+        return false;
+
+    // Only async callbacks may be deferred; the caller cannot wait for a
+    // return value, out arguments, or an error
+    if (m_scope != GI_SCOPE_TYPE_ASYNC || m_is_vfunc ||
+        m_info.can_throw_gerror())
+        return false;
+
+    GI::StackTypeInfo ret_type;
+    m_info.load_return_type(&ret_type);
+    if (ret_type.tag() != GI_TYPE_TAG_VOID)
+        return false;
+
+    enum class Copy : uint8_t { NONE, GOBJECT, STRING };
+
+    struct DeferredCallback : Gjs::CrossThreadQueue::Call {
+        Gjs::Closure::Ptr trampoline;
+        std::vector<GIArgument> values;
+        std::vector<Copy> copies;
+
+        DeferredCallback(GjsCallbackTrampoline* self, unsigned n_args)
+            : trampoline(self, Gjs::TakeOwnership{}),
+              values(n_args),
+              copies(n_args, Copy::NONE) {}
+
+        ~DeferredCallback() override {
+            for (size_t ix = 0; ix < values.size(); ix++) {
+                if (copies[ix] == Copy::GOBJECT)
+                    g_clear_object(&gjs_arg_member<GObject*>(&values[ix]));
+                else if (copies[ix] == Copy::STRING)
+                    g_clear_pointer(&gjs_arg_member<char*>(&values[ix]),
+                                    g_free);
+            }
+        }
+
+        void run() override {
+            std::vector<GIArgument*> arg_pointers(values.size());
+            for (size_t ix = 0; ix < values.size(); ix++)
+                arg_pointers[ix] = &values[ix];
+
+            GIFFIReturnValue unused_result;
+            trampoline.as<GjsCallbackTrampoline>()->callback_closure(
+                arg_pointers.data(), &unused_result);
+        }
+    };
+
+    unsigned n_args = m_info.n_args();
+    auto deferred = std::make_unique<DeferredCallback>(this, n_args);
+
+    for (unsigned i = 0; i < n_args; i++) {
+        GI::StackArgInfo arg_info;
+        GI::StackTypeInfo type_info;
+        m_info.load_arg(i, &arg_info);
+        arg_info.load_type(&type_info);
+
+        if (arg_info.direction() != GI_DIRECTION_IN)
+            return false;
+
+        GIArgument* src = args[i];
+        GIArgument* dest = &deferred->values[i];
+        bool owned = arg_info.ownership_transfer() != GI_TRANSFER_NOTHING;
+
+        switch (type_info.tag()) {
+            case GI_TYPE_TAG_BOOLEAN:
+                copy_basic_arg<Gjs::Tag::GBoolean>(src, dest);
+                continue;
+            case GI_TYPE_TAG_INT8:
+                copy_basic_arg<int8_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_UINT8:
+                copy_basic_arg<uint8_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_INT16:
+                copy_basic_arg<int16_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_UINT16:
+                copy_basic_arg<uint16_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_INT32:
+                copy_basic_arg<int32_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_UINT32:
+                copy_basic_arg<uint32_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_INT64:
+                copy_basic_arg<int64_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_UINT64:
+                copy_basic_arg<uint64_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_FLOAT:
+                copy_basic_arg<float>(src, dest);
+                continue;
+            case GI_TYPE_TAG_DOUBLE:
+                copy_basic_arg<double>(src, dest);
+                continue;
+            case GI_TYPE_TAG_UNICHAR:
+                copy_basic_arg<char32_t>(src, dest);
+                continue;
+            case GI_TYPE_TAG_GTYPE:
+                copy_basic_arg<Gjs::Tag::GType>(src, dest);
+                continue;
+            case GI_TYPE_TAG_VOID:
+                // user_data and other opaque pointers are passed through
+                copy_basic_arg<void*>(src, dest);
+                continue;
+            case GI_TYPE_TAG_UTF8:
+            case GI_TYPE_TAG_FILENAME:
+                if (owned) {
+                    copy_basic_arg<char*>(src, dest);
+                } else {
+                    gjs_arg_set(dest, g_strdup(gjs_arg_get<char*>(src)));
+                    deferred->copies[i] = Copy::STRING;
+                }
+                continue;
+            case GI_TYPE_TAG_INTERFACE: {
+                GI::AutoBaseInfo interface_info{type_info.interface()};
+                if (interface_info.is_enum_or_flags()) {
+                    copy_basic_arg<Gjs::Tag::Enum>(src, dest);
+                    continue;
+                }
+                if (owned) {
+                    copy_basic_arg<void*>(src, dest);
+                    continue;
+                }
+                if (!interface_info.is_object() &&
+                    !interface_info.is_interface())
+                    return false;
+                void* instance = gjs_arg_get<void*>(src);
+                if (instance && !G_IS_OBJECT(instance))
+                    return false;
+                if (instance)
+                    g_object_ref(instance);
+                gjs_arg_set(dest, instance);
+                deferred->copies[i] = Copy::GOBJECT;
+                continue;
+            }
+            default:
+                // Containers must be owned by the callback, otherwise they
+                // may be gone by the time the owner thread gets to them
+                if (!owned)
+                    return false;
+                copy_basic_arg<void*>(src, dest);
+                continue;
+        }
+    }
+
+    gjs_debug_closure("Forwarding callback %s() from thread %p", m_info.name(),
+                      g_thread_self());
+
+    return queue->enqueue(std::move(deferred));
+}
+
 inline GIArgument* get_argument_for_arg_info(const GI::ArgInfo& arg_info,
                                              GIArgument** args, int index) {
     if (!arg_info.caller_allocates())
@@ -794,6 +1009,19 @@ bool GjsCallbackTrampoline::initialize() {
     }
 
     m_closure = create_closure();
+
+    if (m_closure && gjs_perf_map_is_enabled()) {
+        std::string label{m_is_vfunc ? "GJS vfunc " : "GJS callback "};
+        label += m_info.ns();
+        label += '.';
+        if (auto container = m_info.container()) {
+            label += container->name();
+            label += '.';
+        }
+        label += m_info.name();
+        gjs_perf_map_add(get_func_ptr(), FFI_TRAMPOLINE_SIZE, label.c_str());
+    }
+
     return true;
 }
 
@@ -812,6 +1040,37 @@ std::string Gjs::Function::format_name() {
     return retval;
 }
 
+// Label for the profiling stack, e.g. "Gtk.Button.method Gtk.Widget.show".
+// The GObject class is that of the instance, so it is part of the key.
+const char* Gjs::Function::profiler_label(JSContext* cx,
+                                          const ObjectBase* gobject_instance) {
+    if (!js::GetContextProfilingStackIfEnabled(cx))
+        return "";
+
+    GType gtype = gobject_instance ? gobject_instance->gtype() : G_TYPE_NONE;
+    auto container = m_info.container();
+    Gjs::ProfilerLabelKey key{
+        gtype, container ? container->name() : m_info.ns(), m_info.name()};
+    return Gjs::profiler_label(cx, key, [this, gobject_instance]() {
+        std::string label = gobject_instance
+                                ? gobject_instance->format_name()
+                                : std::string{"(unknown)"};
+        return label + '.' + format_name();
+    });
+}
+
+// Statistics slot for GJS_CALL_STATS, shared by all Function objects for the
+// same callable, or null if statistics are not enabled
+Gjs::CallStats::Entry* Gjs::Function::call_stats(JSContext* cx) {
+    if (m_call_stats)
+        return m_call_stats;
+
+    CallStats* stats = GjsContextPrivate::from_cx(cx)->call_stats();
+    if (stats)
+        m_call_stats = stats->entry(format_name());
+    return m_call_stats;
+}
+
 namespace Gjs {
 
 static void* get_return_ffi_pointer_from_gi_argument(
@@ -857,22 +1116,8 @@ static void* get_return_ffi_pointer_from_gi_argument(
     }
 }
 
-// This function can be called in two different ways. You can either use it to
-// create JavaScript objects by calling it without @r_value, or you can decide
-// to keep the return values in GIArgument format by providing a @r_value
-// argument.
-bool Function::invoke(JSContext* cx, const JS::CallArgs& args,
-                      JS::HandleObject this_obj /* = nullptr */,
-                      GIArgument* r_value /* = nullptr */) {
-    g_assert((args.isConstructing() || !this_obj) &&
-             "If not a constructor, then pass the 'this' object via CallArgs");
-
-    GIFFIReturnValue return_value;
-
-    unsigned ffi_argc = m_invoker.cif.nargs;
-    GjsFunctionCallState state{cx, m_info};
-
-    if (state.gi_argc > Argument::MAX_ARGS) {
+bool Function::check_js_argc(JSContext* cx, const JS::CallArgs& args) {
+    if (m_info.n_args() > Argument::MAX_ARGS) {
         gjs_throw(cx, "Function %s has too many arguments",
                   format_name().c_str());
         return false;
@@ -894,80 +1139,68 @@ bool Function::invoke(JSContext* cx, const JS::CallArgs& args,
         return false;
     }
 
-    // These arrays hold argument pointers.
-    // - state.in_cvalue(): C values which are passed on input (in or inout)
-    // - state.out_cvalue(): C values which are returned as arguments (out or
-    //   inout)
-    // - state.inout_original_cvalue(): For the special case of (inout) args,
-    //   we need to keep track of the original values we passed into the
-    //   function, in case we need to free it.
-    // - ffi_arg_pointers: For passing data to FFI, we need to create another
-    //   layer of indirection; this array is a pointer to an element in
-    //   state.in_cvalue() or state.out_cvalue().
-    // - return_value: The actual return value of the C function, i.e. not an
-    //   (out) param
-    //
-    // The 3 GIArgument arrays are indexed by the GI argument index.
-    // ffi_arg_pointers, on the other hand, represents the actual C arguments,
-    // in the way ffi expects them.
+    return true;
+}
 
-    Gjs::InlineArray<void*, 8> ffi_arg_pointers;
-    ffi_arg_pointers.allocate(ffi_argc);
+// Marshals the instance parameter, if any, into the first FFI argument.
+// Returns false if it fails before anything needs to be released.
+bool Function::marshal_instance_in(JSContext* cx, JS::HandleObject obj,
+                                   GjsFunctionCallState* state,
+                                   void** ffi_arg_pointers,
+                                   ObjectBase** gobject_instance) {
+    state->processed_c_args = 0;
+    if (!state->is_method)
+        return true;
 
-    int gi_arg_pos = 0;        // index into GIArgument array
-    unsigned ffi_arg_pos = 0;  // index into ffi_arg_pointers
-    unsigned js_arg_pos = 0;   // index into args
+    GIArgument* in_value = state->instance();
+    JS::RootedValue in_js_value{cx, JS::ObjectValue(*obj)};
 
-    JS::RootedObject obj{cx, this_obj};
-    if (!args.isConstructing() && !args.computeThis(cx, &obj))
+    if (!m_arguments.instance().value()->in(cx, state, in_value, in_js_value))
         return false;
 
-    std::string dynamicString("(unknown)");
-
-    if (state.is_method) {
-        GIArgument* in_value = state.instance();
-        JS::RootedValue in_js_value{cx, JS::ObjectValue(*obj)};
+    ffi_arg_pointers[0] = in_value;
+    state->processed_c_args = 1;
 
-        if (!m_arguments.instance().value()->in(cx, &state, in_value,
-                                                in_js_value))
-            return false;
+    // Callback lifetimes will be attached to the instance object if it is a
+    // GObject or GInterface
+    Maybe<GType> gtype = m_arguments.instance_type();
+    if (gtype) {
+        if (g_type_is_a(*gtype, G_TYPE_OBJECT) ||
+            g_type_is_a(*gtype, G_TYPE_INTERFACE))
+            state->instance_object = obj;
 
-        ffi_arg_pointers[ffi_arg_pos] = in_value;
-        ++ffi_arg_pos;
-
-        // Callback lifetimes will be attached to the instance object if it is
-        // a GObject or GInterface
-        Maybe<GType> gtype = m_arguments.instance_type();
-        if (gtype) {
-            if (g_type_is_a(*gtype, G_TYPE_OBJECT) ||
-                g_type_is_a(*gtype, G_TYPE_INTERFACE))
-                state.instance_object = obj;
-
-            if (g_type_is_a(*gtype, G_TYPE_OBJECT)) {
-                auto* o = ObjectBase::for_js(cx, obj);
-                dynamicString =
-                    GJS_PROFILER_DYNAMIC_STRING(cx, o->format_name());
-            }
-        }
+        if (g_type_is_a(*gtype, G_TYPE_OBJECT))
+            *gobject_instance = ObjectBase::for_js(cx, obj);
     }
-    std::string full_name{
-        GJS_PROFILER_DYNAMIC_STRING(cx, dynamicString + "." + format_name())};
-    AutoProfilerLabel label{cx, "", full_name};
 
-    g_assert(ffi_arg_pos + state.gi_argc <
-             std::numeric_limits<decltype(state.processed_c_args)>::max());
+    return true;
+}
 
-    state.processed_c_args = ffi_arg_pos;
-    for (gi_arg_pos = 0; gi_arg_pos < state.gi_argc;
+// Marshals the JS arguments into C values, starting after the instance
+// parameter. Sets state->failed if a conversion fails; in that case the
+// arguments processed so far must still be released with finish_invoke().
+// Returns the index of the next FFI argument.
+unsigned Function::marshal_args_in(JSContext* cx, const JS::CallArgs& args,
+                                   GjsFunctionCallState* state,
+                                   void** ffi_arg_pointers) {
+    unsigned ffi_argc GJS_USED_VERBOSE_MARSHAL = m_invoker.cif.nargs;
+    unsigned ffi_arg_pos = state->processed_c_args;
+    unsigned js_arg_pos = 0;  // index into args
+    int gi_arg_pos = 0;       // index into GIArgument array
+
+    g_assert(ffi_arg_pos + state->gi_argc <
+             std::numeric_limits<decltype(state->processed_c_args)>::max());
+
+    for (gi_arg_pos = 0; gi_arg_pos < state->gi_argc;
          gi_arg_pos++, ffi_arg_pos++) {
-        GIArgument* in_value = &state.in_cvalue(gi_arg_pos);
+        GIArgument* in_value = &state->in_cvalue(gi_arg_pos);
         Argument* gjs_arg = m_arguments.argument(gi_arg_pos);
 
         gjs_debug_marshal(GJS_DEBUG_GFUNCTION,
                           "Marshalling argument '%s' in, %d/%d GI args, %u/%u "
                           "C args, %u/%u JS args",
                           gjs_arg ? gjs_arg->arg_name() : "<unknown>",
-                          gi_arg_pos, state.gi_argc, ffi_arg_pos, ffi_argc,
+                          gi_arg_pos, state->gi_argc, ffi_arg_pos, ffi_argc,
                           js_arg_pos, args.length());
 
         ffi_arg_pointers[ffi_arg_pos] = in_value;
@@ -980,7 +1213,7 @@ bool Function::invoke(JSContext* cx, const JS::CallArgs& args,
                       "to the '%s' argument. It may be that the function is "
                       "unsupported, or there may be a bug in its annotations.",
                       format_name().c_str(), arg_info.name());
-            state.failed = true;
+            state->failed = true;
             break;
         }
 
@@ -988,74 +1221,44 @@ bool Function::invoke(JSContext* cx, const JS::CallArgs& args,
         if (js_arg_pos < args.length())
             js_in_arg = args[js_arg_pos];
 
-        if (!gjs_arg->in(cx, &state, in_value, js_in_arg)) {
-            state.failed = true;
+        if (!gjs_arg->in(cx, state, in_value, js_in_arg)) {
+            state->failed = true;
             break;
         }
 
         if (!gjs_arg->skip_in())
             js_arg_pos++;
 
-        state.processed_c_args++;
-    }
-
-    // This pointer needs to exist on the stack across the ffi_call() call
-    GError** errorp = &state.local_error;
-
-    /* Did argument conversion fail? In that case, skip invocation and jump to
-     * release processing. */
-    if (state.failed)
-        return finish_invoke(cx, args, &state, r_value);
-
-    if (state.can_throw_gerror) {
-        g_assert(ffi_arg_pos < ffi_argc && "GError** argument number mismatch");
-        ffi_arg_pointers[ffi_arg_pos] = &errorp;
-        ffi_arg_pos++;
-
-        /* don't update state.processed_c_args as we deal with local_error
-         * separately */
+        state->processed_c_args++;
     }
 
-    g_assert_cmpuint(ffi_arg_pos, ==, ffi_argc);
-    g_assert_cmpuint(gi_arg_pos, ==, state.gi_argc);
+    if (!state->failed)
+        g_assert_cmpuint(gi_arg_pos, ==, state->gi_argc);
 
-    Maybe<Arg::ReturnTag> return_tag = m_arguments.return_tag();
-    // return_value_p will point inside the return GIFFIReturnValue union if the
-    // C function has a non-void return type
-    void* return_value_p =
-        get_return_ffi_pointer_from_gi_argument(return_tag, &return_value);
-    ffi_call(&m_invoker.cif, FFI_FN(m_invoker.native_address), return_value_p,
-             ffi_arg_pointers.get());
-
-    /* Return value and out arguments are valid only if invocation doesn't
-     * return error. In arguments need to be released always.
-     */
-
-    if (return_tag) {
-        gi_type_tag_extract_ffi_return_value(
-            return_tag->tag(), return_tag->interface_gtype(), &return_value,
-            state.return_value());
-    }
+    return ffi_arg_pos;
+}
 
-    // Process out arguments and return values. This loop is skipped if we fail
-    // the type conversion above, or if state.did_throw_gerror is true.
-    js_arg_pos = 0;
-    for (gi_arg_pos = -1; gi_arg_pos < state.gi_argc; gi_arg_pos++) {
+// Process out arguments and return values. Sets state->failed if a conversion
+// fails.
+void Function::marshal_out(JSContext* cx, GjsFunctionCallState* state,
+                           GIArgument* r_value) {
+    unsigned js_arg_pos = 0;
+    for (int gi_arg_pos = -1; gi_arg_pos < state->gi_argc; gi_arg_pos++) {
         Maybe<Argument*> gjs_arg;
         GIArgument* out_value;
 
         if (gi_arg_pos == -1) {
-            out_value = state.return_value();
+            out_value = state->return_value();
             gjs_arg = m_arguments.return_value();
         } else {
-            out_value = &state.out_cvalue(gi_arg_pos);
+            out_value = &state->out_cvalue(gi_arg_pos);
             gjs_arg = Some(m_arguments.argument(gi_arg_pos));
         }
 
         gjs_debug_marshal(
             GJS_DEBUG_GFUNCTION, "Marshalling argument '%s' out, %d/%d GI args",
             gjs_arg.map(std::mem_fn(&Argument::arg_name)).valueOr("<unknown>"),
-            gi_arg_pos, state.gi_argc);
+            gi_arg_pos, state->gi_argc);
 
         JS::RootedValue js_out_arg{cx};
         if (!r_value) {
@@ -1068,22 +1271,22 @@ bool Function::invoke(JSContext* cx, const JS::CallArgs& args,
                     "to the out '%s' argument. It may be that the function is "
                     "unsupported, or there may be a bug in its annotations.",
                     format_name().c_str(), arg_info.name());
-                state.failed = true;
+                state->failed = true;
                 break;
             }
 
             if (gjs_arg &&
-                !(*gjs_arg)->out(cx, &state, out_value, &js_out_arg)) {
-                state.failed = true;
+                !(*gjs_arg)->out(cx, state, out_value, &js_out_arg)) {
+                state->failed = true;
                 break;
             }
         }
 
         if (gjs_arg && !(*gjs_arg)->skip_out()) {
             if (!r_value) {
-                if (!state.return_values.append(js_out_arg)) {
+                if (!state->return_values.append(js_out_arg)) {
                     JS_ReportOutOfMemory(cx);
-                    state.failed = true;
+                    state->failed = true;
                     break;
                 }
             }
@@ -1091,17 +1294,396 @@ bool Function::invoke(JSContext* cx, const JS::CallArgs& args,
         }
     }
 
-    g_assert(state.failed || state.did_throw_gerror() ||
+    g_assert(state->failed || state->did_throw_gerror() ||
              js_arg_pos == m_js_out_argc);
+}
+
+// This function can be called in two different ways. You can either use it to
+// create JavaScript objects by calling it without @r_value, or you can decide
+// to keep the return values in GIArgument format by providing a @r_value
+// argument.
+bool Function::invoke(JSContext* cx, const JS::CallArgs& args,
+                      JS::HandleObject this_obj /* = nullptr */,
+                      GIArgument* r_value /* = nullptr */) {
+    g_assert((args.isConstructing() || !this_obj) &&
+             "If not a constructor, then pass the 'this' object via CallArgs");
+
+    GIFFIReturnValue return_value;
+
+    unsigned ffi_argc = m_invoker.cif.nargs;
+
+    AutoCallTimer timer{cx, call_stats(cx)};
+
+    if (TRACE_ENABLED(GJS_GI_FUNCTION_ENTRY)) {
+        auto container = m_info.container();
+        TRACE(GJS_GI_FUNCTION_ENTRY(m_invoker.native_address, m_info.ns(),
+                                    container ? container->name() : "",
+                                    m_info.name()));
+    }
+    auto trace_return = mozilla::MakeScopeExit(
+        [&]() { TRACE(GJS_GI_FUNCTION_RETURN(m_invoker.native_address)); });
+
+    if (!check_js_argc(cx, args))
+        return false;
+
+    GjsFunctionCallState state{cx, m_info};
+
+    // These arrays hold argument pointers.
+    // - state.in_cvalue(): C values which are passed on input (in or inout)
+    // - state.out_cvalue(): C values which are returned as arguments (out or
+    //   inout)
+    // - state.inout_original_cvalue(): For the special case of (inout) args,
+    //   we need to keep track of the original values we passed into the
+    //   function, in case we need to free it.
+    // - ffi_arg_pointers: For passing data to FFI, we need to create another
+    //   layer of indirection; this array is a pointer to an element in
+    //   state.in_cvalue() or state.out_cvalue().
+    // - return_value: The actual return value of the C function, i.e. not an
+    //   (out) param
+    //
+    // The 3 GIArgument arrays are indexed by the GI argument index.
+    // ffi_arg_pointers, on the other hand, represents the actual C arguments,
+    // in the way ffi expects them.
+
+    Gjs::InlineArray<void*, 8> ffi_arg_pointers;
+    ffi_arg_pointers.allocate(ffi_argc);
+
+    JS::RootedObject obj{cx, this_obj};
+    if (!args.isConstructing() && !args.computeThis(cx, &obj))
+        return false;
+
+    ObjectBase* gobject_instance = nullptr;
+    if (!marshal_instance_in(cx, obj, &state, ffi_arg_pointers.get(),
+                             &gobject_instance))
+        return false;
+
+    AutoProfilerLabel label{cx, "", profiler_label(cx, gobject_instance)};
+
+    unsigned ffi_arg_pos =
+        marshal_args_in(cx, args, &state, ffi_arg_pointers.get());
+
+    // This pointer needs to exist on the stack across the ffi_call() call
+    GError** errorp = &state.local_error;
+
+    /* Did argument conversion fail? In that case, skip invocation and jump to
+     * release processing. */
+    if (state.failed)
+        return finish_invoke(cx, args.rval(), &state, r_value);
+
+    if (state.can_throw_gerror) {
+        g_assert(ffi_arg_pos < ffi_argc && "GError** argument number mismatch");
+        ffi_arg_pointers[ffi_arg_pos] = &errorp;
+        ffi_arg_pos++;
+
+        /* don't update state.processed_c_args as we deal with local_error
+         * separately */
+    }
+
+    g_assert_cmpuint(ffi_arg_pos, ==, ffi_argc);
+
+    Maybe<Arg::ReturnTag> return_tag = m_arguments.return_tag();
+    // return_value_p will point inside the return GIFFIReturnValue union if the
+    // C function has a non-void return type
+    void* return_value_p =
+        get_return_ffi_pointer_from_gi_argument(return_tag, &return_value);
+    timer.begin_native();
+    ffi_call(&m_invoker.cif, FFI_FN(m_invoker.native_address), return_value_p,
+             ffi_arg_pointers.get());
+    timer.end_native();
+
+    /* Return value and out arguments are valid only if invocation doesn't
+     * return error. In arguments need to be released always.
+     */
+
+    if (return_tag) {
+        gi_type_tag_extract_ffi_return_value(
+            return_tag->tag(), return_tag->interface_gtype(), &return_value,
+            state.return_value());
+    }
+
+    marshal_out(cx, &state, r_value);
 
     // If we failed before calling the function, or if the function threw an
     // exception, then any GI_TRANSFER_EVERYTHING or GI_TRANSFER_CONTAINER
     // in-parameters were not transferred. Treat them as GI_TRANSFER_NOTHING so
     // that they are freed.
-    return finish_invoke(cx, args, &state, r_value);
+    return finish_invoke(cx, args.rval(), &state, r_value);
+}
+
+// State of a call whose C function runs in a worker thread. Everything needed
+// to complete the call on the JS thread is kept here in the meantime; the
+// worker thread only touches the FFI data, which is why the call has its own
+// invoker rather than using the Function's, which may be finalized first.
+// If the GjsContext is disposed while the call is in flight, the call is
+// abandoned: cx and priv are cleared and the JS values are unrooted.
+struct Function::ThreadCall {
+    JSContext* cx;
+    Function* priv;
+    GIFunctionInvoker invoker{};
+    // Keep the function, and the JS values that the C arguments were converted
+    // from, alive until the call is complete
+    JS::PersistentRootedObject function;
+    JS::PersistentRootedObject js_args;
+    JS::PersistentRootedObject instance_object;
+    JS::PersistentRootedObject promise;
+
+    GjsFunctionCallState::Storage storage;
+    std::unordered_set<GIArgument*> ignore_release;
+    uint8_t processed_c_args;
+
+    std::unique_ptr<void*[]> ffi_arg_pointers;
+    void* return_value_p = nullptr;
+    GIFFIReturnValue return_value;
+    GError* error = nullptr;
+    GError** errorp = &error;
+
+    ThreadCall(JSContext* a_cx, Function* function_priv, JSObject* func,
+               JSObject* args_array, JSObject* promise_obj, unsigned ffi_argc)
+        : cx(a_cx),
+          priv(function_priv),
+          function(a_cx, func),
+          js_args(a_cx, args_array),
+          instance_object(a_cx),
+          promise(a_cx, promise_obj),
+          processed_c_args(0),
+          ffi_arg_pointers(std::make_unique<void*[]>(ffi_argc)) {}
+
+    ~ThreadCall() {
+        g_clear_error(&error);
+        gi_function_invoker_clear(&invoker);
+    }
+
+    [[nodiscard]] bool abandoned() const { return !cx; }
+};
+
+// Arguments that are JS functions would have to be called back on the worker
+// thread, which is impossible
+bool Function::can_call_in_thread(JSContext* cx) {
+    if (m_info.is_vfunc()) {
+        gjs_throw(cx, "Cannot call virtual function %s in a thread",
+                  format_name().c_str());
+        return false;
+    }
+
+    for (unsigned ix = 0; ix < m_info.n_args(); ix++) {
+        GI::StackArgInfo arg_info;
+        GI::StackTypeInfo type_info;
+        m_info.load_arg(ix, &arg_info);
+        arg_info.load_type(&type_info);
+        if (type_info.tag() == GI_TYPE_TAG_INTERFACE &&
+            type_info.interface().is_callback()) {
+            gjs_throw(cx,
+                      "Cannot call %s in a thread, because its '%s' argument "
+                      "is a callback",
+                      format_name().c_str(), arg_info.name());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Function::call_in_thread_impl(JSContext* cx, JS::HandleObject function,
+                                   const JS::CallArgs& args) {
+    if (!can_call_in_thread(cx))
+        return false;
+
+    // args[0] is the 'this' object for methods, as with Function.call();
+    // other functions get all the arguments
+    JS::RootedObject this_obj{cx};
+    unsigned first_arg = 0;
+    if (m_info.is_method()) {
+        if (!args.get(0).isObject()) {
+            gjs_throw(cx, "%s.callInThread() expects the instance first",
+                      format_name().c_str());
+            return false;
+        }
+        this_obj = &args[0].toObject();
+        first_arg = 1;
+    }
+
+    // Build CallArgs for the C function's arguments only, so that the regular
+    // marshalling code can be used. The vector also has the callee and 'this'
+    // in front, as CallArgs expects.
+    unsigned js_argc =
+        args.length() > first_arg ? args.length() - first_arg : 0;
+    JS::RootedValueVector call_argv{cx};
+    if (!call_argv.append(JS::ObjectValue(*function)) ||
+        !call_argv.append(this_obj ? JS::ObjectValue(*this_obj)
+                                   : JS::UndefinedValue()) ||
+        (js_argc > 0 && !call_argv.append(args.array() + first_arg,
+                                          args.array() + args.length()))) {
+        JS_ReportOutOfMemory(cx);
+        return false;
+    }
+
+    JS::CallArgs call_args = JS::CallArgsFromVp(js_argc, call_argv.begin());
+    if (!check_js_argc(cx, call_args))
+        return false;
+
+    JS::RootedObject args_array{cx, JS::NewArrayObject(cx, call_argv)};
+    if (!args_array)
+        return false;
+
+    JS::RootedObject promise{cx, JS::NewPromiseObject(cx, nullptr)};
+    if (!promise)
+        return false;
+
+    unsigned ffi_argc = m_invoker.cif.nargs;
+    auto call = std::make_unique<ThreadCall>(cx, this, function, args_array,
+                                             promise, ffi_argc);
+
+    // Virtual functions were ruled out in can_call_in_thread()
+    GErrorResult<> result =
+        m_info.as<GI::InfoTag::FUNCTION>()->prep_invoker(&call->invoker);
+    if (result.isErr())
+        return gjs_throw_gerror(cx, result.unwrapErr());
+
+    {
+        GjsFunctionCallState state{
+            cx, m_info, GjsFunctionCallState::Allocation::DETACHABLE};
+
+        ObjectBase* unused_instance = nullptr;
+        if (!marshal_instance_in(cx, this_obj, &state,
+                                 call->ffi_arg_pointers.get(),
+                                 &unused_instance))
+            return false;
+
+        unsigned ffi_arg_pos = marshal_args_in(cx, call_args, &state,
+                                               call->ffi_arg_pointers.get());
+        if (state.failed) {
+            JS::RootedValue unused_rval{cx};
+            return finish_invoke(cx, &unused_rval, &state);
+        }
+
+        if (state.can_throw_gerror) {
+            g_assert(ffi_arg_pos < ffi_argc &&
+                     "GError** argument number mismatch");
+            call->ffi_arg_pointers[ffi_arg_pos] = &call->errorp;
+            ffi_arg_pos++;
+        }
+
+        g_assert_cmpuint(ffi_arg_pos, ==, ffi_argc);
+
+        call->instance_object = state.instance_object;
+        call->ignore_release = std::move(state.ignore_release);
+        call->processed_c_args = state.processed_c_args;
+        call->storage = state.detach_storage();
+    }
+
+    call->return_value_p = get_return_ffi_pointer_from_gi_argument(
+        m_arguments.return_tag(), &call->return_value);
+
+    gjs_debug_marshal(GJS_DEBUG_GFUNCTION, "Calling %s in a thread",
+                      format_name().c_str());
+
+    // Hold the main loop until the promise is settled
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    gjs->main_loop_hold();
+
+    ThreadCall* data = call.release();
+    gjs->register_notifier(&Function::on_thread_call_context_destroyed, data);
+    AutoUnref<GTask> task{
+        g_task_new(nullptr, nullptr, &Function::on_thread_call_done, data)};
+    g_task_set_task_data(task, data, nullptr);
+    g_task_set_source_tag(task, reinterpret_cast<void*>(&call_in_thread));
+    g_task_set_static_name(task, "[gjs] Function.callInThread");
+    g_task_run_in_thread(
+        task, [](GTask* task, void*, void* task_data, GCancellable*) {
+            auto* call = static_cast<ThreadCall*>(task_data);
+            GIFunctionInvoker& invoker = call->invoker;
+            ffi_call(&invoker.cif,
+                     FFI_FN(invoker.native_address), call->return_value_p,
+                     call->ffi_arg_pointers.get());
+            g_task_return_boolean(task, true);
+        });
+
+    args.rval().setObject(*promise);
+    return true;
+}
+
+void Function::on_thread_call_context_destroyed(JSContext*, void* data) {
+    auto* call = static_cast<ThreadCall*>(data);
+
+    gjs_debug(GJS_DEBUG_GFUNCTION,
+              "Abandoning call in a thread %p, the context is being destroyed",
+              call);
+
+    // Don't unregister the notifier here, the notifiers are being iterated
+    GjsContextPrivate::from_cx(call->cx)->main_loop_release();
+    call->function.reset();
+    call->js_args.reset();
+    call->instance_object.reset();
+    call->promise.reset();
+    call->priv = nullptr;
+    call->cx = nullptr;
+}
+
+void Function::on_thread_call_done(GObject*, GAsyncResult*, void* data) {
+    std::unique_ptr<ThreadCall> call{static_cast<ThreadCall*>(data)};
+
+    // The C values of the arguments are leaked rather than released, since
+    // releasing them needs the Function, which is gone along with the context
+    if (call->abandoned())
+        return;
+
+    JSContext* cx = call->cx;
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    gjs->unregister_notifier(&Function::on_thread_call_context_destroyed,
+                             call.get());
+    gjs->main_loop_release();
+    if (gjs->destroying())
+        return;
+
+    JSAutoRealm ar{cx, call->promise};
+    Function* self = call->priv;
+
+    bool ok;
+    JS::RootedValue rval{cx};
+    {
+        GjsFunctionCallState state{cx, self->m_info, std::move(call->storage)};
+        state.instance_object = call->instance_object;
+        state.ignore_release = std::move(call->ignore_release);
+        state.processed_c_args = call->processed_c_args;
+        state.local_error = std::exchange(call->error, nullptr);
+
+        Maybe<Arg::ReturnTag> return_tag = self->m_arguments.return_tag();
+        if (return_tag) {
+            gi_type_tag_extract_ffi_return_value(
+                return_tag->tag(), return_tag->interface_gtype(),
+                &call->return_value, state.return_value());
+        }
+
+        self->marshal_out(cx, &state);
+        ok = self->finish_invoke(cx, &rval, &state);
+    }
+
+    if (ok) {
+        if (!JS::ResolvePromise(cx, call->promise, rval))
+            gjs_log_exception(cx);
+        return;
+    }
+
+    JS::RootedValue exception{cx};
+    if (!JS_GetPendingException(cx, &exception)) {
+        // Uncatchable exception, e.g. out of memory or System.exit()
+        uint8_t code;
+        if (gjs->should_exit(&code))
+            gjs->exit_immediately(code);
+        g_error("Call to %s in a thread terminated with uncatchable exception",
+                self->format_name().c_str());
+    }
+    JS_ClearPendingException(cx);
+    if (!JS::RejectPromise(cx, call->promise, exception))
+        gjs_log_exception(cx);
+}
+
+bool Function::call_in_thread(JSContext* cx, unsigned argc, JS::Value* vp) {
+    GJS_CHECK_WRAPPER_PRIV(cx, argc, vp, args, this_obj, Function, priv);
+    return priv->call_in_thread_impl(cx, this_obj, args);
 }
 
-bool Function::finish_invoke(JSContext* cx, const JS::CallArgs& args,
+bool Function::finish_invoke(JSContext* cx, JS::MutableHandleValue rval,
                              GjsFunctionCallState* state,
                              GIArgument* r_value /* = nullptr */) {
     // In this loop we use ffi_arg_pos just to ensure we don't release stuff
@@ -1166,13 +1748,13 @@ bool Function::finish_invoke(JSContext* cx, const JS::CallArgs& args,
     // Function doesn't return a value, or we stored the C return value in
     // r_value and don't want a JS return value
     if (m_js_out_argc == 0 || r_value) {
-        args.rval().setUndefined();
+        rval.setUndefined();
         return true;
     }
 
     // If we have one return value or out arg, return that item on its own
     if (m_js_out_argc == 1) {
-        args.rval().set(state->return_values[0]);
+        rval.set(state->return_values[0]);
         return true;
     }
 
@@ -1180,7 +1762,7 @@ bool Function::finish_invoke(JSContext* cx, const JS::CallArgs& args,
     JSObject* array = JS::NewArrayObject(cx, state->return_values);
     if (!array)
         return false;
-    args.rval().setObject(*array);
+    rval.setObject(*array);
     return true;
 }
 
@@ -1283,6 +1865,7 @@ const JSPropertySpec Function::proto_props[] = {
 // clang-format off
 const JSFunctionSpec Function::proto_funcs[] = {
     JS_FN("toString", &Function::to_string, 0, 0),
+    JS_FN("callInThread", &Function::call_in_thread, 1, 0),
     JS_FS_END};
 // clang-format on
 
@@ -30,6 +30,7 @@
 #include "gjs/gerror-result.h"
 #include "gjs/macros.h"
 
+class GjsContextPrivate;
 namespace JS {
 class CallArgs;
 }
@@ -71,6 +72,8 @@ struct GjsCallbackTrampoline : public Gjs::Closure {
     static void invoke_callback_closure(ffi_cif*, void* result, void** ffi_args,
                                         void* data);
     void callback_closure(GIArgument** args, void* result);
+    [[nodiscard]]
+    bool forward_to_owner_thread(GjsContextPrivate*, GIArgument** args);
     GJS_JSAPI_RETURN_CONVENTION
     bool callback_closure_inner(JSContext* cx, JS::HandleObject this_object,
                                 GObject* gobject, JS::MutableHandleValue rval,
@@ -109,7 +112,18 @@ class GjsFunctionCallState {
     bool can_throw_gerror : 1;
     bool is_method : 1;
 
-    GjsFunctionCallState(JSContext* cx, const GI::CallableInfo& callable)
+    // Storage for the C values of a call that is completed later, for example
+    // after the C function has run in a worker thread
+    struct Storage {
+        std::unique_ptr<GIArgument[]> in_cvalues;
+        std::unique_ptr<GIArgument[]> out_cvalues;
+        std::unique_ptr<GIArgument[]> inout_original_cvalues;
+    };
+
+    enum class Allocation : uint8_t { INLINE, DETACHABLE };
+
+    GjsFunctionCallState(JSContext* cx, const GI::CallableInfo& callable,
+                         Allocation allocation = Allocation::INLINE)
         : instance_object(cx),
           return_values(cx),
           info(callable),
@@ -118,9 +132,41 @@ class GjsFunctionCallState {
           can_throw_gerror(callable.can_throw_gerror()),
           is_method(callable.is_method()) {
         int size = gi_argc + first_arg_offset();
-        m_in_cvalues.allocate(size);
-        m_out_cvalues.allocate(size);
-        m_inout_original_cvalues.allocate(size);
+        if (allocation == Allocation::DETACHABLE) {
+            m_in_cvalues.allocate_on_heap(size);
+            m_out_cvalues.allocate_on_heap(size);
+            m_inout_original_cvalues.allocate_on_heap(size);
+        } else {
+            m_in_cvalues.allocate(size);
+            m_out_cvalues.allocate(size);
+            m_inout_original_cvalues.allocate(size);
+        }
+    }
+
+    // Resumes a call from storage previously returned by detach_storage().
+    // Pointers between the C values stay valid, since the storage never moves.
+    GjsFunctionCallState(JSContext* cx, const GI::CallableInfo& callable,
+                         Storage&& storage)
+        : instance_object(cx),
+          return_values(cx),
+          info(callable),
+          gi_argc(callable.n_args()),
+          failed(false),
+          can_throw_gerror(callable.can_throw_gerror()),
+          is_method(callable.is_method()) {
+        m_in_cvalues.adopt(storage.in_cvalues.release());
+        m_out_cvalues.adopt(storage.out_cvalues.release());
+        m_inout_original_cvalues.adopt(
+            storage.inout_original_cvalues.release());
+    }
+
+    // Only valid if constructed with Allocation::DETACHABLE
+    [[nodiscard]]
+    Storage detach_storage() {
+        return {std::unique_ptr<GIArgument[]>{m_in_cvalues.release()},
+                std::unique_ptr<GIArgument[]>{m_out_cvalues.release()},
+                std::unique_ptr<GIArgument[]>{
+                    m_inout_original_cvalues.release()}};
     }
 
     GjsFunctionCallState(const GjsFunctionCallState&) = delete;
@@ -8,6 +8,8 @@
 
 #include <stddef.h>  // for size_t
 
+#include <glib.h>
+
 namespace Gjs {
 
 // Small-buffer-optimized array storage. The number of elements is almost always
@@ -15,7 +17,8 @@ namespace Gjs {
 // counts fall back to the heap. The data pointer doubles as the heap pointer,
 // so the object is only the size of N + 1 pointers.
 //
-// allocate() must be called exactly once, before any element is accessed.
+// allocate() or allocate_on_heap() must be called exactly once, before any
+// element is accessed.
 template <typename T, size_t N>
 class InlineArray {
     T m_inline[N];
@@ -36,6 +39,22 @@ class InlineArray {
             m_pointer = new T[size];
     }
 
+    // Always allocates on the heap, so that the storage can outlive the owner
+    // by passing it to another InlineArray with release() and adopt().
+    void allocate_on_heap(size_t size) { m_pointer = new T[size]; }
+
+    [[nodiscard]] T* release() {
+        g_assert(m_pointer != m_inline && "Inline storage cannot be released");
+        T* retval = m_pointer;
+        m_pointer = m_inline;
+        return retval;
+    }
+
+    void adopt(T* heap_storage) {
+        g_assert(m_pointer == m_inline && "Storage was already allocated");
+        m_pointer = heap_storage;
+    }
+
     [[nodiscard]] constexpr T& operator[](size_t index) const {
         return m_pointer[index];
     }
@@ -40,6 +40,7 @@
 #include <js/ObjectWithStashedPointer.h>
 #include <js/PropertyAndElement.h>
 #include <js/PropertyDescriptor.h>  // for JSPROP_PERMANENT, JSPROP_READONLY
+#include <js/ProfilingStack.h>  // for GetContextProfilingStackIfEnabled
 #include <js/PropertySpec.h>        // for JS_FN, JSFunctionSpec, JSPropertySpec
 #include <js/String.h>
 #include <js/Symbol.h>
@@ -73,6 +74,7 @@
 #include "gi/wrapperutils.h"
 #include "gjs/atoms.h"
 #include "gjs/auto.h"
+#include "gjs/call-stats.h"
 #include "gjs/context-private.h"
 #include "gjs/deprecation.h"
 #include "gjs/gerror-result.h"
@@ -83,6 +85,7 @@
 #include "gjs/macros.h"
 #include "gjs/mem-private.h"
 #include "gjs/profiler-private.h"
+#include "gjs/signal-stats.h"
 #include "util/log.h"
 #include "util/misc.h"
 
@@ -272,6 +275,58 @@ bool ObjectInstance::add_property_impl(JSContext* cx, JS::HandleObject obj,
     return true;
 }
 
+// Profiling stack label for a property or field, e.g. Gtk.Button["label"].
+// The name must come from the typelib or from a GParamSpec, so that it stays
+// valid for the life of the program.
+[[nodiscard]]
+static const char* prop_label(JSContext* cx, const ObjectBase* priv,
+                              const char* name) {
+    static const char kind[] = "[]";
+    return Gjs::profiler_label(cx, {priv->gtype(), kind, name}, [priv, name]() {
+        return priv->format_name() + "[\"" + name + "\"]";
+    });
+}
+
+// Profiling stack label for a signal method, e.g. Gtk.Button.connect('clicked')
+[[nodiscard]]
+static const char* signal_label(JSContext* cx, const ObjectBase* priv,
+                                const char* method, const char* signal_name) {
+    if (!js::GetContextProfilingStackIfEnabled(cx))
+        return "";
+
+    // The signal name comes from JS, so key it by its quark instead
+    void* signal = GUINT_TO_POINTER(g_quark_from_string(signal_name));
+    return Gjs::profiler_label(
+        cx, {priv->gtype(), method, signal}, [priv, method, signal_name]() {
+            return priv->format_name() + '.' + method + "('" + signal_name +
+                   "')";
+        });
+}
+
+static const char GET_PROPERTY[] = "get property";
+static const char SET_PROPERTY[] = "set property";
+static const char GET_FIELD[] = "get field";
+static const char SET_FIELD[] = "set field";
+
+// Statistics slot for GJS_CALL_STATS for a property or field accessor, e.g.
+// "get property Gtk.Button:label", or null if statistics are not enabled. The
+// name must stay valid as for prop_label().
+[[nodiscard]]
+static Gjs::CallStats::Entry* prop_call_stats(JSContext* cx,
+                                              const ObjectBase* priv,
+                                              const char* kind,
+                                              const char* name) {
+    Gjs::CallStats* stats = GjsContextPrivate::from_cx(cx)->call_stats();
+    if (!stats)
+        return nullptr;
+
+    return stats->entry({priv->gtype(), kind, name}, [priv, kind, name]() {
+        bool is_field = kind == GET_FIELD || kind == SET_FIELD;
+        return std::string{kind} + ' ' + priv->format_name() +
+               (is_field ? '.' : ':') + name;
+    });
+}
+
 template <typename TAG>
 bool ObjectBase::prop_getter(JSContext* cx, unsigned argc, JS::Value* vp) {
     GJS_CHECK_WRAPPER_PRIV(cx, argc, vp, args, obj, ObjectBase, priv);
@@ -279,9 +334,10 @@ bool ObjectBase::prop_getter(JSContext* cx, unsigned argc, JS::Value* vp) {
     auto* pspec = static_cast<GParamSpec*>(
         gjs_dynamic_property_private_slot(&args.callee()).toPrivate());
 
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[\"" + pspec->name + "\"]")};
-    AutoProfilerLabel label{cx, "property getter", full_name};
+    AutoProfilerLabel label{cx, "property getter",
+                            prop_label(cx, priv, pspec->name)};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, GET_PROPERTY, pspec->name)};
 
     priv->debug_jsprop("Property getter", pspec->name, obj);
 
@@ -310,7 +366,10 @@ bool ObjectInstance::prop_getter_impl(JSContext* cx, GParamSpec* param,
                      param->name);
 
     Gjs::AutoGValue gvalue(G_PARAM_SPEC_VALUE_TYPE(param));
-    g_object_get_property(m_ptr, param->name, &gvalue);
+    {
+        Gjs::AutoNativeCallTimer native{cx};
+        g_object_get_property(m_ptr, param->name, &gvalue);
+    }
 
     if constexpr (!std::is_same_v<TAG, void>) {
         if (Gjs::c_value_to_js_checked<TAG>(cx, Gjs::gvalue_get<TAG>(&gvalue),
@@ -360,9 +419,10 @@ bool ObjectBase::prop_getter_func(JSContext* cx, unsigned argc, JS::Value* vp) {
 
     const GI::AutoFunctionInfo& func_info = info_caller->func_info;
     GI::AutoPropertyInfo property_info{func_info.property().value()};
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[\"" + property_info.name() + "\"]")};
-    AutoProfilerLabel label{cx, "property getter", full_name};
+    AutoProfilerLabel label{cx, "property getter",
+                            prop_label(cx, priv, property_info.name())};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, GET_PROPERTY, property_info.name())};
 
     priv->debug_jsprop("Property getter", property_info.name(), obj);
 
@@ -475,8 +535,13 @@ bool ObjectInstance::prop_getter_impl(JSContext* cx,
 
     GI::StackTypeInfo type_info;
     getter.load_return_type(&type_info);
-    if (!simple_getters_caller(type_info, m_ptr, info_caller->native_address,
-                               &ret)) {
+    bool called;
+    {
+        Gjs::AutoNativeCallTimer native{cx};
+        called = simple_getters_caller(type_info, m_ptr,
+                                       info_caller->native_address, &ret);
+    }
+    if (!called) {
         const std::string& class_name = format_name();
         gjs_throw(cx, "Wrong type for %s::%s getter", class_name.c_str(),
                   property_info.name());
@@ -532,9 +597,10 @@ bool ObjectBase::prop_getter_simple_type_func(JSContext* cx, unsigned argc,
     auto* caller =
         JS::ObjectGetStashedPointer<ObjectPropertyPspecCaller>(cx, pspec_obj);
 
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[\"" + caller->pspec->name + "\"]")};
-    AutoProfilerLabel label{cx, "property getter", full_name};
+    AutoProfilerLabel label{cx, "property getter",
+                            prop_label(cx, priv, caller->pspec->name)};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, GET_PROPERTY, caller->pspec->name)};
 
     priv->debug_jsprop("Property getter",
                        gjs_intern_string_to_id(cx, caller->pspec->name), obj);
@@ -569,7 +635,11 @@ bool ObjectInstance::prop_getter_impl(JSContext* cx,
     using T = Gjs::Tag::RealT<TAG>;
     using FuncType = T (*)(GObject*);
     FuncType func = reinterpret_cast<FuncType>(pspec_caller->native_address);
-    T retval = func(m_ptr);
+    T retval;
+    {
+        Gjs::AutoNativeCallTimer native{cx};
+        retval = func(m_ptr);
+    }
     if (!Gjs::c_value_to_js_checked<TAG>(cx, retval, args.rval()))
         return false;
 
@@ -599,9 +669,10 @@ bool ObjectBase::field_getter(JSContext* cx, unsigned argc, JS::Value* vp) {
     auto const& field_info =
         *JS::ObjectGetStashedPointer<GI::AutoFieldInfo>(cx, field_info_obj);
 
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[\"" + field_info.name() + "\"]")};
-    AutoProfilerLabel label{cx, "field getter", full_name};
+    AutoProfilerLabel label{cx, "field getter",
+                            prop_label(cx, priv, field_info.name())};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, GET_FIELD, field_info.name())};
 
     priv->debug_jsprop("Field getter", field_info.name(), obj);
 
@@ -633,7 +704,12 @@ bool ObjectInstance::field_getter_impl(JSContext* cx,
         return false;
     }
 
-    if (field.read(m_ptr, &arg).isErr()) {
+    bool read;
+    {
+        Gjs::AutoNativeCallTimer native{cx};
+        read = field.read(m_ptr, &arg).isOk();
+    }
+    if (!read) {
         gjs_throw(cx, "Error getting field %s from object", field.name());
         return false;
     }
@@ -653,9 +729,10 @@ bool ObjectBase::prop_setter(JSContext* cx, unsigned argc, JS::Value* vp) {
     auto* pspec = static_cast<GParamSpec*>(
         gjs_dynamic_property_private_slot(&args.callee()).toPrivate());
 
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[\"" + pspec->name + "\"]")};
-    AutoProfilerLabel label{cx, "property setter", full_name};
+    AutoProfilerLabel label{cx, "property setter",
+                            prop_label(cx, priv, pspec->name)};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, SET_PROPERTY, pspec->name)};
 
     priv->debug_jsprop("Property setter", pspec->name, obj);
 
@@ -729,6 +806,7 @@ bool ObjectInstance::prop_setter_impl(JSContext* cx, GParamSpec* param_spec,
         }
     }
 
+    Gjs::AutoNativeCallTimer native{cx};
     g_object_set_property(m_ptr, param_spec->name, &gvalue);
 
     return true;
@@ -754,9 +832,10 @@ bool ObjectBase::prop_setter_func(JSContext* cx, unsigned argc, JS::Value* vp) {
 
     const GI::AutoFunctionInfo& func_info = info_caller->func_info;
     GI::AutoPropertyInfo property_info{func_info.property().value()};
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[\"" + property_info.name() + "\"]")};
-    AutoProfilerLabel label{cx, "property setter", full_name};
+    AutoProfilerLabel label{cx, "property setter",
+                            prop_label(cx, priv, property_info.name())};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, SET_PROPERTY, property_info.name())};
 
     priv->debug_jsprop("Property setter", property_info.name(), obj);
 
@@ -885,8 +964,13 @@ bool ObjectInstance::prop_setter_impl(JSContext* cx,
         return prop_setter_impl<void>(cx, pspec, value);
     }
 
-    if (!simple_setters_caller(type_info, &arg, m_ptr,
-                               info_caller->native_address)) {
+    bool called;
+    {
+        Gjs::AutoNativeCallTimer native{cx};
+        called = simple_setters_caller(type_info, &arg, m_ptr,
+                                       info_caller->native_address);
+    }
+    if (!called) {
         const std::string& class_name = format_name();
         gjs_throw(cx, "Wrong type for %s::%s setter", class_name.c_str(),
                   property_info.name());
@@ -906,9 +990,10 @@ bool ObjectBase::prop_setter_simple_type_func(JSContext* cx, unsigned argc,
     auto* caller =
         JS::ObjectGetStashedPointer<ObjectPropertyPspecCaller>(cx, pspec_obj);
 
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[" + caller->pspec->name + "]")};
-    AutoProfilerLabel label{cx, "property setter", full_name};
+    AutoProfilerLabel label{cx, "property setter",
+                            prop_label(cx, priv, caller->pspec->name)};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, SET_PROPERTY, caller->pspec->name)};
 
     priv->debug_jsprop("Property setter", caller->pspec->name, obj);
 
@@ -957,13 +1042,17 @@ bool ObjectInstance::prop_setter_impl(JSContext* cx,
             return false;
         }
 
+        Gjs::AutoNativeCallTimer native{cx};
         func(m_ptr, native_value);
     } else {
         T native_value;
         if (!Gjs::js_value_to_c<TAG>(cx, args[0], &native_value))
             return false;
 
-        func(m_ptr, native_value);
+        {
+            Gjs::AutoNativeCallTimer native{cx};
+            func(m_ptr, native_value);
+        }
 
         if constexpr (TRANSFER == GI_TRANSFER_NOTHING && std::is_pointer_v<T>) {
             static_assert(std::is_same_v<T, char*>,
@@ -983,9 +1072,10 @@ bool ObjectBase::field_setter(JSContext* cx, unsigned argc, JS::Value* vp) {
     auto const& field_info =
         *JS::ObjectGetStashedPointer<GI::AutoFieldInfo>(cx, field_info_obj);
 
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, priv->format_name() + "[\"" + field_info.name() + "\"]")};
-    AutoProfilerLabel label{cx, "field setter", full_name};
+    AutoProfilerLabel label{cx, "field setter",
+                            prop_label(cx, priv, field_info.name())};
+    Gjs::AutoCallTimer timer{
+        cx, prop_call_stats(cx, priv, SET_FIELD, field_info.name())};
 
     priv->debug_jsprop("Field setter", field_info.name(), obj);
 
@@ -2521,6 +2611,16 @@ void ObjectInstance::associate_js_gobject(JSContext* cx,
 
     if (!G_UNLIKELY(m_gobj_disposed))
         g_object_weak_ref(gobj, wrapped_gobj_dispose_notify, this);
+
+    GjsProfiler* profiler = GjsContextPrivate::from_cx(cx)->profiler();
+    if (profiler && gjs_profiler_sample_allocation(profiler)) {
+        GTypeQuery query;
+        g_type_query(G_OBJECT_TYPE(gobj), &query);
+        std::string label{"GObject wrapper "};
+        label += G_OBJECT_TYPE_NAME(gobj);
+        gjs_profiler_add_allocation(profiler, gobj, query.instance_size,
+                                    label.c_str());
+    }
 }
 
 void ObjectInstance::ensure_uses_toggle_ref(JSContext* cx) {
@@ -3000,9 +3100,8 @@ bool ObjectInstance::connect_impl(JSContext* cx, const JS::CallArgs& args,
             return false;
     }
 
-    std::string dynamic_string{GJS_PROFILER_DYNAMIC_STRING(
-        cx, format_name() + '.' + func_name + "('" + signal_name.get() + "')")};
-    AutoProfilerLabel label{cx, "", dynamic_string};
+    AutoProfilerLabel label{
+        cx, "", signal_label(cx, this, func_name, signal_name.get())};
 
     if (!JS::IsCallable(callback)) {
         gjs_throw(cx, "second arg must be a callback");
@@ -3064,9 +3163,8 @@ bool ObjectInstance::emit_impl(JSContext* cx, const JS::CallArgs& args) {
                              &signal_name))
         return false;
 
-    std::string full_name{GJS_PROFILER_DYNAMIC_STRING(
-        cx, format_name() + " emit('" + signal_name.get() + "')")};
-    AutoProfilerLabel label{cx, "", full_name};
+    AutoProfilerLabel label{cx, "",
+                            signal_label(cx, this, "emit", signal_name.get())};
 
     unsigned signal_id;
     if (!g_signal_parse_name(signal_name.get(), gtype(), &signal_id,
@@ -3085,6 +3183,16 @@ bool ObjectInstance::emit_impl(JSContext* cx, const JS::CallArgs& args) {
         return false;
     }
 
+    Gjs::SignalStats* signal_stats =
+        GjsContextPrivate::from_cx(cx)->signal_stats();
+    Gjs::SignalStats::Entry* signal_stats_entry =
+        signal_stats ? signal_stats->entry(G_OBJECT_TYPE(m_ptr), signal_id,
+                                           signal_detail)
+                     : nullptr;
+    Gjs::SignalStats::AutoTimer signal_timer{
+        signal_stats, signal_stats_entry,
+        Gjs::SignalStats::AutoTimer::EMISSION};
+
     AutoGValueVector instance_and_args;
     instance_and_args.reserve(signal_query.n_params + 1);
     std::vector<Gjs::AutoGValue*> args_to_steal;
@@ -3380,8 +3488,10 @@ bool ObjectBase::init_gobject(JSContext* cx, unsigned argc, JS::Value* vp) {
     if (!priv->check_is_instance(cx, "initialize"))
         return false;
 
-    std::string full_name{
-        GJS_PROFILER_DYNAMIC_STRING(cx, priv->format_name() + "._init")};
+    static const char kind[] = "._init";
+    const char* full_name = Gjs::profiler_label(
+        cx, {priv->gtype(), kind, nullptr},
+        [priv]() { return priv->format_name() + kind; });
     AutoProfilerLabel label{cx, "", full_name};
 
     return priv->to_instance()->init_impl(cx, argv, obj);
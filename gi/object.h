@@ -426,14 +426,15 @@ class ObjectInstance : public GIWrapperInstance<ObjectBase, ObjectPrototype,
 
     // Methods to manipulate the linked list of instances
 
- private:
-    static std::unordered_set<ObjectInstance*> s_wrapped_gobject_list;
-    void link();
-    void unlink();
     [[nodiscard]]
     static size_t num_wrapped_gobjects() {
         return s_wrapped_gobject_list.size();
     }
+
+ private:
+    static std::unordered_set<ObjectInstance*> s_wrapped_gobject_list;
+    void link();
+    void unlink();
     using Action = std::function<void(ObjectInstance*)>;
     using Predicate = std::function<bool(ObjectInstance*)>;
     static void remove_wrapped_gobjects_if(const Predicate&, const Action&);
@@ -6,6 +6,8 @@
 
 #include <string.h>  // for strlen
 
+#include <string>
+
 #include <girepository/girepository.h>
 #include <glib-object.h>
 #include <glib.h>
@@ -48,6 +50,7 @@
 #include "gjs/context-private.h"
 #include "gjs/gerror-result.h"
 #include "gjs/global.h"
+#include "gjs/import-timing.h"
 #include "gjs/jsapi-util.h"
 #include "gjs/macros.h"
 #include "gjs/module.h"
@@ -94,6 +97,11 @@ static bool resolve_namespace_object(JSContext* cx, JS::HandleObject repo_obj,
         return false;
     }
 
+    std::string timing_key{"gi://"};
+    timing_key += ns_name.get();
+    mozilla::Maybe<Gjs::AutoImportTimer> fetch_timer;
+    fetch_timer.emplace(cx, Gjs::ImportPhase::FETCH, timing_key.c_str());
+
     GI::Repository repo;
     size_t nversions;
     (void)repo.enumerate_versions(ns_name.get(), &nversions);
@@ -135,6 +143,8 @@ static bool resolve_namespace_object(JSContext* cx, JS::HandleObject repo_obj,
         return false;
     }
 
+    fetch_timer.reset();
+
     /* Defines a property on "obj" (the javascript repo object) with the given
      * namespace name, pointing to that namespace in the repo.
      */
@@ -148,11 +158,14 @@ static bool resolve_namespace_object(JSContext* cx, JS::HandleObject repo_obj,
                                GJS_MODULE_PROP_FLAGS))
         return false;
 
-    JS::RootedValue result{cx};
-    if (!override.isUndefined() &&
-        !JS_CallFunctionValue(cx, /* this_obj = */ gi_namespace, override,
-                              JS::HandleValueArray::empty(), &result))
-        return false;
+    if (!override.isUndefined()) {
+        Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::EVALUATE,
+                                   timing_key.c_str()};
+        JS::RootedValue result{cx};
+        if (!JS_CallFunctionValue(cx, /* this_obj = */ gi_namespace, override,
+                                  JS::HandleValueArray::empty(), &result))
+            return false;
+    }
 
     gjs_debug(GJS_DEBUG_GNAMESPACE,
               "Defined namespace '%s' %p in GIRepository %p", ns_name.get(),
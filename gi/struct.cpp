@@ -15,8 +15,7 @@
 #include "gi/boxed.h"
 #include "gi/gerror.h"
 #include "gi/struct.h"
-#include "gjs/atoms.h"
-#include "gjs/context-private.h"
+#include "gi/variant.h"
 #include "gjs/jsapi-util.h"
 #include "gjs/mem-private.h"
 
@@ -63,6 +62,10 @@ bool StructPrototype::define_class(JSContext* cx, JS::HandleObject in_object,
                            GJS_MODULE_PROP_FLAGS))
         return false;
 
+    if (info.gtype() == G_TYPE_VARIANT &&
+        !gjs_variant_define_methods(cx, prototype))
+        return false;
+
     return true;
 }
 
@@ -81,15 +84,12 @@ StructInstance::~StructInstance() {
 bool StructInstance::constructor_impl(JSContext* cx, JS::HandleObject obj,
                                       const JS::CallArgs& args) {
     if (gtype() == G_TYPE_VARIANT) {
-        // Short-circuit construction for GVariants by calling into the JS
-        // packing function
-        const GjsAtoms& atoms = GjsContextPrivate::atoms(cx);
-        if (!invoke_static_method(cx, obj, atoms.new_internal(), args))
+        // Short-circuit construction for GVariants by packing the value
+        if (!gjs_variant_construct(cx, args))
             return false;
 
-        // The return value of GLib.Variant.new_internal() gets its own
-        // BoxedInstance, and the one we're setting up in this constructor is
-        // discarded.
+        // The packed GVariant gets its own BoxedInstance, and the one we're
+        // setting up in this constructor is discarded.
         debug_lifecycle(
             "Boxed construction delegated to GVariant constructor, boxed "
             "object discarded");
@@ -13,6 +13,7 @@
 #include <deque>
 #include <utility>  // for pair
 
+#include "gi/gjs_gi_trace.h"
 #include "gi/object.h"
 #include "gi/toggle.h"
 #include "util/log.h"
@@ -128,6 +129,8 @@ bool ToggleQueue::handle_toggle(Handler handler) {
         debug("handle UP", item.object);
     else
         debug("handle DOWN", item.object);
+    TRACE(GJS_TOGGLE_HANDLE(item.object, item.object->ptr(),
+                            item.direction == UP ? "up" : "down"));
 
     handler(item.object, item.direction);
     q.pop_front();
@@ -175,6 +178,8 @@ void ToggleQueue::enqueue(ObjectInstance* obj, ToggleQueue::Direction direction,
      * earlier than we've processed it.
      */
     q.emplace_back(obj, direction);
+    TRACE(GJS_TOGGLE_ENQUEUE(obj, obj->ptr(), direction == UP ? "up" : "down",
+                             q.size()));
 
     if (direction == UP) {
         debug("enqueue UP", obj);
@@ -10,6 +10,7 @@
 
 #include <config.h>
 
+#include <stddef.h>  // for size_t
 #include <stdint.h>
 
 #include <atomic>
@@ -105,6 +106,9 @@ class ToggleQueue {
     // Queues a toggle to be processed in idle time.
     void enqueue(ObjectInstance*, Direction, Handler);
 
+    // Number of toggles waiting to be processed
+    [[nodiscard]] size_t size() const { return q.size(); }
+
     [[nodiscard]]
     static Locked get_default() {
         return Locked(&get_default_unlocked());
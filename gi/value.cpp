@@ -30,6 +30,7 @@
 #include <js/experimental/TypedData.h>
 #include <jsapi.h>  // for InformalValueTypeName, JS_Get...
 #include <mozilla/Maybe.h>
+#include <mozilla/ScopeExit.h>
 
 #include "gi/arg-inl.h"
 #include "gi/arg.h"
@@ -38,6 +39,7 @@
 #include "gi/foreign.h"
 #include "gi/fundamental.h"
 #include "gi/gerror.h"
+#include "gi/gjs_gi_trace.h"
 #include "gi/gi-utils.h"
 #include "gi/gtype.h"
 #include "gi/info.h"
@@ -55,6 +57,7 @@
 #include "gjs/jsapi-util.h"
 #include "gjs/macros.h"
 #include "gjs/objectbox.h"
+#include "gjs/signal-stats.h"
 #include "util/log.h"
 
 using mozilla::Maybe, mozilla::Nothing, mozilla::Some;
@@ -237,6 +240,11 @@ void Gjs::Closure::marshal(GValue* return_value, unsigned n_param_values,
     }
 
     GjsContextPrivate* gjs = GjsContextPrivate::from_cx(m_cx);
+    if (G_UNLIKELY(!gjs->is_owner_thread()) &&
+        forward_to_owner_thread(gjs, return_value, n_param_values,
+                                param_values, invocation_hint, marshal_data))
+        return;
+
     if (G_UNLIKELY(!gjs->is_owner_thread()) || JS::RuntimeHeapIsCollecting()) {
         auto* hint = static_cast<GSignalInvocationHint*>(invocation_hint);
         std::ostringstream message;
@@ -271,6 +279,9 @@ void Gjs::Closure::marshal(GValue* return_value, unsigned n_param_values,
 
     JSAutoRealm ar{m_cx, callable()};
 
+    Gjs::SignalStats* signal_stats = gjs->signal_stats();
+    Gjs::SignalStats::Entry* signal_stats_entry = nullptr;
+
     if (marshal_data) {
         // we are used for a signal handler
         unsigned signal_id = GPOINTER_TO_UINT(marshal_data);
@@ -289,7 +300,27 @@ void Gjs::Closure::marshal(GValue* return_value, unsigned n_param_values,
                 "Signal handler being called with wrong number of parameters");
             return;
         }
+
+        void* instance = g_value_peek_pointer(&param_values[0]);
+        if (signal_stats) {
+            auto* hint = static_cast<GSignalInvocationHint*>(invocation_hint);
+            signal_stats_entry = signal_stats->entry(
+                G_TYPE_FROM_INSTANCE(instance), signal_id,
+                hint ? hint->detail : 0);
+        }
+
+        TRACE(GJS_SIGNAL_MARSHAL_START(
+            instance, signal_id, g_type_name(G_TYPE_FROM_INSTANCE(instance)),
+            signal_query.signal_name));
     }
+    auto trace_end = mozilla::MakeScopeExit([&]() {
+        if (signal_query.signal_id) {
+            TRACE(GJS_SIGNAL_MARSHAL_END(g_value_peek_pointer(&param_values[0]),
+                                         signal_query.signal_id));
+        }
+    });
+    Gjs::SignalStats::AutoTimer signal_timer{
+        signal_stats, signal_stats_entry, Gjs::SignalStats::AutoTimer::HANDLER};
 
     /* Check if any parameters, such as array lengths, need to be eliminated
      * before we invoke the closure.
@@ -0,0 +1,970 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+#include <string.h>  // for strchr
+
+#include <algorithm>  // for copy_n
+#include <memory>     // for make_shared, shared_ptr
+#include <string>
+#include <utility>  // for move
+#include <vector>
+
+#include <girepository/girepository.h>
+#include <glib-object.h>
+#include <glib.h>
+
+#include <js/Array.h>  // for GetArrayLength, NewArrayObject
+#include <js/ArrayBuffer.h>
+#include <js/CallArgs.h>
+#include <js/Conversions.h>
+#include <js/ErrorReport.h>  // for JS_ReportOutOfMemory, JSEXN_TYPEERR
+#include <js/Id.h>
+#include <js/PropertyAndElement.h>
+#include <js/PropertySpec.h>
+#include <js/RootingAPI.h>
+#include <js/TypeDecls.h>
+#include <js/Utility.h>  // for UniqueChars
+#include <js/Value.h>
+#include <js/ValueArray.h>
+#include <js/experimental/TypedData.h>
+#include <jsapi.h>  // for InformalValueTypeName, JS_IdToValue, ...
+#include <mozilla/Maybe.h>
+
+#include "gi/arg-inl.h"
+#include "gi/arg-types-inl.h"
+#include "gi/info.h"
+#include "gi/js-value-inl.h"
+#include "gi/repo.h"
+#include "gi/struct.h"
+#include "gi/variant.h"
+#include "gjs/auto.h"
+#include "gjs/byteArray.h"
+#include "gjs/context-private.h"
+#include "gjs/jsapi-util.h"
+#include "gjs/macros.h"
+#include "util/log.h"
+
+using mozilla::Maybe, mozilla::Nothing, mozilla::Some;
+
+/* gi/variant.cpp - packing of JS values into GVariants, for
+ * `new GLib.Variant()`, and unpacking them again, for `unpack()`,
+ * `deepUnpack()`, and `recursiveUnpack()`.
+ *
+ * This used to be done in JS in the GLib override, with one introspected call
+ * per element. The JS behaviour is preserved here, including which containers
+ * are unpacked to arrays, objects, and Uint8Arrays.
+ */
+
+// Types that may be used as the key of a dictionary entry
+static constexpr const char* SIMPLE_TYPES = "bynqiuxthdsog";
+
+[[nodiscard]]
+static bool is_simple_type(char c) {
+    return c != '\0' && strchr(SIMPLE_TYPES, c);
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool parse_single_type(JSContext* cx, const char** signature,
+                              bool force_simple,
+                              Gjs::VariantSignature* out) {
+    const char* start = *signature;
+    char c = *start;
+    if (c == '\0') {
+        gjs_throw(cx,
+                  "Invalid GVariant signature (reached end while expecting a "
+                  "type)");
+        return false;
+    }
+    (*signature)++;
+
+    if (force_simple && !is_simple_type(c)) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "Invalid GVariant signature (a simple type was "
+                         "expected)");
+        return false;
+    }
+
+    out->kind = c;
+
+    switch (c) {
+        case 'm':
+        case 'a': {
+            Gjs::VariantSignature& element = out->children.emplace_back();
+            if (!parse_single_type(cx, signature, false, &element))
+                return false;
+            break;
+        }
+        case '{': {
+            out->children.resize(2);
+            if (!parse_single_type(cx, signature, true, &out->children[0]) ||
+                !parse_single_type(cx, signature, false, &out->children[1]))
+                return false;
+            if (**signature != '}') {
+                gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                                 "Invalid GVariant signature for type "
+                                 "DICT_ENTRY (expected \"}\")");
+                return false;
+            }
+            (*signature)++;
+            break;
+        }
+        case '(':
+            while (**signature != ')') {
+                if (**signature == '\0') {
+                    gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                                     "Invalid GVariant signature for type "
+                                     "TUPLE (expected \")\")");
+                    return false;
+                }
+                Gjs::VariantSignature& member = out->children.emplace_back();
+                if (!parse_single_type(cx, signature, false, &member))
+                    return false;
+            }
+            (*signature)++;
+            break;
+        default:
+            if (!is_simple_type(c) && c != 'v') {
+                gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                                 "Invalid GVariant signature (%c is not a "
+                                 "valid type)",
+                                 c);
+                return false;
+            }
+    }
+
+    out->type_string.assign(start, *signature - start);
+    return true;
+}
+
+namespace Gjs {
+
+std::shared_ptr<const VariantSignature> VariantSignatureCache::lookup(
+    JSContext* cx, const char* signature) {
+    auto it = m_signatures.find(signature);
+    if (it != m_signatures.end())
+        return it->second;
+
+    if (*signature == '\0') {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "GVariant signature cannot be empty");
+        return nullptr;
+    }
+
+    const char* pos = signature;
+    VariantSignature parsed;
+    if (!parse_single_type(cx, &pos, false, &parsed))
+        return nullptr;
+    if (*pos != '\0') {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "Invalid GVariant signature (more than one single "
+                         "complete type)");
+        return nullptr;
+    }
+    g_assert(g_variant_type_string_is_valid(signature) &&
+             "Parsed signature must be a valid GVariant type");
+
+    if (m_signatures.size() >= MAX_ENTRIES)
+        m_signatures.clear();
+
+    gjs_debug_marshal(GJS_DEBUG_GBOXED, "Caching GVariant signature %s",
+                      signature);
+    auto entry = std::make_shared<const VariantSignature>(std::move(parsed));
+    m_signatures.emplace(signature, entry);
+    return entry;
+}
+
+}  // namespace Gjs
+
+// GVariantBuilder that is cleared if packing a child fails halfway
+class AutoVariantBuilder {
+    GVariantBuilder m_builder;
+
+ public:
+    explicit AutoVariantBuilder(const GVariantType* type) {
+        g_variant_builder_init(&m_builder, type);
+    }
+    ~AutoVariantBuilder() { g_variant_builder_clear(&m_builder); }
+
+    void add(GVariant* child) {
+        g_variant_builder_add_value(&m_builder, child);
+    }
+    [[nodiscard]] GVariant* end() { return g_variant_builder_end(&m_builder); }
+};
+
+template <typename TAG>
+GJS_JSAPI_RETURN_CONVENTION static GVariant* pack_number(
+    JSContext* cx, JS::HandleValue value,
+    GVariant* (*variant_new)(Gjs::Tag::RealT<TAG>)) {
+    GIArgument arg;
+    bool out_of_range = false;
+    if (!gjs_arg_set_from_js_value<TAG>(cx, value, &arg, &out_of_range)) {
+        if (out_of_range) {
+            gjs_throw_custom(cx, JSEXN_RANGEERR, nullptr,
+                             "Value is out of range for GVariant of type %s",
+                             Gjs::static_type_name<TAG>());
+        }
+        return nullptr;
+    }
+    return variant_new(gjs_arg_get<TAG>(&arg));
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack_string(JSContext* cx, char kind, JS::HandleValue value) {
+    if (!value.isString()) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "Expected a string for GVariant of type '%c', but got "
+                         "type '%s'",
+                         kind, JS::InformalValueTypeName(value));
+        return nullptr;
+    }
+
+    JS::RootedString str{cx, value.toString()};
+    JS::UniqueChars utf8{JS_EncodeStringToUTF8(cx, str)};
+    if (!utf8)
+        return nullptr;
+
+    if (kind == 'o') {
+        if (!g_variant_is_object_path(utf8.get())) {
+            gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                             "'%s' is not a valid D-Bus object path",
+                             utf8.get());
+            return nullptr;
+        }
+        return g_variant_new_object_path(utf8.get());
+    }
+    if (kind == 'g') {
+        if (!g_variant_is_signature(utf8.get())) {
+            gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                             "'%s' is not a valid D-Bus signature", utf8.get());
+            return nullptr;
+        }
+        return g_variant_new_signature(utf8.get());
+    }
+    return g_variant_new_string(utf8.get());
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool value_to_container(JSContext* cx, JS::HandleValue value,
+                               const Gjs::VariantSignature& signature,
+                               JS::MutableHandleObject obj) {
+    if (!value.isObject()) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "Expected an object for GVariant of type '%s', but "
+                         "got type '%s'",
+                         signature.type_string.c_str(),
+                         JS::InformalValueTypeName(value));
+        return false;
+    }
+    obj.set(&value.toObject());
+    return true;
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack(JSContext*, const Gjs::VariantSignature&,
+                      JS::HandleValue);
+
+// Element types of arrays that are converted to and from typed arrays with
+// the same memory layout, without converting each element
+struct FixedArrayElement {
+    JS::Scalar::Type scalar;
+    size_t size;
+};
+
+[[nodiscard]]
+static Maybe<FixedArrayElement> fixed_array_element(char kind) {
+    switch (kind) {
+        case 'y':
+            return Some(FixedArrayElement{JS::Scalar::Uint8, sizeof(uint8_t)});
+        case 'n':
+            return Some(FixedArrayElement{JS::Scalar::Int16, sizeof(int16_t)});
+        case 'q':
+            return Some(
+                FixedArrayElement{JS::Scalar::Uint16, sizeof(uint16_t)});
+        case 'i':
+        case 'h':
+            return Some(FixedArrayElement{JS::Scalar::Int32, sizeof(int32_t)});
+        case 'u':
+            return Some(
+                FixedArrayElement{JS::Scalar::Uint32, sizeof(uint32_t)});
+        case 'x':
+            return Some(
+                FixedArrayElement{JS::Scalar::BigInt64, sizeof(int64_t)});
+        case 't':
+            return Some(
+                FixedArrayElement{JS::Scalar::BigUint64, sizeof(uint64_t)});
+        case 'd':
+            return Some(FixedArrayElement{JS::Scalar::Float64, sizeof(double)});
+        default:
+            return Nothing{};
+    }
+}
+
+[[nodiscard]]
+static GVariant* pack_typed_array(const Gjs::VariantSignature& element,
+                                  const FixedArrayElement& fixed,
+                                  JSObject* typed_array) {
+    size_t n_bytes = JS_GetArrayBufferViewByteLength(typed_array);
+    if (n_bytes == 0)
+        return g_variant_new_array(element.type(), nullptr, 0);
+
+    // The data is copied, so the typed array is free to change afterwards
+    JS::AutoCheckCannotGC nogc;
+    bool is_shared_memory;
+    const void* data =
+        JS_GetArrayBufferViewData(typed_array, &is_shared_memory, nogc);
+    return g_variant_new_fixed_array(element.type(), data,
+                                     n_bytes / fixed.size, fixed.size);
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack_byte_array(JSContext* cx,
+                                 const Gjs::VariantSignature& signature,
+                                 JS::HandleValue value) {
+    if (value.isString()) {
+        // Strings are packed as 0-terminated UTF-8
+        JS::RootedString str{cx, value.toString()};
+        JS::UniqueChars utf8;
+        size_t len;
+        if (!gjs_string_to_utf8_n(cx, str, &utf8, &len))
+            return nullptr;
+        return g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, utf8.get(),
+                                         len + 1, 1);
+    }
+
+    if (value.isObject()) {
+        JS::RootedObject obj{cx, &value.toObject()};
+        if (StructBase::typecheck(cx, obj, G_TYPE_BYTES,
+                                  GjsTypecheckNoThrow{})) {
+            GBytes* bytes = StructBase::to_c_ptr<GBytes>(cx, obj);
+            if (!bytes)
+                return nullptr;
+            return g_variant_new_from_bytes(signature.type(), bytes, true);
+        }
+    }
+
+    // Array of numbers
+    JS::RootedObject array{cx};
+    if (!value_to_container(cx, value, signature, &array))
+        return nullptr;
+
+    uint32_t len;
+    if (!JS::GetArrayLength(cx, array, &len))
+        return nullptr;
+
+    std::vector<uint8_t> data(len);
+    JS::RootedValue elem{cx};
+    for (uint32_t ix = 0; ix < len; ix++) {
+        GIArgument arg;
+        bool out_of_range = false;
+        if (!JS_GetElement(cx, array, ix, &elem) ||
+            !gjs_arg_set_from_js_value<uint8_t>(cx, elem, &arg,
+                                                &out_of_range)) {
+            if (out_of_range) {
+                gjs_throw_custom(cx, JSEXN_RANGEERR, nullptr,
+                                 "Value is out of range for GVariant of type "
+                                 "uint8");
+            }
+            return nullptr;
+        }
+        data[ix] = gjs_arg_get<uint8_t>(&arg);
+    }
+    return g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, data.data(), len, 1);
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack_dictionary(JSContext* cx,
+                                 const Gjs::VariantSignature& signature,
+                                 JS::HandleValue value) {
+    const Gjs::VariantSignature& entry = signature.children[0];
+    AutoVariantBuilder builder{signature.type()};
+
+    // As before, a null dictionary is packed as an empty one
+    if (value.isNullOrUndefined())
+        return builder.end();
+
+    JS::RootedObject obj{cx};
+    if (!value_to_container(cx, value, signature, &obj))
+        return nullptr;
+
+    JS::Rooted<JS::IdVector> ids{cx, cx};
+    if (!JS_Enumerate(cx, obj, &ids))
+        return nullptr;
+
+    JS::RootedValue key{cx}, child_value{cx};
+    for (size_t ix = 0; ix < ids.length(); ix++) {
+        // Keys are always passed as strings, even for integer key types
+        JSString* key_str;
+        if (!JS_IdToValue(cx, ids[ix], &key) ||
+            !(key_str = JS::ToString(cx, key)))
+            return nullptr;
+        key.setString(key_str);
+
+        if (!JS_GetPropertyById(cx, obj, ids[ix], &child_value))
+            return nullptr;
+
+        GVariant* packed_key = pack(cx, entry.children[0], key);
+        if (!packed_key)
+            return nullptr;
+        GVariant* packed_value = pack(cx, entry.children[1], child_value);
+        if (!packed_value) {
+            g_variant_unref(g_variant_ref_sink(packed_key));
+            return nullptr;
+        }
+        builder.add(g_variant_new_dict_entry(packed_key, packed_value));
+    }
+
+    return builder.end();
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack_array(JSContext* cx,
+                            const Gjs::VariantSignature& signature,
+                            JS::HandleValue value) {
+    const Gjs::VariantSignature& element = signature.children[0];
+
+    if (value.isObject() && JS_IsTypedArrayObject(&value.toObject())) {
+        JSObject* typed_array = &value.toObject();
+        Maybe<FixedArrayElement> fixed = fixed_array_element(element.kind);
+        if (fixed &&
+            JS_GetArrayBufferViewType(typed_array) == fixed->scalar)
+            return pack_typed_array(element, *fixed, typed_array);
+    }
+
+    if (element.kind == 'y')
+        return pack_byte_array(cx, signature, value);
+    if (element.kind == '{')
+        return pack_dictionary(cx, signature, value);
+
+    JS::RootedObject array{cx};
+    if (!value_to_container(cx, value, signature, &array))
+        return nullptr;
+
+    uint32_t len;
+    if (!JS::GetArrayLength(cx, array, &len))
+        return nullptr;
+
+    AutoVariantBuilder builder{signature.type()};
+    JS::RootedValue elem{cx};
+    for (uint32_t ix = 0; ix < len; ix++) {
+        if (!JS_GetElement(cx, array, ix, &elem))
+            return nullptr;
+        GVariant* child = pack(cx, element, elem);
+        if (!child)
+            return nullptr;
+        builder.add(child);
+    }
+
+    return builder.end();
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack_tuple(JSContext* cx,
+                            const Gjs::VariantSignature& signature,
+                            JS::HandleValue value) {
+    JS::RootedObject array{cx};
+    if (!value_to_container(cx, value, signature, &array))
+        return nullptr;
+
+    uint32_t len;
+    if (!JS::GetArrayLength(cx, array, &len))
+        return nullptr;
+
+    // Extra elements are ignored, as before
+    size_t n_members = signature.children.size();
+    if (len < n_members) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "GVariant of type '%s' needs %zu elements, but only "
+                         "%u were given",
+                         signature.type_string.c_str(), n_members, len);
+        return nullptr;
+    }
+
+    AutoVariantBuilder builder{signature.type()};
+    JS::RootedValue elem{cx};
+    for (size_t ix = 0; ix < n_members; ix++) {
+        if (!JS_GetElement(cx, array, ix, &elem))
+            return nullptr;
+        GVariant* child = pack(cx, signature.children[ix], elem);
+        if (!child)
+            return nullptr;
+        builder.add(child);
+    }
+
+    return builder.end();
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack_dict_entry(JSContext* cx,
+                                 const Gjs::VariantSignature& signature,
+                                 JS::HandleValue value) {
+    JS::RootedObject pair{cx};
+    if (!value_to_container(cx, value, signature, &pair))
+        return nullptr;
+
+    JS::RootedValue elem{cx};
+    if (!JS_GetElement(cx, pair, 0, &elem))
+        return nullptr;
+    GVariant* key = pack(cx, signature.children[0], elem);
+    if (!key)
+        return nullptr;
+
+    GVariant* child;
+    if (!JS_GetElement(cx, pair, 1, &elem) ||
+        !(child = pack(cx, signature.children[1], elem))) {
+        g_variant_unref(g_variant_ref_sink(key));
+        return nullptr;
+    }
+
+    return g_variant_new_dict_entry(key, child);
+}
+
+// Returns a floating reference
+static GVariant* pack(JSContext* cx, const Gjs::VariantSignature& signature,
+                      JS::HandleValue value) {
+    switch (signature.kind) {
+        case 'b':
+            return g_variant_new_boolean(JS::ToBoolean(value));
+        case 'y':
+            return pack_number<uint8_t>(cx, value, g_variant_new_byte);
+        case 'n':
+            return pack_number<int16_t>(cx, value, g_variant_new_int16);
+        case 'q':
+            return pack_number<uint16_t>(cx, value, g_variant_new_uint16);
+        case 'i':
+            return pack_number<int32_t>(cx, value, g_variant_new_int32);
+        case 'u':
+            return pack_number<uint32_t>(cx, value, g_variant_new_uint32);
+        case 'x':
+            return pack_number<int64_t>(cx, value, g_variant_new_int64);
+        case 't':
+            return pack_number<uint64_t>(cx, value, g_variant_new_uint64);
+        case 'h':
+            return pack_number<int32_t>(cx, value, g_variant_new_handle);
+        case 'd':
+            return pack_number<double>(cx, value, g_variant_new_double);
+        case 's':
+        case 'o':
+        case 'g':
+            return pack_string(cx, signature.kind, value);
+        case 'v': {
+            JS::RootedObject obj{cx};
+            if (!value_to_container(cx, value, signature, &obj) ||
+                !StructBase::typecheck(cx, obj, G_TYPE_VARIANT))
+                return nullptr;
+            GVariant* child = StructBase::to_c_ptr<GVariant>(cx, obj);
+            if (!child)
+                return nullptr;
+            return g_variant_new_variant(child);
+        }
+        case 'm': {
+            const Gjs::VariantSignature& element = signature.children[0];
+            if (value.isNull())
+                return g_variant_new_maybe(element.type(), nullptr);
+            GVariant* child = pack(cx, element, value);
+            if (!child)
+                return nullptr;
+            return g_variant_new_maybe(nullptr, child);
+        }
+        case 'a':
+            return pack_array(cx, signature, value);
+        case '(':
+            return pack_tuple(cx, signature, value);
+        case '{':
+            return pack_dict_entry(cx, signature, value);
+        default:
+            g_assert_not_reached();
+    }
+}
+
+GVariant* gjs_variant_pack(JSContext* cx, const char* signature,
+                           JS::HandleValue value) {
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    std::shared_ptr<const Gjs::VariantSignature> parsed =
+        gjs->variant_signatures().lookup(cx, signature);
+    if (!parsed)
+        return nullptr;
+    return pack(cx, *parsed, value);
+}
+
+GVariant* gjs_variant_pack(JSContext* cx,
+                           const Gjs::VariantSignature& signature,
+                           JS::HandleValue value) {
+    return pack(cx, signature, value);
+}
+
+GVariant* gjs_variant_pack_tuple(JSContext* cx,
+                                 const Gjs::VariantSignature& signature,
+                                 const JS::HandleValueArray& values) {
+    g_assert(signature.kind == '(' &&
+             values.length() == signature.children.size());
+
+    AutoVariantBuilder builder{signature.type()};
+    for (size_t ix = 0; ix < values.length(); ix++) {
+        GVariant* child = pack(cx, signature.children[ix], values[ix]);
+        if (!child)
+            return nullptr;
+        builder.add(child);
+    }
+
+    return builder.end();
+}
+
+class VariantUnpacker {
+    JSContext* m_cx;
+    bool m_recursive;
+    Maybe<GI::AutoStructInfo> m_info;
+
+ public:
+    VariantUnpacker(JSContext* cx, bool recursive)
+        : m_cx(cx), m_recursive(recursive) {}
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool wrap(GVariant* variant, JS::MutableHandleValue value_p) {
+        if (!m_info) {
+            m_info = GI::Repository{}.find_by_gtype<GI::InfoTag::STRUCT>(
+                G_TYPE_VARIANT);
+            g_assert(m_info && "GLib.Variant must be introspectable");
+        }
+
+        JSObject* obj =
+            StructInstance::new_for_c_struct(m_cx, *m_info, variant);
+        if (!obj)
+            return false;
+        value_p.setObject(*obj);
+        return true;
+    }
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool unpack(GVariant*, bool deep, JS::MutableHandleValue);
+
+ private:
+    GJS_JSAPI_RETURN_CONVENTION
+    bool unpack_child(GVariant* child, bool deep,
+                      JS::MutableHandleValue value_p) {
+        if (deep)
+            return unpack(child, deep, value_p);
+        return wrap(child, value_p);
+    }
+
+    template <typename T>
+    GJS_JSAPI_RETURN_CONVENTION bool unpack_fixed_array(
+        GVariant*, JS::MutableHandleValue);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool unpack_dictionary(GVariant*, bool deep, JS::MutableHandleValue);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool unpack_children(GVariant*, bool deep, JS::MutableHandleValue);
+};
+
+template <typename T>
+bool VariantUnpacker::unpack_fixed_array(GVariant* variant,
+                                         JS::MutableHandleValue value_p) {
+    size_t n_elements;
+    auto* elements = static_cast<const T*>(
+        g_variant_get_fixed_array(variant, &n_elements, sizeof(T)));
+
+    JS::RootedValueVector elems{m_cx};
+    if (!elems.resize(n_elements)) {
+        JS_ReportOutOfMemory(m_cx);
+        return false;
+    }
+    for (size_t ix = 0; ix < n_elements; ix++) {
+        if (!Gjs::c_value_to_js_checked<T>(m_cx, elements[ix], elems[ix]))
+            return false;
+    }
+
+    JSObject* array = JS::NewArrayObject(m_cx, elems);
+    if (!array)
+        return false;
+    value_p.setObject(*array);
+    return true;
+}
+
+bool VariantUnpacker::unpack_dictionary(GVariant* variant, bool deep,
+                                        JS::MutableHandleValue value_p) {
+    JS::RootedObject obj{m_cx, JS_NewPlainObject(m_cx)};
+    if (!obj)
+        return false;
+
+    size_t n_entries = g_variant_n_children(variant);
+    JS::RootedValue key{m_cx}, child_value{m_cx};
+    JS::RootedId key_id{m_cx};
+    for (size_t ix = 0; ix < n_entries; ix++) {
+        Gjs::AutoGVariant entry{g_variant_get_child_value(variant, ix)};
+        Gjs::AutoGVariant packed_key{g_variant_get_child_value(entry, 0)};
+        Gjs::AutoGVariant packed_value{g_variant_get_child_value(entry, 1)};
+
+        // The key is always unpacked, or it cannot be a property key
+        if (!unpack(packed_key, true, &key) ||
+            !JS_ValueToId(m_cx, key, &key_id) ||
+            !unpack_child(packed_value, deep, &child_value) ||
+            !JS_SetPropertyById(m_cx, obj, key_id, child_value))
+            return false;
+    }
+
+    value_p.setObject(*obj);
+    return true;
+}
+
+bool VariantUnpacker::unpack_children(GVariant* variant, bool deep,
+                                      JS::MutableHandleValue value_p) {
+    size_t n_children = g_variant_n_children(variant);
+    JS::RootedValueVector elems{m_cx};
+    if (!elems.resize(n_children)) {
+        JS_ReportOutOfMemory(m_cx);
+        return false;
+    }
+
+    for (size_t ix = 0; ix < n_children; ix++) {
+        Gjs::AutoGVariant child{g_variant_get_child_value(variant, ix)};
+        if (!unpack_child(child, deep, elems[ix]))
+            return false;
+    }
+
+    JSObject* array = JS::NewArrayObject(m_cx, elems);
+    if (!array)
+        return false;
+    value_p.setObject(*array);
+    return true;
+}
+
+bool VariantUnpacker::unpack(GVariant* variant, bool deep,
+                             JS::MutableHandleValue value_p) {
+    switch (g_variant_classify(variant)) {
+        case G_VARIANT_CLASS_BOOLEAN:
+            value_p.setBoolean(g_variant_get_boolean(variant));
+            return true;
+        case G_VARIANT_CLASS_BYTE:
+            value_p.setInt32(g_variant_get_byte(variant));
+            return true;
+        case G_VARIANT_CLASS_INT16:
+            value_p.setInt32(g_variant_get_int16(variant));
+            return true;
+        case G_VARIANT_CLASS_UINT16:
+            value_p.setInt32(g_variant_get_uint16(variant));
+            return true;
+        case G_VARIANT_CLASS_INT32:
+            value_p.setInt32(g_variant_get_int32(variant));
+            return true;
+        case G_VARIANT_CLASS_UINT32:
+            value_p.setNumber(g_variant_get_uint32(variant));
+            return true;
+        case G_VARIANT_CLASS_INT64:
+            return Gjs::c_value_to_js_checked<int64_t>(
+                m_cx, g_variant_get_int64(variant), value_p);
+        case G_VARIANT_CLASS_UINT64:
+            return Gjs::c_value_to_js_checked<uint64_t>(
+                m_cx, g_variant_get_uint64(variant), value_p);
+        case G_VARIANT_CLASS_HANDLE:
+            value_p.setInt32(g_variant_get_handle(variant));
+            return true;
+        case G_VARIANT_CLASS_DOUBLE:
+            return Gjs::c_value_to_js<double>(
+                m_cx, g_variant_get_double(variant), value_p);
+        case G_VARIANT_CLASS_STRING:
+        case G_VARIANT_CLASS_OBJECT_PATH:
+        case G_VARIANT_CLASS_SIGNATURE: {
+            size_t len;
+            const char* str = g_variant_get_string(variant, &len);
+            return gjs_string_from_utf8_n(m_cx, str, len, value_p);
+        }
+        case G_VARIANT_CLASS_VARIANT: {
+            Gjs::AutoGVariant child{g_variant_get_variant(variant)};
+            return unpack_child(child, deep && m_recursive, value_p);
+        }
+        case G_VARIANT_CLASS_MAYBE: {
+            Gjs::AutoGVariant child{g_variant_get_maybe(variant)};
+            if (!child) {
+                value_p.setNull();
+                return true;
+            }
+            return unpack_child(child, deep, value_p);
+        }
+        case G_VARIANT_CLASS_ARRAY: {
+            const GVariantType* element =
+                g_variant_type_element(g_variant_get_type(variant));
+
+            if (g_variant_type_is_dict_entry(element))
+                return unpack_dictionary(variant, deep, value_p);
+
+            if (g_variant_type_equal(element, G_VARIANT_TYPE_BYTE)) {
+                // Byte arrays are always unpacked, to a Uint8Array
+                size_t len;
+                const void* data =
+                    g_variant_get_fixed_array(variant, &len, sizeof(uint8_t));
+                JSObject* array = gjs_byte_array_from_data_copy(
+                    m_cx, len, const_cast<void*>(data));
+                if (!array)
+                    return false;
+                value_p.setObject(*array);
+                return true;
+            }
+
+            // Arrays of fixed-size numbers can be read in one go
+            if (deep) {
+                switch (g_variant_type_peek_string(element)[0]) {
+                    case 'n':
+                        return unpack_fixed_array<int16_t>(variant, value_p);
+                    case 'q':
+                        return unpack_fixed_array<uint16_t>(variant, value_p);
+                    case 'i':
+                    case 'h':
+                        return unpack_fixed_array<int32_t>(variant, value_p);
+                    case 'u':
+                        return unpack_fixed_array<uint32_t>(variant, value_p);
+                    case 'x':
+                        return unpack_fixed_array<int64_t>(variant, value_p);
+                    case 't':
+                        return unpack_fixed_array<uint64_t>(variant, value_p);
+                    case 'd':
+                        return unpack_fixed_array<double>(variant, value_p);
+                    default:
+                        break;
+                }
+            }
+
+            return unpack_children(variant, deep, value_p);
+        }
+        case G_VARIANT_CLASS_TUPLE:
+        case G_VARIANT_CLASS_DICT_ENTRY:
+            return unpack_children(variant, deep, value_p);
+        default:
+            g_assert_not_reached();
+    }
+}
+
+bool gjs_variant_unpack(JSContext* cx, GVariant* variant,
+                        GjsVariantUnpack mode, JS::MutableHandleValue value_p) {
+    VariantUnpacker unpacker{cx, mode == GjsVariantUnpack::RECURSIVE};
+    return unpacker.unpack(variant, mode != GjsVariantUnpack::SHALLOW, value_p);
+}
+
+bool gjs_variant_construct(JSContext* cx, const JS::CallArgs& args) {
+    if (!args.requireAtLeast(cx, "GLib.Variant", 2))
+        return false;
+
+    JS::UniqueChars signature{gjs_string_to_utf8(cx, args[0])};
+    if (!signature)
+        return false;
+
+    GVariant* packed = gjs_variant_pack(cx, signature.get(), args[1]);
+    if (!packed)
+        return false;
+
+    Gjs::AutoGVariant variant{g_variant_ref_sink(packed)};
+    VariantUnpacker unpacker{cx, false};
+    return unpacker.wrap(variant, args.rval());
+}
+
+template <GjsVariantUnpack MODE>
+GJS_JSAPI_RETURN_CONVENTION static bool variant_unpack_func(JSContext* cx,
+                                                            unsigned argc,
+                                                            JS::Value* vp) {
+    GJS_GET_THIS(cx, argc, vp, args, self);
+
+    if (!StructBase::typecheck(cx, self, G_TYPE_VARIANT))
+        return false;
+    GVariant* variant = StructBase::to_c_ptr<GVariant>(cx, self);
+    if (!variant)
+        return false;
+
+    return gjs_variant_unpack(cx, variant, MODE, args.rval());
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static JSObject* new_typed_array(JSContext* cx, JS::Scalar::Type scalar,
+                                 JS::HandleObject buffer) {
+    switch (scalar) {
+        case JS::Scalar::Uint8:
+            return JS_NewUint8ArrayWithBuffer(cx, buffer, 0, -1);
+        case JS::Scalar::Int16:
+            return JS_NewInt16ArrayWithBuffer(cx, buffer, 0, -1);
+        case JS::Scalar::Uint16:
+            return JS_NewUint16ArrayWithBuffer(cx, buffer, 0, -1);
+        case JS::Scalar::Int32:
+            return JS_NewInt32ArrayWithBuffer(cx, buffer, 0, -1);
+        case JS::Scalar::Uint32:
+            return JS_NewUint32ArrayWithBuffer(cx, buffer, 0, -1);
+        case JS::Scalar::BigInt64:
+            return JS_NewBigInt64ArrayWithBuffer(cx, buffer, 0, -1);
+        case JS::Scalar::BigUint64:
+            return JS_NewBigUint64ArrayWithBuffer(cx, buffer, 0, -1);
+        case JS::Scalar::Float64:
+            return JS_NewFloat64ArrayWithBuffer(cx, buffer, 0, -1);
+        default:
+            g_assert_not_reached();
+    }
+}
+
+/* Copies the elements of an array of fixed-size numbers into a typed array
+ * with the same layout, in one go. The GVariant data is not exposed directly
+ * because it may be in read-only memory, such as a mapped GResource, and
+ * SpiderMonkey has no read-only ArrayBuffers that we could use for it. */
+GJS_JSAPI_RETURN_CONVENTION
+static bool variant_to_typed_array_func(JSContext* cx, unsigned argc,
+                                        JS::Value* vp) {
+    GJS_GET_THIS(cx, argc, vp, args, self);
+
+    if (!StructBase::typecheck(cx, self, G_TYPE_VARIANT))
+        return false;
+    GVariant* variant = StructBase::to_c_ptr<GVariant>(cx, self);
+    if (!variant)
+        return false;
+
+    const char* type_string = g_variant_get_type_string(variant);
+    Maybe<FixedArrayElement> fixed;
+    if (type_string[0] == 'a')
+        fixed = fixed_array_element(type_string[1]);
+    if (!fixed) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "Cannot convert a GVariant of type '%s' to a typed "
+                         "array",
+                         type_string);
+        return false;
+    }
+
+    size_t n_elements;
+    const void* data =
+        g_variant_get_fixed_array(variant, &n_elements, fixed->size);
+    size_t n_bytes = n_elements * fixed->size;
+
+    JS::RootedObject buffer{cx, JS::NewArrayBuffer(cx, n_bytes)};
+    if (!buffer)
+        return false;
+
+    if (n_bytes > 0) {
+        JS::AutoCheckCannotGC nogc;
+        bool unused;
+        uint8_t* storage = JS::GetArrayBufferData(buffer, &unused, nogc);
+        std::copy_n(static_cast<const uint8_t*>(data), n_bytes, storage);
+    }
+
+    JSObject* typed_array = new_typed_array(cx, fixed->scalar, buffer);
+    if (!typed_array)
+        return false;
+    args.rval().setObject(*typed_array);
+    return true;
+}
+
+// clang-format off
+static JSFunctionSpec variant_proto_funcs[] = {
+    JS_FN("unpack", variant_unpack_func<GjsVariantUnpack::SHALLOW>, 0, 0),
+    JS_FN("deepUnpack", variant_unpack_func<GjsVariantUnpack::DEEP>, 0, 0),
+    // backwards compatibility alias
+    JS_FN("deep_unpack", variant_unpack_func<GjsVariantUnpack::DEEP>, 0, 0),
+    // Note: discards type information, if the variant contains any 'v' types
+    JS_FN("recursiveUnpack", variant_unpack_func<GjsVariantUnpack::RECURSIVE>,
+          0, 0),
+    JS_FN("toTypedArray", variant_to_typed_array_func, 0, 0),
+    JS_FS_END};
+// clang-format on
+
+bool gjs_variant_define_methods(JSContext* cx, JS::HandleObject prototype) {
+    return JS_DefineFunctions(cx, prototype, variant_proto_funcs);
+}
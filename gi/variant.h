@@ -0,0 +1,93 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+
+#include <memory>  // for shared_ptr
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glib.h>
+
+#include <js/TypeDecls.h>
+
+#include "gjs/macros.h"
+
+namespace JS {
+class CallArgs;
+class HandleValueArray;
+}
+
+namespace Gjs {
+
+/* A parsed GVariant type string, as accepted by `new GLib.Variant()`: any
+ * definite type, except that indefinite types such as `*` or `r` are rejected.
+ * Container types have their element types (`a`, `m`), members (`(`) or key
+ * and value (`{`) as children. */
+struct VariantSignature {
+    char kind;
+    std::string type_string;
+    std::vector<VariantSignature> children;
+
+    [[nodiscard]] const GVariantType* type() const {
+        return G_VARIANT_TYPE(type_string.c_str());
+    }
+};
+
+/* Per-context cache of parsed signatures passed to `new GLib.Variant()`, so
+ * that packing a value with a signature that was already seen doesn't have to
+ * parse and validate it again. Invalid signatures are not cached.
+ *
+ * Signatures can be built at runtime, so the cache is emptied when it reaches
+ * MAX_ENTRIES. Entries are shared, so that a signature stays alive while a
+ * value is being packed with it, even if packing runs JS code that empties the
+ * cache. */
+class VariantSignatureCache {
+    std::unordered_map<std::string, std::shared_ptr<const VariantSignature>>
+        m_signatures;
+
+ public:
+    static constexpr size_t MAX_ENTRIES = 256;
+
+    GJS_JSAPI_RETURN_CONVENTION
+    std::shared_ptr<const VariantSignature> lookup(JSContext*,
+                                                   const char* signature);
+
+    void clear() { m_signatures.clear(); }
+};
+
+}  // namespace Gjs
+
+enum class GjsVariantUnpack {
+    SHALLOW,    // unpack(): only the outermost container
+    DEEP,       // deepUnpack(): everything except the contents of `v`
+    RECURSIVE,  // recursiveUnpack(): everything
+};
+
+GJS_JSAPI_RETURN_CONVENTION
+GVariant* gjs_variant_pack(JSContext*, const char* signature, JS::HandleValue);
+GJS_JSAPI_RETURN_CONVENTION
+GVariant* gjs_variant_pack(JSContext*, const Gjs::VariantSignature&,
+                           JS::HandleValue);
+
+// Packs each of `values` as the corresponding member of the tuple type
+// `signature`, for example the arguments of a D-Bus method call
+GJS_JSAPI_RETURN_CONVENTION
+GVariant* gjs_variant_pack_tuple(JSContext*, const Gjs::VariantSignature&,
+                                 const JS::HandleValueArray& values);
+
+GJS_JSAPI_RETURN_CONVENTION
+bool gjs_variant_unpack(JSContext*, GVariant*, GjsVariantUnpack,
+                        JS::MutableHandleValue);
+
+GJS_JSAPI_RETURN_CONVENTION
+bool gjs_variant_construct(JSContext*, const JS::CallArgs&);
+
+GJS_JSAPI_RETURN_CONVENTION
+bool gjs_variant_define_methods(JSContext*, JS::HandleObject prototype);
@@ -564,8 +564,9 @@ class GIWrapperBase : public CWrapperPointerOps<Base> {
         Instance* priv = Instance::new_for_js_object(prototype, obj);
 
         {
-            std::string full_name{
-                GJS_PROFILER_DYNAMIC_STRING(cx, priv->format_name())};
+            const char* full_name = Gjs::profiler_label(
+                cx, {priv->gtype(), priv->name(), nullptr},
+                [priv]() { return priv->format_name(); });
             AutoProfilerLabel label{cx, "constructor", full_name};
 
             if (!priv->constructor_impl(cx, obj, args))
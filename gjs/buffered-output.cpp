@@ -0,0 +1,216 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <errno.h>
+#include <limits.h>  // for PIPE_BUF
+#include <stddef.h>  // for size_t
+#include <stdio.h>
+
+#include <sys/types.h>  // for ssize_t
+
+#ifdef HAVE_UNISTD_H
+#    include <sys/socket.h>  // for send, MSG_DONTWAIT
+#    include <sys/stat.h>    // for fstat, S_ISFIFO, S_ISSOCK
+#    include <unistd.h>      // for write
+#endif
+
+#include <algorithm>  // for min
+#include <string_view>
+
+#include <glib.h>
+#ifdef G_OS_UNIX
+#    include <glib-unix.h>
+#endif
+
+#include "gjs/buffered-output.h"
+#include "util/log.h"
+
+namespace Gjs {
+
+void BufferedOutput::Buffer::consume(size_t n_bytes) {
+    written += n_bytes;
+    if (written == data.size()) {
+        data.clear();
+        written = 0;
+    } else if (written > data.size() / 2) {
+        data.erase(0, written);
+        written = 0;
+    }
+}
+
+BufferedOutput::BufferedOutput(size_t threshold)
+    : m_main_context(g_main_context_ref_thread_default()),
+      m_threshold(threshold) {
+    FILE* files[N_STREAMS] = {stdout, stderr};
+    for (unsigned ix = 0; ix < N_STREAMS; ix++) {
+        Buffer& buffer = m_buffers[ix];
+        buffer.owner = this;
+        buffer.file = files[ix];
+        buffer.fd = fileno(files[ix]);
+        buffer.is_pipe = buffer.is_socket = false;
+
+#ifdef G_OS_UNIX
+        struct stat st;
+        if (buffer.fd >= 0 && fstat(buffer.fd, &st) == 0) {
+            buffer.is_pipe = S_ISFIFO(st.st_mode);
+            buffer.is_socket = S_ISSOCK(st.st_mode);
+        }
+#endif
+    }
+
+    gjs_debug(GJS_DEBUG_CONTEXT,
+              "Buffering output with a threshold of %zu bytes", threshold);
+}
+
+BufferedOutput::~BufferedOutput() { flush(); }
+
+void BufferedOutput::schedule_idle() {
+    if (m_idle)
+        return;
+
+    m_idle = g_idle_source_new();
+    g_source_set_callback(m_idle, &BufferedOutput::on_idle, this, nullptr);
+    g_source_set_static_name(m_idle, "[gjs] Buffered output");
+    g_source_attach(m_idle, m_main_context);
+}
+
+gboolean BufferedOutput::on_idle(void* data) {
+    auto* self = static_cast<BufferedOutput*>(data);
+
+    g_clear_pointer(&self->m_idle, g_source_unref);
+    for (Buffer& buffer : self->m_buffers) {
+        if (buffer.pending() > 0 && !buffer.fd_watch)
+            self->write_nonblocking(&buffer);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+gboolean BufferedOutput::on_fd_writable(int, GIOCondition, void* data) {
+    auto* buffer = static_cast<Buffer*>(data);
+    GSource* watch = buffer->fd_watch;
+
+    buffer->owner->write_nonblocking(buffer);
+
+    // write_nonblocking() removes the watch once everything is written
+    return buffer->fd_watch == watch ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+void BufferedOutput::watch_fd(Buffer* buffer) {
+#ifdef G_OS_UNIX
+    if (buffer->fd_watch)
+        return;
+
+    buffer->fd_watch = g_unix_fd_source_new(buffer->fd, G_IO_OUT);
+    g_source_set_callback(buffer->fd_watch,
+                          G_SOURCE_FUNC(&BufferedOutput::on_fd_writable),
+                          buffer, nullptr);
+    g_source_set_static_name(buffer->fd_watch, "[gjs] Buffered output");
+    g_source_attach(buffer->fd_watch, m_main_context);
+#else
+    g_assert_not_reached();
+#endif
+}
+
+void BufferedOutput::unwatch_fd(Buffer* buffer) {
+    if (!buffer->fd_watch)
+        return;
+
+    g_source_destroy(buffer->fd_watch);
+    g_clear_pointer(&buffer->fd_watch, g_source_unref);
+}
+
+void BufferedOutput::write_nonblocking(Buffer* buffer) {
+#ifdef G_OS_UNIX
+    if (buffer->is_pipe || buffer->is_socket) {
+        // Anything written with stdio must come out before our output
+        fflush(buffer->file);
+
+        while (buffer->pending() > 0) {
+            const char* start = buffer->data.data() + buffer->written;
+            ssize_t n_written;
+
+            if (buffer->is_socket) {
+                n_written = send(buffer->fd, start, buffer->pending(),
+                                 MSG_DONTWAIT);
+            } else {
+                // A write of at most PIPE_BUF bytes does not block if poll()
+                // reports the pipe as writable
+                GPollFD poll_fd = {buffer->fd, G_IO_OUT, 0};
+                if (g_poll(&poll_fd, 1, 0) < 1)
+                    break;
+                n_written =
+                    ::write(buffer->fd, start,
+                            std::min(buffer->pending(), size_t{PIPE_BUF}));
+            }
+
+            if (n_written < 0) {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+
+                // Like stdio, drop output that can't be written
+                gjs_debug(GJS_DEBUG_CONTEXT, "Error writing output: %s",
+                          g_strerror(errno));
+                buffer->consume(buffer->pending());
+                break;
+            }
+
+            buffer->consume(n_written);
+        }
+
+        if (buffer->pending() > 0)
+            watch_fd(buffer);
+        else
+            unwatch_fd(buffer);
+        return;
+    }
+#endif
+
+    // Writes to terminals and regular files are not worth deferring
+    flush(buffer);
+}
+
+void BufferedOutput::flush(Buffer* buffer) {
+    unwatch_fd(buffer);
+
+    if (buffer->pending() > 0) {
+        fwrite(buffer->data.data() + buffer->written, 1, buffer->pending(),
+               buffer->file);
+        buffer->consume(buffer->pending());
+    }
+    fflush(buffer->file);
+}
+
+void BufferedOutput::write(Stream stream, std::string_view text) {
+    Buffer* buffer = &m_buffers[stream];
+    buffer->data.append(text);
+
+    if (buffer->pending() < m_threshold) {
+        schedule_idle();
+        return;
+    }
+
+    if (!buffer->fd_watch)
+        write_nonblocking(buffer);
+
+    // Block rather than let memory use grow without bound if the reader can't
+    // keep up
+    if (buffer->pending() > 4 * m_threshold)
+        flush(buffer);
+}
+
+void BufferedOutput::flush() {
+    if (m_idle) {
+        g_source_destroy(m_idle);
+        g_clear_pointer(&m_idle, g_source_unref);
+    }
+
+    for (Buffer& buffer : m_buffers)
+        flush(&buffer);
+}
+
+}  // namespace Gjs
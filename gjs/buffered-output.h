@@ -0,0 +1,79 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdio.h>   // for FILE
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include <glib.h>
+
+#include "gjs/auto.h"
+
+namespace Gjs {
+
+/* Buffers the output of print() and printerr(), so that a script that prints a
+ * lot does not block on every call when stdout is a slow pipe or socket, such
+ * as a log collector.
+ *
+ * Output is written when the main loop is idle, when more than `threshold`
+ * bytes are pending, and when the context is disposed or the program exits.
+ * Writing to a pipe or socket from the main loop never blocks: whatever does
+ * not fit is kept and written once the file descriptor becomes writable again.
+ * Only if more than four times `threshold` bytes pile up does writing block, so
+ * that memory use stays bounded. */
+class BufferedOutput {
+ public:
+    enum Stream : unsigned { STDOUT, STDERR, N_STREAMS };
+
+ private:
+    struct Buffer {
+        BufferedOutput* owner;
+        FILE* file;
+        int fd;
+        bool is_pipe;
+        bool is_socket;
+        std::string data;
+        size_t written = 0;  // bytes at the start of data already written
+        GSource* fd_watch = nullptr;
+
+        [[nodiscard]] size_t pending() const { return data.size() - written; }
+        void consume(size_t n_bytes);
+    };
+
+    AutoPointer<GMainContext, GMainContext, g_main_context_unref>
+        m_main_context;
+    std::array<Buffer, N_STREAMS> m_buffers;
+    GSource* m_idle = nullptr;
+    size_t m_threshold;
+
+    static gboolean on_idle(void* data);
+    static gboolean on_fd_writable(int fd, GIOCondition, void* data);
+    void schedule_idle();
+    void write_nonblocking(Buffer*);
+    void flush(Buffer*);
+    void watch_fd(Buffer*);
+    void unwatch_fd(Buffer*);
+
+ public:
+    static constexpr size_t DEFAULT_THRESHOLD = 64 * 1024;
+
+    explicit BufferedOutput(size_t threshold = DEFAULT_THRESHOLD);
+    ~BufferedOutput();
+
+    BufferedOutput(const BufferedOutput&) = delete;
+    BufferedOutput& operator=(const BufferedOutput&) = delete;
+
+    void write(Stream, std::string_view text);
+    // Blocks until all pending output is written
+    void flush();
+};
+
+}  // namespace Gjs
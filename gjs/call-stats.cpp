@@ -0,0 +1,142 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>  // for strcmp
+
+#include <algorithm>  // for min, sort
+#include <chrono>
+#include <functional>  // for hash
+#include <string>
+#include <utility>  // for pair
+#include <vector>
+
+#include <glib.h>
+
+#include "gjs/call-stats.h"
+#include "gjs/context-private.h"
+#include "util/misc.h"  // for LogFile
+
+namespace Gjs {
+
+size_t CallStats::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<GType>{}(key.gtype);
+    hash = hash * 31 + std::hash<const void*>{}(key.kind);
+    return hash * 31 + std::hash<const void*>{}(key.member);
+}
+
+void CallStats::Entry::record(Clock::duration total_time,
+                              Clock::duration native_time) {
+    calls++;
+    total += total_time;
+    native += native_time;
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(total_time);
+    size_t bits = g_bit_storage(gulong(std::max<int64_t>(ns.count(), 0)));
+    buckets[std::min(bits, N_BUCKETS - 1)]++;
+}
+
+uint64_t CallStats::Entry::percentile_ns(double percentile) const {
+    uint64_t threshold = uint64_t(percentile / 100.0 * calls);
+    uint64_t seen = 0;
+    for (size_t ix = 0; ix < N_BUCKETS; ix++) {
+        seen += buckets[ix];
+        if (seen > threshold || seen == calls)
+            return uint64_t{1} << ix;
+    }
+    return uint64_t{1} << (N_BUCKETS - 1);
+}
+
+static double to_ms(CallStats::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static double to_us(CallStats::Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void CallStats::report(FILE* fp) const {
+    std::vector<std::pair<const std::string*, const Entry*>> sorted;
+    sorted.reserve(m_entries.size());
+    for (const auto& [name, entry] : m_entries) {
+        if (entry.calls > 0)
+            sorted.emplace_back(&name, &entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second->total > b.second->total;
+    });
+
+    uint64_t total_calls = 0;
+    Clock::duration total{}, native{};
+
+    fprintf(fp, "# GI call statistics, most time first #\n\n");
+    fprintf(fp, "%10s %10s %10s %10s %10s %10s %10s  %s\n", "calls",
+            "total ms", "convert ms", "native ms", "mean us", "p50 us",
+            "p99 us", "callable");
+    for (const auto& [name, entry] : sorted) {
+        fprintf(fp, "%10" G_GUINT64_FORMAT " %10.3f %10.3f %10.3f %10.3f",
+                entry->calls, to_ms(entry->total),
+                to_ms(entry->total - entry->native), to_ms(entry->native),
+                to_us(entry->total) / entry->calls);
+        fprintf(fp, " %10.3f %10.3f  %s\n", entry->percentile_ns(50) / 1000.0,
+                entry->percentile_ns(99) / 1000.0, name->c_str());
+        total_calls += entry->calls;
+        total += entry->total;
+        native += entry->native;
+    }
+
+    fprintf(fp, "%10" G_GUINT64_FORMAT " %10.3f %10.3f %10.3f", total_calls,
+            to_ms(total), to_ms(total - native), to_ms(native));
+    fprintf(fp, "  (%zu callables)\n", sorted.size());
+}
+
+void CallStats::report() const {
+    const char* filename = m_output.c_str();
+    if (strcmp(filename, "stderr") == 0 || strcmp(filename, "1") == 0)
+        filename = nullptr;
+
+    LogFile file{filename, stderr};
+    if (file.has_error()) {
+        g_warning("Cannot write GI call statistics to %s: %s", filename,
+                  file.errmsg());
+        return;
+    }
+    report(file.fp());
+}
+
+AutoCallTimer::AutoCallTimer(JSContext* cx, CallStats::Entry* entry)
+    : m_entry(entry) {
+    if (!m_entry)
+        return;
+
+    m_stats = GjsContextPrivate::from_cx(cx)->call_stats();
+    m_parent = m_stats->m_current;
+    m_stats->m_current = this;
+    m_begin = CallStats::Clock::now();
+}
+
+AutoCallTimer::~AutoCallTimer() {
+    if (!m_entry)
+        return;
+
+    m_entry->record(CallStats::Clock::now() - m_begin, m_native);
+    g_assert(m_stats->m_current == this &&
+             "Call timers must be strictly nested");
+    m_stats->m_current = m_parent;
+}
+
+AutoNativeCallTimer::AutoNativeCallTimer(JSContext* cx) {
+    CallStats* stats = GjsContextPrivate::from_cx(cx)->call_stats();
+    if (!stats || !stats->m_current)
+        return;
+
+    m_timer = stats->m_current;
+    m_timer->begin_native();
+}
+
+}  // namespace Gjs
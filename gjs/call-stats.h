@@ -0,0 +1,153 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+#include <stdio.h>  // for FILE
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>  // for forward
+
+#include <glib-object.h>
+
+#include <js/TypeDecls.h>
+
+namespace Gjs {
+
+class AutoCallTimer;
+
+/* Counts the calls into introspected C code made from JS, per callable: GI
+ * functions and methods, and the accessors of GObject properties and fields.
+ * For each one, records the number of calls, the total time, the part of it
+ * spent in the C function itself, and a histogram of call durations. The rest
+ * of the time is spent converting arguments and return values. Durations
+ * include any JS code that the C function calls back into.
+ *
+ * Only present if GJS_CALL_STATS is set; the report is written when the
+ * context is disposed, or on demand with System.dumpCallStats(). Only the JS
+ * thread touches the statistics, so they need no locking. */
+class CallStats {
+    friend class AutoCallTimer;
+    friend class AutoNativeCallTimer;
+
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        // Durations, bucketed by their number of significant bits in ns, so
+        // bucket N holds durations below 2^N ns
+        static constexpr size_t N_BUCKETS = 40;
+
+        uint64_t calls = 0;
+        Clock::duration total{};
+        Clock::duration native{};
+        std::array<uint32_t, N_BUCKETS> buckets{};
+
+        void record(Clock::duration total_time, Clock::duration native_time);
+        // Upper bound of the duration in ns that `percentile` (0-100) of the
+        // calls took less than
+        [[nodiscard]] uint64_t percentile_ns(double percentile) const;
+    };
+
+    /* Identifies the slot of a callable without formatting its name, like
+     * ProfilerLabelKey: a GType and two pointers that must stay valid for the
+     * life of the program. */
+    struct Key {
+        GType gtype;
+        const void* kind;
+        const void* member;
+
+        bool operator==(const Key& other) const {
+            return gtype == other.gtype && kind == other.kind &&
+                   member == other.member;
+        }
+    };
+
+ private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    // Entries are never removed, so the pointers to them that callables cache
+    // stay valid for the life of the context
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<Key, Entry*, KeyHash> m_slots;
+    std::string m_output;
+    // Innermost running timer, for AutoNativeCallTimer
+    AutoCallTimer* m_current = nullptr;
+
+ public:
+    // `output` is a file path, or "stderr" or "1" for stderr
+    explicit CallStats(const char* output) : m_output(output) {}
+
+    [[nodiscard]] Entry* entry(const std::string& name) {
+        return &m_entries[name];
+    }
+
+    // Returns the entry for `key`, calling `format()` to build its name the
+    // first time
+    template <typename F>
+    [[nodiscard]] Entry* entry(const Key& key, F&& format) {
+        Entry*& slot = m_slots[key];
+        if (!slot)
+            slot = entry(std::forward<F>(format)());
+        return slot;
+    }
+
+    void report(FILE* fp) const;
+    void report() const;
+};
+
+/* Times one call of a callable whose statistics slot is `entry`. Does nothing
+ * if `entry` is null, that is, if statistics are not enabled. */
+class AutoCallTimer {
+    CallStats* m_stats = nullptr;
+    CallStats::Entry* m_entry;
+    AutoCallTimer* m_parent = nullptr;
+    CallStats::Clock::time_point m_begin;
+    CallStats::Clock::time_point m_native_begin;
+    CallStats::Clock::duration m_native{};
+
+ public:
+    AutoCallTimer(JSContext*, CallStats::Entry*);
+    ~AutoCallTimer();
+
+    AutoCallTimer(const AutoCallTimer&) = delete;
+    AutoCallTimer& operator=(const AutoCallTimer&) = delete;
+
+    void begin_native() {
+        if (m_entry)
+            m_native_begin = CallStats::Clock::now();
+    }
+    void end_native() {
+        if (m_entry)
+            m_native += CallStats::Clock::now() - m_native_begin;
+    }
+};
+
+/* Counts the time until it goes out of scope as time spent in the C function,
+ * for the innermost AutoCallTimer. For code that doesn't have the timer at
+ * hand. */
+class AutoNativeCallTimer {
+    AutoCallTimer* m_timer = nullptr;
+
+ public:
+    explicit AutoNativeCallTimer(JSContext*);
+    ~AutoNativeCallTimer() {
+        if (m_timer)
+            m_timer->end_native();
+    }
+
+    AutoNativeCallTimer(const AutoNativeCallTimer&) = delete;
+    AutoNativeCallTimer& operator=(const AutoNativeCallTimer&) = delete;
+};
+
+}  // namespace Gjs
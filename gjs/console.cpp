@@ -22,12 +22,15 @@
 #include "gjs/auto.h"
 #include "gjs/gerror-result.h"
 #include "gjs/gjs.h"
+#include "libgjs-private/gjs-util.h"
 #include "util/console.h"
 
 static Gjs::AutoStrv include_path;
 static Gjs::AutoStrv coverage_prefixes;
 static Gjs::AutoChar coverage_output_path;
 static Gjs::AutoChar profile_output_path;
+static Gjs::AutoChar profile_format;
+static Gjs::AutoChar convert_profile_path;
 static Gjs::AutoChar command;
 static gboolean print_version = false;
 static gboolean print_js_version = false;
@@ -69,6 +72,15 @@ static GOptionEntry entries[] = {
      G_OPTION_ARG_CALLBACK, reinterpret_cast<void*>(&parse_profile_arg),
      "Enable the profiler and write output to FILE (default: gjs-$PID.syscap)",
      "FILE"},
+    {"profile-format", 0, 0, G_OPTION_ARG_STRING, profile_format.out(),
+     "Write the profiler output in FORMAT, 'sysprof' (default) or 'gecko' for "
+     "the Firefox Profiler",
+     "FORMAT"},
+    {"convert-profile", 0, 0, G_OPTION_ARG_FILENAME, convert_profile_path.out(),
+     "Convert the profiler capture CAPTURE to the format given with "
+     "--profile-format (default: gecko) and exit. The output goes to the file "
+     "given with --profile, or CAPTURE with a .json extension",
+     "CAPTURE"},
     {"debugger", 'd', 0, G_OPTION_ARG_NONE, &debugging, "Start in debug mode"},
     {nullptr}};
 
@@ -237,6 +249,10 @@ int main(int argc, char** argv) {
 
     setlocale(LC_ALL, "");
 
+    // This program doesn't install a log writer function except through
+    // GLib.log_set_writer_func(), which GJS keeps track of
+    gjs_log_writer_assume_default();
+
     GjsAutoGOptionContext context = g_option_context_new(nullptr);
     g_option_context_set_ignore_unknown_options(context, true);
     g_option_context_set_help_enabled(context, false);
@@ -298,6 +314,25 @@ int main(int argc, char** argv) {
         return EXIT_SUCCESS;
     }
 
+    if (convert_profile_path) {
+        Gjs::AutoChar output_path;
+        if (profile_output_path) {
+            output_path = g_strdup(profile_output_path);
+        } else {
+            int n_chars = strlen(convert_profile_path);
+            if (g_str_has_suffix(convert_profile_path, ".syscap"))
+                n_chars -= strlen(".syscap");
+            output_path = g_strdup_printf("%.*s.json", n_chars,
+                                          convert_profile_path.get());
+        }
+
+        const char* format = profile_format ? profile_format.get() : "gecko";
+        if (!gjs_profiler_convert_capture(convert_profile_path, output_path,
+                                          format))
+            return EXIT_FAILURE;
+        return EXIT_SUCCESS;
+    }
+
     Gjs::AutoChar program_path;
     gjs_argc = g_strv_length(gjs_argv);
     Gjs::AutoChar script;
@@ -408,6 +443,14 @@ int main(int argc, char** argv) {
         gjs_profiler_set_fd(profiler, tracefd.release());
     }
 
+    if (enable_profiler && profile_format) {
+        GjsProfiler* profiler = gjs_context_get_profiler(gjs_context);
+        if (!gjs_profiler_set_output_format(profiler, profile_format)) {
+            g_printerr("Unknown profile format '%s'\n", profile_format.get());
+            return EXIT_FAILURE;
+        }
+    }
+
     tracefd.close();
 
     /* If we're debugging, set up the debugger. It will break on the first
@@ -11,6 +11,7 @@
 
 #include <atomic>
 #include <functional>  // for hash
+#include <memory>      // for unique_ptr
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -38,13 +39,22 @@
 #include <jsfriendapi.h>  // for ScriptEnvironmentPreparer
 
 #include "gi/closure.h"
+#include "gi/variant.h"
 #include "gjs/auto.h"
+#include "gjs/buffered-output.h"
+#include "gjs/call-stats.h"
 #include "gjs/context.h"
+#include "gjs/cross-thread-queue.h"
+#include "gjs/directory-cache.h"
+#include "gjs/event-loop-monitor.h"
 #include "gjs/gerror-result.h"
+#include "gjs/import-timing.h"
 #include "gjs/jsapi-util-root.h"
 #include "gjs/mainloop.h"
 #include "gjs/profiler.h"
 #include "gjs/promise.h"
+#include "gjs/resolution-cache.h"
+#include "gjs/signal-stats.h"
 
 class GjsAtoms;
 class JSTracer;
@@ -105,6 +115,28 @@ class GjsContextPrivate : public JS::JobQueue {
 
     GjsProfiler* m_profiler;
 
+    // Only present if GJS_FORWARD_THREAD_CALLBACKS is set
+    std::unique_ptr<Gjs::CrossThreadQueue> m_cross_thread_queue;
+
+    Gjs::ResolutionCache m_resolution_cache;
+    Gjs::DirectoryCache m_directory_cache;
+    Gjs::VariantSignatureCache m_variant_signatures;
+
+    // Only present if GJS_IMPORT_TIMINGS is set
+    std::unique_ptr<Gjs::ImportTimings> m_import_timings;
+
+    // Only present if GJS_CALL_STATS is set
+    std::unique_ptr<Gjs::CallStats> m_call_stats;
+
+    // Only present if GJS_BUFFERED_OUTPUT is set
+    std::unique_ptr<Gjs::BufferedOutput> m_buffered_output;
+
+    // Created on demand by System.startEventLoopMonitor()
+    std::unique_ptr<Gjs::EventLoopMonitor> m_event_loop_monitor;
+
+    // Created on demand by System.startSignalStats(), or with the profiler
+    std::unique_ptr<Gjs::SignalStats> m_signal_stats;
+
     /* Environment preparer needed for debugger, taken from SpiderMonkey's JS
      * shell */
     struct EnvironmentPreparer final : protected js::ScriptEnvironmentPreparer {
@@ -201,6 +233,40 @@ class GjsContextPrivate : public JS::JobQueue {
     void main_loop_hold() { m_main_loop.hold(); }
     void main_loop_release() { m_main_loop.release(); }
     [[nodiscard]] GjsProfiler* profiler() const { return m_profiler; }
+    [[nodiscard]]
+    Gjs::CrossThreadQueue* cross_thread_queue() const {
+        return m_cross_thread_queue.get();
+    }
+    [[nodiscard]]
+    Gjs::ResolutionCache& resolution_cache() { return m_resolution_cache; }
+    [[nodiscard]]
+    Gjs::DirectoryCache& directory_cache() { return m_directory_cache; }
+    [[nodiscard]]
+    Gjs::VariantSignatureCache& variant_signatures() {
+        return m_variant_signatures;
+    }
+    [[nodiscard]]
+    Gjs::ImportTimings* import_timings() const {
+        return m_import_timings.get();
+    }
+    [[nodiscard]]
+    Gjs::CallStats* call_stats() const { return m_call_stats.get(); }
+    [[nodiscard]]
+    Gjs::BufferedOutput* buffered_output() const {
+        return m_buffered_output.get();
+    }
+    [[nodiscard]]
+    Gjs::EventLoopMonitor* event_loop_monitor(bool create = false) {
+        if (!m_event_loop_monitor && create)
+            m_event_loop_monitor = std::make_unique<Gjs::EventLoopMonitor>();
+        return m_event_loop_monitor.get();
+    }
+    [[nodiscard]]
+    Gjs::SignalStats* signal_stats(bool create = false) {
+        if (!m_signal_stats && create)
+            m_signal_stats = std::make_unique<Gjs::SignalStats>(m_profiler);
+        return m_signal_stats.get();
+    }
     [[nodiscard]] const GjsAtoms& atoms() const { return *m_atoms; }
     [[nodiscard]] bool destroying() const { return m_destroying.load(); }
     [[nodiscard]] const char* program_name() const { return m_program_name; }
@@ -211,7 +277,10 @@ class GjsContextPrivate : public JS::JobQueue {
         return m_repl_history_path;
     }
     void set_program_path(char* value) { m_program_path = value; }
-    void set_search_path(char** value) { m_search_path = value; }
+    void set_search_path(char** value) {
+        m_search_path = value;
+        m_resolution_cache.clear();
+    }
     void set_should_profile(bool value) { m_should_profile = value; }
     void set_execute_as_module(bool value) { m_exec_as_module = value; }
     void set_should_listen_sigusr2(bool value) {
@@ -281,6 +350,7 @@ class GjsContextPrivate : public JS::JobQueue {
                            JS::HandleObject incumbent_global) override;
     void runJobs(JSContext*) override;
     [[nodiscard]] bool empty() const override { return m_job_queue.empty(); }
+    [[nodiscard]] size_t pending_jobs() const;
     [[nodiscard]]
     bool isDrainingStopped() const override {
         return !m_draining_job_queue;
@@ -24,8 +24,10 @@
 #    include <readline/history.h>
 #endif
 
+#include <chrono>
 #include <new>
 #include <iterator>     // for size
+#include <memory>       // for make_unique
 #include <string>       // for u16string
 #include <thread>       // for get_id
 #include <unordered_map>
@@ -73,19 +75,24 @@
 #include <mozilla/UniquePtr.h>  // for UniquePtr::get
 
 #include "gi/function.h"
+#include "gi/gjs_gi_trace.h"
 #include "gi/info.h"
 #include "gi/object.h"
 #include "gi/private.h"
 #include "gi/repo.h"
 #include "gjs/atoms.h"
 #include "gjs/auto.h"
+#include "gjs/buffered-output.h"
 #include "gjs/byteArray.h"
 #include "gjs/context-private.h"  // IWYU pragma: associated
 #include "gjs/context.h"
+#include "gjs/cross-thread-queue.h"
+#include "gjs/dbus.h"
 #include "gjs/engine.h"
 #include "gjs/error-types.h"
 #include "gjs/gerror-result.h"
 #include "gjs/global.h"
+#include "gjs/import-timing.h"
 #include "gjs/importer.h"
 #include "gjs/internal.h"
 #include "gjs/jsapi-util.h"
@@ -333,6 +340,7 @@ static void gjs_context_class_init(GjsContextClass* klass) {
     registry.add("_promiseNative", gjs_define_native_promise_stuff);
     registry.add("_byteArrayNative", gjs_define_byte_array_stuff);
     registry.add("_encodingNative", gjs_define_text_encoding_stuff);
+    registry.add("_dbusNative", gjs_define_dbus_stuff);
     registry.add("_gi", gjs_define_private_gi_stuff);
     registry.add("gi", gjs_define_repo);
     registry.add("cairoNative", gjs_js_define_cairo_stuff);
@@ -398,6 +406,8 @@ static void gjs_context_dispose(GObject* object) {
 
 void GjsContextPrivate::free_profiler() {
     gjs_debug(GJS_DEBUG_CONTEXT, "Stopping profiler");
+    // Signal statistics write to the profiler's counters
+    m_signal_stats.reset();
     if (m_profiler)
         g_clear_pointer(&m_profiler, gjs_profiler_free);
 }
@@ -417,6 +427,21 @@ void GjsContextPrivate::dispose() {
     if (m_cx) {
         stop_draining_job_queue();
 
+        // Signal emissions and callbacks from other threads must not reach JS
+        // from here on
+        if (m_cross_thread_queue) {
+            gjs_debug(GJS_DEBUG_CONTEXT, "Shutting down cross-thread queue");
+            m_cross_thread_queue->shutdown();
+        }
+
+        m_event_loop_monitor.reset();
+        m_buffered_output.reset();
+
+        if (m_import_timings)
+            m_import_timings->report();
+        if (m_call_stats)
+            m_call_stats->report();
+
         gjs_debug(GJS_DEBUG_CONTEXT,
                   "Notifying reference holders of GjsContext dispose");
 
@@ -665,9 +690,72 @@ GjsContextPrivate::GjsContextPrivate(JSContext* cx, GjsContext* public_context)
         } else {
             if (m_should_listen_sigusr2)
                 gjs_profiler_setup_signals(m_profiler, public_context);
+
+            // So that the profile shows which signals keep the program busy
+            signal_stats(/* create = */ true)->start();
+
+            if (const char* interval = g_getenv("GJS_PROFILER_INTERVAL")) {
+                uint64_t us = g_ascii_strtoull(interval, nullptr, 10);
+                if (us > 0) {
+                    gjs_profiler_set_sampling_period(
+                        m_profiler, std::chrono::microseconds{us});
+                }
+            }
+
+            if (const char* allocs = g_getenv("GJS_PROFILER_ALLOCATIONS")) {
+                char* end;
+                double probability = g_ascii_strtod(allocs, &end);
+                bool valid = end != allocs && *end == '\0';
+                if (valid && probability > 0 && probability <= 1) {
+                    gjs_profiler_set_allocation_sampling(m_profiler,
+                                                         probability);
+                } else if (!valid || probability != 0) {
+                    // 0 leaves allocation sampling off, as if unset
+                    g_warning("GJS_PROFILER_ALLOCATIONS must be greater than "
+                              "0 and at most 1, not %s",
+                              allocs);
+                }
+            }
+
+            if (const char* rotate = g_getenv("GJS_PROFILER_ROTATE")) {
+                uint64_t seconds = g_ascii_strtoull(rotate, nullptr, 10);
+                const char* keep = g_getenv("GJS_PROFILER_KEEP");
+                if (seconds > 0) {
+                    gjs_profiler_set_rotation(
+                        m_profiler, std::chrono::seconds{seconds},
+                        keep ? g_ascii_strtoull(keep, nullptr, 10) : 0);
+                }
+            }
         }
     }
 
+    if (g_getenv("GJS_FORWARD_THREAD_CALLBACKS")) {
+        Gjs::AutoPointer<GMainContext, GMainContext, g_main_context_unref>
+            owner_context{g_main_context_ref_thread_default()};
+        m_cross_thread_queue =
+            std::make_unique<Gjs::CrossThreadQueue>(owner_context);
+    }
+
+    // Buffered output is written as UTF-8, so keep going through g_print() and
+    // its charset conversion if the locale uses another charset
+    const char* buffered_output = g_getenv("GJS_BUFFERED_OUTPUT");
+    if (buffered_output && !g_get_charset(nullptr)) {
+        gjs_debug(GJS_DEBUG_CONTEXT,
+                  "Not buffering output, the locale charset is not UTF-8");
+    } else if (buffered_output) {
+        uint64_t threshold = g_ascii_strtoull(buffered_output, nullptr, 10);
+        if (threshold == 0)
+            threshold = Gjs::BufferedOutput::DEFAULT_THRESHOLD;
+        m_buffered_output = std::make_unique<Gjs::BufferedOutput>(threshold);
+    }
+
+    // Must be set up before the internal global loads its modules
+    if (const char* import_timings = g_getenv("GJS_IMPORT_TIMINGS"))
+        m_import_timings = std::make_unique<Gjs::ImportTimings>(import_timings);
+
+    if (const char* call_stats = g_getenv("GJS_CALL_STATS"))
+        m_call_stats = std::make_unique<Gjs::CallStats>(call_stats);
+
     JSRuntime* rt = JS_GetRuntime(m_cx);
     m_fundamental_table = new JS::WeakCache<FundamentalTable>(rt);
     m_gtype_table = new JS::WeakCache<GTypeTable>(rt);
@@ -913,6 +1001,7 @@ void GjsContextPrivate::on_garbage_collection(JSGCStatus status,
             gjs_debug_lifecycle(GJS_DEBUG_CONTEXT,
                                 "Begin garbage collection because of %s",
                                 gjs_explain_gc_reason(reason));
+            TRACE(GJS_GC_BEGIN(gjs_explain_gc_reason(reason)));
 
             // We finalize any pending toggle refs before doing any garbage
             // collection, so that we can collect the JS wrapper objects, and in
@@ -925,6 +1014,7 @@ void GjsContextPrivate::on_garbage_collection(JSGCStatus status,
             break;
         case JSGC_END:
             gjs_debug_lifecycle(GJS_DEBUG_CONTEXT, "End garbage collection");
+            TRACE(GJS_GC_END(gjs_explain_gc_reason(reason)));
             break;
         default:
             g_assert_not_reached();
@@ -946,6 +1036,19 @@ bool GjsContextPrivate::should_exit(uint8_t* exit_code_p) const {
 void GjsContextPrivate::exit_immediately(uint8_t exit_code) {
     warn_about_unhandled_promise_rejections();
 
+    if (m_buffered_output)
+        m_buffered_output->flush();
+
+    if (m_import_timings)
+        m_import_timings->report();
+    if (m_call_stats)
+        m_call_stats->report();
+
+    // Finish the capture, so that it is complete, or converted to the output
+    // format that was asked for
+    if (m_profiler && gjs_profiler_is_running(m_profiler))
+        gjs_profiler_stop(m_profiler);
+
     ::exit(exit_code);
 }
 
@@ -1016,6 +1119,8 @@ bool GjsContextPrivate::run_jobs_fallible() {
         return true;
 
     m_draining_job_queue = true;  // Ignore reentrant calls
+    TRACE(GJS_PROMISE_QUEUE_DRAIN_START(m_job_queue.length()));
+    size_t n_jobs_run [[maybe_unused]] = 0;
 
     JS::RootedObject job(m_cx);
     JS::HandleValueArray args(JS::HandleValueArray::empty());
@@ -1049,6 +1154,7 @@ bool GjsContextPrivate::run_jobs_fallible() {
             continue;
 
         m_job_queue[ix] = nullptr;
+        n_jobs_run++;
         {
             JSAutoRealm ar(m_cx, job);
             gjs_debug(GJS_DEBUG_MAINLOOP, "handling job %zu, %s", ix,
@@ -1082,11 +1188,22 @@ bool GjsContextPrivate::run_jobs_fallible() {
 
     m_draining_job_queue = false;
     m_job_queue.clear();
+    TRACE(GJS_PROMISE_QUEUE_DRAIN_END(n_jobs_run));
     warn_about_unhandled_promise_rejections();
     JS::JobQueueIsEmpty(m_cx);
     return retval;
 }
 
+// While the queue is being drained, the jobs that already ran are null
+size_t GjsContextPrivate::pending_jobs() const {
+    size_t count = 0;
+    for (const JS::Heap<JSObject*>& job : m_job_queue) {
+        if (job)
+            count++;
+    }
+    return count;
+}
+
 bool GjsContextPrivate::run_finalization_registry_cleanup() {
     bool retval = true;
 
@@ -1526,7 +1643,12 @@ GErrorResult<> GjsContextPrivate::eval_module(const char* identifier,
         return Err(error.release());
     }
 
-    if (!JS::ModuleLink(m_cx, obj)) {
+    bool linked;
+    {
+        Gjs::AutoImportTimer timer{m_cx, Gjs::ImportPhase::LINK, identifier};
+        linked = JS::ModuleLink(m_cx, obj);
+    }
+    if (!linked) {
         gjs_log_exception(m_cx);
         Gjs::AutoError error;
         g_set_error(error.out(), GJS_ERROR, GJS_ERROR_FAILED,
@@ -1538,7 +1660,12 @@ GErrorResult<> GjsContextPrivate::eval_module(const char* identifier,
     }
 
     JS::RootedValue evaluation_promise(m_cx);
-    bool ok = JS::ModuleEvaluate(m_cx, obj, &evaluation_promise);
+    bool ok;
+    {
+        Gjs::AutoImportTimer timer{m_cx, Gjs::ImportPhase::EVALUATE,
+                                   identifier};
+        ok = JS::ModuleEvaluate(m_cx, obj, &evaluation_promise);
+    }
 
     if (ok) {
         GjsContextPrivate::from_cx(m_cx)->main_loop_hold();
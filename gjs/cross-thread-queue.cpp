@@ -0,0 +1,101 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <memory>   // for unique_ptr
+#include <utility>  // for move, swap
+#include <vector>
+
+#include <glib.h>
+
+#include "gjs/auto.h"
+#include "gjs/cross-thread-queue.h"
+#include "util/log.h"
+
+namespace Gjs {
+
+CrossThreadQueue::CrossThreadQueue(GMainContext* owner_context)
+    : m_main_context(g_main_context_ref(owner_context)), m_shutdown(false) {
+    g_mutex_init(&m_lock);
+}
+
+CrossThreadQueue::~CrossThreadQueue() {
+    g_assert(m_shutdown && "Queue must be shut down before destroying it");
+    g_mutex_clear(&m_lock);
+}
+
+gboolean CrossThreadQueue::idle_flush(void* data) {
+    static_cast<CrossThreadQueue*>(data)->flush();
+    return G_SOURCE_REMOVE;
+}
+
+bool CrossThreadQueue::enqueue(std::unique_ptr<Call> call) {
+    g_mutex_lock(&m_lock);
+
+    if (G_UNLIKELY(m_shutdown)) {
+        g_mutex_unlock(&m_lock);
+        gjs_debug(GJS_DEBUG_CONTEXT,
+                  "Dropping call from thread %p enqueued after shutdown",
+                  g_thread_self());
+        return false;
+    }
+
+    m_pending.push_back(std::move(call));
+
+    // Calls enqueued before the idle source has run are delivered together
+    if (!m_source) {
+        m_source = g_idle_source_new();
+        g_source_set_priority(m_source, G_PRIORITY_DEFAULT);
+        g_source_set_callback(m_source, idle_flush, this, nullptr);
+        g_source_set_static_name(m_source, "[gjs] Cross-thread calls");
+        g_source_attach(m_source, m_main_context);
+    }
+
+    g_mutex_unlock(&m_lock);
+    return true;
+}
+
+void CrossThreadQueue::flush() {
+    std::vector<std::unique_ptr<Call>> batch;
+
+    g_mutex_lock(&m_lock);
+    std::swap(batch, m_pending);
+    if (m_source) {
+        g_source_destroy(m_source);
+        g_source_unref(m_source);
+        m_source = nullptr;
+    }
+    g_mutex_unlock(&m_lock);
+
+    gjs_debug(GJS_DEBUG_CONTEXT, "Delivering %zu cross-thread calls",
+              batch.size());
+
+    // Run without holding the lock; handlers may well cause other threads to
+    // enqueue more calls, which will go into the next batch
+    for (std::unique_ptr<Call>& call : batch)
+        call->run();
+}
+
+void CrossThreadQueue::shutdown() {
+    std::vector<std::unique_ptr<Call>> dropped;
+
+    g_mutex_lock(&m_lock);
+    m_shutdown = true;
+    std::swap(dropped, m_pending);
+    if (m_source) {
+        g_source_destroy(m_source);
+        g_source_unref(m_source);
+        m_source = nullptr;
+    }
+    g_mutex_unlock(&m_lock);
+
+    if (!dropped.empty()) {
+        gjs_debug(GJS_DEBUG_CONTEXT,
+                  "Dropping %zu undelivered cross-thread calls on shutdown",
+                  dropped.size());
+    }
+}
+
+}  // namespace Gjs
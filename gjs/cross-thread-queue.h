@@ -0,0 +1,65 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <memory>  // for unique_ptr
+#include <vector>
+
+#include <glib.h>
+
+#include "gjs/auto.h"
+
+namespace Gjs {
+
+/* Thread-safe queue for signal emissions and async callbacks that are invoked
+ * on a thread other than the one owning the JSContext. Calls are captured on
+ * the calling thread (all arguments copied) and delivered in batches from an
+ * idle source on the owner thread's main context. Calls whose arguments can't
+ * be copied, such as plain pointers, are not queued.
+ *
+ * Only used if GJS_FORWARD_THREAD_CALLBACKS is set in the environment;
+ * otherwise such calls are blocked and a critical is logged. See
+ * Gjs::Closure::marshal() and GjsCallbackTrampoline::callback_closure(). */
+class CrossThreadQueue {
+ public:
+    struct Call {
+        virtual ~Call() = default;
+        // Always called on the owner thread
+        virtual void run() = 0;
+    };
+
+ private:
+    GMutex m_lock;
+    std::vector<std::unique_ptr<Call>> m_pending;
+    AutoPointer<GMainContext, GMainContext, g_main_context_unref>
+        m_main_context;
+    GSource* m_source = nullptr;
+    bool m_shutdown : 1;
+
+    static gboolean idle_flush(void* data);
+
+ public:
+    explicit CrossThreadQueue(GMainContext* owner_context);
+    ~CrossThreadQueue();
+
+    CrossThreadQueue(const CrossThreadQueue&) = delete;
+    CrossThreadQueue& operator=(const CrossThreadQueue&) = delete;
+
+    /* May be called from any thread. Returns false (and destroys the call) if
+     * the queue has already been shut down. */
+    bool enqueue(std::unique_ptr<Call>);
+
+    // Runs all calls queued so far. Only call this on the owner thread.
+    void flush();
+
+    /* After calling this, the queue won't accept any more calls and any
+     * pending ones are dropped without being run. Only intended for use when
+     * destroying the JSContext. */
+    void shutdown();
+};
+
+}  // namespace Gjs
@@ -0,0 +1,1280 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+#include <string.h>  // for strchr, strlen
+
+#include <memory>  // for shared_ptr, unique_ptr
+#include <string>
+#include <unordered_map>
+#include <utility>  // for move
+
+#include <gio/gio.h>
+#include <glib-object.h>
+#include <glib.h>
+
+#include <js/Array.h>  // for NewArrayObject, IsArrayObject
+#include <js/CallAndConstruct.h>
+#include <js/CallArgs.h>
+#include <js/CharacterEncoding.h>  // for JS_EncodeStringToUTF8
+#include <js/Class.h>
+#include <js/Conversions.h>
+#include <js/Exception.h>
+#include <js/GCVector.h>  // for RootedValueVector
+#include <js/GlobalObject.h>  // for CurrentGlobalOrNull
+#include <js/Id.h>
+#include <js/Object.h>  // for GetMaybePtrFromReservedSlot, SetReservedSlot
+#include <js/Promise.h>
+#include <js/PropertyAndElement.h>  // for JS_DefineFunctions
+#include <js/PropertySpec.h>
+#include <js/Realm.h>
+#include <js/RootingAPI.h>
+#include <js/Stack.h>  // for BuildStackString, CaptureCurrentStack
+#include <js/String.h>
+#include <js/TracingAPI.h>
+#include <js/TypeDecls.h>
+#include <js/Utility.h>  // for UniqueChars
+#include <js/Value.h>
+#include <js/ValueArray.h>
+#include <jsapi.h>        // for InformalValueTypeName, JS_NewPlainObject
+#include <jsfriendapi.h>  // for NewFunctionWithReserved, ...
+#include <mozilla/Maybe.h>
+
+#include "gi/gerror.h"
+#include "gi/object.h"
+#include "gi/struct.h"
+#include "gi/variant.h"
+#include "gi/wrapperutils.h"
+#include "gjs/auto.h"
+#include "gjs/context-private.h"
+#include "gjs/dbus.h"
+#include "gjs/jsapi-util-args.h"
+#include "gjs/jsapi-util.h"
+#include "gjs/macros.h"
+#include "util/log.h"
+
+using mozilla::Maybe;
+
+enum class ProxyCall {
+    REMOTE,  // fooRemote(...args, [replyFunc]): calls replyFunc with the reply
+    SYNC,    // fooSync(...args): blocks and returns the reply
+    ASYNC,   // fooAsync(...args): returns a promise for the reply
+};
+
+// A method of a D-Bus interface, whose in arguments are packed according to a
+// signature parsed once, when a proxy for the interface is created
+struct ProxyMethod {
+    std::string name;
+    Gjs::VariantSignature in_signature;
+
+    [[nodiscard]] size_t n_in_args() const {
+        return in_signature.children.size();
+    }
+};
+
+static void proxy_method_finalize(JS::GCContext*, JSObject* obj) {
+    delete JS::GetMaybePtrFromReservedSlot<ProxyMethod>(obj, 0);
+}
+
+static constexpr JSClassOps proxy_method_class_ops = {
+    nullptr,  // addProperty
+    nullptr,  // deleteProperty
+    nullptr,  // enumerate
+    nullptr,  // newEnumerate
+    nullptr,  // resolve
+    nullptr,  // mayResolve
+    &proxy_method_finalize,
+};
+
+static constexpr JSClass proxy_method_class = {
+    "GjsDBusProxyMethod",
+    JSCLASS_HAS_RESERVED_SLOTS(1) | JSCLASS_BACKGROUND_FINALIZE,
+    &proxy_method_class_ops,
+};
+
+[[nodiscard]]
+static const ProxyMethod* proxy_method_from_callee(const JS::CallArgs& args) {
+    JS::Value data = js::GetFunctionNativeReserved(&args.callee(), 0);
+    g_assert(data.isObject() && "Wrong private value");
+    return JS::GetMaybePtrFromReservedSlot<ProxyMethod>(&data.toObject(), 0);
+}
+
+struct ProxyCallArgs {
+    GDBusProxy* proxy = nullptr;
+    Gjs::AutoGVariant parameters;
+    GDBusCallFlags flags = G_DBUS_CALL_FLAGS_NONE;
+    GCancellable* cancellable = nullptr;
+    GUnixFDList* fd_list = nullptr;
+    JS::RootedObject reply_func;
+
+    explicit ProxyCallArgs(JSContext* cx) : reply_func(cx) {}
+};
+
+// Checks the arguments of a proxy method call in the same way as the old JS
+// invoker did, and packs the in arguments into a tuple
+template <ProxyCall MODE>
+GJS_JSAPI_RETURN_CONVENTION static bool prepare_call(JSContext* cx,
+                                                     const ProxyMethod& method,
+                                                     const JS::CallArgs& args,
+                                                     ProxyCallArgs* call) {
+    JS::RootedObject self{cx};
+    if (!args.computeThis(cx, &self) ||
+        !ObjectBase::typecheck(cx, self, G_TYPE_DBUS_PROXY))
+        return false;
+
+    GObject* proxy;
+    if (!ObjectBase::to_c_ptr(cx, self, &proxy))
+        return false;
+    if (!proxy) {
+        gjs_throw(cx, "Cannot call method %s on a proxy that was disposed",
+                  method.name.c_str());
+        return false;
+    }
+    call->proxy = G_DBUS_PROXY(proxy);
+
+    size_t n_in_args = method.n_in_args();
+    size_t max_args = n_in_args + 4;
+    if (args.length() < n_in_args) {
+        gjs_throw(cx,
+                  "Not enough arguments passed for method: %s. Expected %zu, "
+                  "got %u",
+                  method.name.c_str(), n_in_args, args.length());
+        return false;
+    }
+    if (args.length() > max_args) {
+        gjs_throw(cx,
+                  "Too many arguments passed for method %s. Maximum is %zu "
+                  "including one callback, Gio.Cancellable, Gio.UnixFDList, "
+                  "and/or flags",
+                  method.name.c_str(), max_args);
+        return false;
+    }
+
+    // GioUnix is not a dependency, so look the type up at runtime
+    GType fd_list_type = g_type_from_name("GUnixFDList");
+
+    // If an argument type occurs more than once, the first one wins, since
+    // the old JS invoker processed them from the end
+    JS::RootedObject obj{cx};
+    for (unsigned ix = args.length(); ix-- > n_in_args;) {
+        JS::HandleValue arg = args[ix];
+
+        if (arg.isNumber()) {
+            uint32_t flags;
+            if (!JS::ToUint32(cx, arg, &flags))
+                return false;
+            call->flags = GDBusCallFlags(flags);
+            continue;
+        }
+
+        if (arg.isObject()) {
+            obj = &arg.toObject();
+            if (MODE == ProxyCall::REMOTE && JS::IsCallable(obj)) {
+                call->reply_func = obj;
+                continue;
+            }
+
+            GObject* gobj;
+            if (ObjectBase::typecheck(cx, obj, G_TYPE_CANCELLABLE,
+                                      GjsTypecheckNoThrow{})) {
+                if (!ObjectBase::to_c_ptr(cx, obj, &gobj))
+                    return false;
+                call->cancellable = G_CANCELLABLE(gobj);
+                continue;
+            }
+            if (fd_list_type != G_TYPE_INVALID &&
+                ObjectBase::typecheck(cx, obj, fd_list_type,
+                                      GjsTypecheckNoThrow{})) {
+                if (!ObjectBase::to_c_ptr(cx, obj, &gobj))
+                    return false;
+                call->fd_list = reinterpret_cast<GUnixFDList*>(gobj);
+                continue;
+            }
+        }
+
+        gjs_throw(cx,
+                  "Argument %u of method %s is %s. It should be a callback, "
+                  "flags, Gio.UnixFDList, or a Gio.Cancellable",
+                  ix, method.name.c_str(), JS::InformalValueTypeName(arg));
+        return false;
+    }
+
+    GVariant* parameters = gjs_variant_pack_tuple(
+        cx, method.in_signature,
+        JS::HandleValueArray::subarray(args, 0, n_in_args));
+    if (!parameters)
+        return false;
+    call->parameters = g_variant_ref_sink(parameters);
+    return true;
+}
+
+// Deep-unpacks the out arguments of a reply into an array, and wraps the
+// returned Gio.UnixFDList, if any
+GJS_JSAPI_RETURN_CONVENTION
+static bool unpack_reply(JSContext* cx, GVariant* reply, GUnixFDList* fd_list,
+                         JS::MutableHandleValue value_p,
+                         JS::MutableHandleValue fd_list_p) {
+    if (!gjs_variant_unpack(cx, reply, GjsVariantUnpack::DEEP, value_p))
+        return false;
+
+    if (!fd_list) {
+        fd_list_p.setNull();
+        return true;
+    }
+
+    JSObject* wrapper =
+        ObjectInstance::wrapper_from_gobject(cx, G_OBJECT(fd_list));
+    if (!wrapper)
+        return false;
+    fd_list_p.setObject(*wrapper);
+    return true;
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool finish_call(JSContext* cx, GObject* proxy, GAsyncResult* result,
+                        JS::MutableHandleValue value_p,
+                        JS::MutableHandleValue fd_list_p) {
+    Gjs::AutoUnref<GUnixFDList> out_fd_list;
+    Gjs::AutoError error;
+    Gjs::AutoGVariant reply{g_dbus_proxy_call_with_unix_fd_list_finish(
+        G_DBUS_PROXY(proxy), out_fd_list.out(), result, &error)};
+    if (!reply)
+        return gjs_throw_gerror(cx, error);
+
+    return unpack_reply(cx, reply, out_fd_list, value_p, fd_list_p);
+}
+
+// Returns [value, fdList], the form in which the reply is returned if there
+// are file descriptors involved
+GJS_JSAPI_RETURN_CONVENTION
+static bool pair_with_fd_list(JSContext* cx, JS::MutableHandleValue value_p,
+                              JS::HandleValue fd_list) {
+    JS::RootedValueArray<2> elems{cx};
+    elems[0].set(value_p);
+    elems[1].set(fd_list);
+    JSObject* array = JS::NewArrayObject(cx, elems);
+    if (!array)
+        return false;
+    value_p.setObject(*array);
+    return true;
+}
+
+// Takes the pending exception, which has nowhere else to go because we are
+// called from the main loop. Uncatchable exceptions are fatal, as in closures.
+static void steal_pending_exception(JSContext* cx,
+                                    JS::MutableHandleValue exception) {
+    if (JS_GetPendingException(cx, exception)) {
+        JS_ClearPendingException(cx);
+        return;
+    }
+
+    uint8_t code;
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    if (gjs->should_exit(&code))
+        gjs->exit_immediately(code);
+    g_error("D-Bus method reply terminated with uncatchable exception");
+}
+
+// State of a fooRemote() or fooAsync() call, while waiting for the reply. The
+// main loop is held until then. The call has its own cancellable, which follows
+// the caller's, so that it can be cancelled if the GjsContext is disposed
+// first; the call is then abandoned: cx is cleared and the JS values unrooted.
+struct PendingCall {
+    JSContext* cx;
+    JS::PersistentRootedObject global;
+    // The reply function (or null) for fooRemote(), the promise for fooAsync()
+    JS::PersistentRootedObject callback;
+    Gjs::AutoUnref<GCancellable> cancellable;
+    Gjs::AutoUnref<GCancellable> caller_cancellable;
+    unsigned long caller_cancelled_id = 0;
+
+    PendingCall(JSContext* cx_, JS::HandleObject callback_,
+                GCancellable* caller_cancellable_)
+        : cx(cx_),
+          global(cx_, JS::CurrentGlobalOrNull(cx_)),
+          callback(cx_, callback_),
+          cancellable(g_cancellable_new()),
+          caller_cancellable(caller_cancellable_, Gjs::TakeOwnership{}) {
+        if (caller_cancellable) {
+            caller_cancelled_id = g_cancellable_connect(
+                caller_cancellable, G_CALLBACK(+[](GCancellable*, void* data) {
+                    g_cancellable_cancel(G_CANCELLABLE(data));
+                }),
+                g_object_ref(cancellable), g_object_unref);
+        }
+
+        GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+        gjs->main_loop_hold();
+        gjs->register_notifier(&PendingCall::on_context_destroyed, this);
+    }
+
+    ~PendingCall() {
+        if (caller_cancellable)
+            g_cancellable_disconnect(caller_cancellable, caller_cancelled_id);
+    }
+
+    static void on_context_destroyed(JSContext*, void* data) {
+        auto* call = static_cast<PendingCall*>(data);
+
+        // Don't unregister the notifier here, the notifiers are being iterated
+        GjsContextPrivate::from_cx(call->cx)->main_loop_release();
+        call->global.reset();
+        call->callback.reset();
+        call->cx = nullptr;
+        g_cancellable_cancel(call->cancellable);
+    }
+
+    // Returns false if the call was abandoned, and the reply must be ignored
+    [[nodiscard]] bool finish() {
+        if (!cx)
+            return false;
+
+        GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+        gjs->unregister_notifier(&PendingCall::on_context_destroyed, this);
+        gjs->main_loop_release();
+        return !gjs->destroying();
+    }
+};
+
+// Calls the reply function of fooRemote(). The default one only logs errors.
+GJS_JSAPI_RETURN_CONVENTION
+static bool call_reply_func(JSContext* cx, JS::HandleObject reply_func,
+                            const JS::HandleValueArray& reply_args) {
+    if (reply_func) {
+        JS::RootedValue ignored_rval{cx};
+        return JS::Call(cx, JS::UndefinedHandleValue, reply_func, reply_args,
+                        &ignored_rval);
+    }
+
+    if (reply_args[1].isNull())
+        return true;
+
+    // As in log(), the error might not be convertible to a string
+    JS::AutoSaveExceptionState exc_state{cx};
+    JS::RootedString str{cx, JS::ToString(cx, reply_args[1])};
+    JS::UniqueChars message;
+    if (str)
+        message = JS_EncodeStringToUTF8(cx, str);
+    exc_state.restore();
+
+    g_message("JS LOG: Ignored exception from dbus method: %s",
+              message ? message.get() : "<cannot convert value to string>");
+    return true;
+}
+
+static void on_remote_call_done(GObject* proxy, GAsyncResult* result,
+                                void* data) {
+    std::unique_ptr<PendingCall> call{static_cast<PendingCall*>(data)};
+    if (!call->finish())
+        return;
+
+    JSContext* cx = call->cx;
+    JSAutoRealm ar{cx, call->global};
+
+    JS::RootedValueArray<3> reply_args{cx};
+    if (finish_call(cx, proxy, result, reply_args[0], reply_args[2]) &&
+        call_reply_func(cx, call->callback, reply_args))
+        return;
+
+    // As before, an exception from the reply function is also passed to it
+    steal_pending_exception(cx, reply_args[1]);
+    JSObject* no_result = JS::NewArrayObject(cx, 0);
+    if (!no_result) {
+        gjs_log_exception_uncaught(cx);
+        return;
+    }
+    reply_args[0].setObject(*no_result);
+    reply_args[2].setNull();
+
+    if (!call_reply_func(cx, call->callback, reply_args)) {
+        JS::RootedValue exception{cx};
+        steal_pending_exception(cx, &exception);
+        gjs_log_exception_full(cx, exception, nullptr, G_LOG_LEVEL_CRITICAL);
+    }
+}
+
+static void on_async_call_done(GObject* proxy, GAsyncResult* result,
+                               void* data) {
+    std::unique_ptr<PendingCall> call{static_cast<PendingCall*>(data)};
+    if (!call->finish())
+        return;
+
+    JSContext* cx = call->cx;
+    JSAutoRealm ar{cx, call->global};
+
+    JS::RootedValue value{cx}, fd_list{cx};
+    if (finish_call(cx, proxy, result, &value, &fd_list) &&
+        (fd_list.isNull() || pair_with_fd_list(cx, &value, fd_list))) {
+        if (!JS::ResolvePromise(cx, call->callback, value))
+            gjs_log_exception(cx);
+        return;
+    }
+
+    JS::RootedValue exception{cx};
+    steal_pending_exception(cx, &exception);
+    if (!JS::RejectPromise(cx, call->callback, exception))
+        gjs_log_exception(cx);
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool proxy_call_remote(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    const ProxyMethod* method = proxy_method_from_callee(args);
+
+    ProxyCallArgs call{cx};
+    if (!prepare_call<ProxyCall::REMOTE>(cx, *method, args, &call))
+        return false;
+
+    auto* pending = new PendingCall{cx, call.reply_func, call.cancellable};
+    g_dbus_proxy_call_with_unix_fd_list(
+        call.proxy, method->name.c_str(), call.parameters, call.flags, -1,
+        call.fd_list, pending->cancellable, on_remote_call_done, pending);
+
+    args.rval().setUndefined();
+    return true;
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool proxy_call_sync(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    const ProxyMethod* method = proxy_method_from_callee(args);
+
+    ProxyCallArgs call{cx};
+    if (!prepare_call<ProxyCall::SYNC>(cx, *method, args, &call))
+        return false;
+
+    Gjs::AutoUnref<GUnixFDList> out_fd_list;
+    Gjs::AutoError error;
+    Gjs::AutoGVariant reply{g_dbus_proxy_call_with_unix_fd_list_sync(
+        call.proxy, method->name.c_str(), call.parameters, call.flags, -1,
+        call.fd_list, out_fd_list.out(), call.cancellable, &error)};
+    if (!reply)
+        return gjs_throw_gerror(cx, error);
+
+    JS::RootedValue fd_list{cx};
+    if (!unpack_reply(cx, reply, out_fd_list, args.rval(), &fd_list))
+        return false;
+
+    // The file descriptors are returned if any were passed in
+    return !call.fd_list || pair_with_fd_list(cx, args.rval(), fd_list);
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool proxy_call_async(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    const ProxyMethod* method = proxy_method_from_callee(args);
+
+    ProxyCallArgs call{cx};
+    if (!prepare_call<ProxyCall::ASYNC>(cx, *method, args, &call)) {
+        // Invalid arguments reject the promise rather than throwing, as before
+        JS::RootedValue exception{cx};
+        if (!JS_GetPendingException(cx, &exception))
+            return false;
+        JS_ClearPendingException(cx);
+
+        JSObject* rejected = JS::CallOriginalPromiseReject(cx, exception);
+        if (!rejected)
+            return false;
+        args.rval().setObject(*rejected);
+        return true;
+    }
+
+    JS::RootedObject promise{cx, JS::NewPromiseObject(cx, nullptr)};
+    if (!promise)
+        return false;
+
+    auto* pending = new PendingCall{cx, promise, call.cancellable};
+    g_dbus_proxy_call_with_unix_fd_list(
+        call.proxy, method->name.c_str(), call.parameters, call.flags, -1,
+        call.fd_list, pending->cancellable, on_async_call_done, pending);
+
+    args.rval().setObject(*promise);
+    return true;
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static JSObject* new_proxy_method(JSContext* cx, JSNative native,
+                                  JS::HandleObject data, const char* name,
+                                  const char* suffix, unsigned nargs) {
+    std::string func_name{name};
+    func_name += suffix;
+
+    JSFunction* func =
+        js::NewFunctionWithReserved(cx, native, nargs, 0, func_name.c_str());
+    if (!func)
+        return nullptr;
+
+    JSObject* func_obj = JS_GetFunctionObject(func);
+    js::SetFunctionNativeReserved(func_obj, 0, JS::ObjectValue(*data));
+    return func_obj;
+}
+
+// makeProxyMethods(methodInfo): Returns the [fooRemote, fooSync, fooAsync]
+// methods for a Gio.DBusMethodInfo, to be installed on proxies, or null if the
+// method must be called through the JS invoker.
+GJS_JSAPI_RETURN_CONVENTION
+static bool make_proxy_methods(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject info_obj{cx};
+    if (!gjs_parse_call_args(cx, "makeProxyMethods", args, "o", "methodInfo",
+                             &info_obj))
+        return false;
+
+    if (!StructBase::typecheck(cx, info_obj, G_TYPE_DBUS_METHOD_INFO))
+        return false;
+    auto* info = StructBase::to_c_ptr<GDBusMethodInfo>(cx, info_obj);
+    if (!info)
+        return false;
+
+    size_t n_in_args = 0;
+    std::string in_type_string{"("};
+    for (GDBusArgInfo** arg = info->in_args; arg && *arg; arg++, n_in_args++)
+        in_type_string += (*arg)->signature;
+    in_type_string += ')';
+
+    // Handles must be validated against the Gio.UnixFDList, whose API is not
+    // available here
+    if (in_type_string.find('h') != std::string::npos) {
+        args.rval().setNull();
+        return true;
+    }
+
+    // The JS invoker reports bad signatures when the method is called, rather
+    // than when the proxy is created
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    std::shared_ptr<const Gjs::VariantSignature> in_signature =
+        gjs->variant_signatures().lookup(cx, in_type_string.c_str());
+    if (!in_signature || in_signature->children.size() != n_in_args) {
+        gjs_debug(GJS_DEBUG_NATIVE,
+                  "Not invoking method %s natively, signature %s is invalid",
+                  info->name, in_type_string.c_str());
+        JS_ClearPendingException(cx);
+        args.rval().setNull();
+        return true;
+    }
+
+    JS::RootedObject data{cx, JS_NewObject(cx, &proxy_method_class)};
+    if (!data)
+        return false;
+    JS::SetReservedSlot(data, 0,
+                        JS::PrivateValue(new ProxyMethod{
+                            info->name, *in_signature}));
+
+    JS::RootedValueArray<3> methods{cx};
+    JSObject* remote = new_proxy_method(cx, &proxy_call_remote, data,
+                                        info->name, "Remote", n_in_args);
+    if (!remote)
+        return false;
+    methods[0].setObject(*remote);
+
+    JSObject* sync = new_proxy_method(cx, &proxy_call_sync, data, info->name,
+                                      "Sync", n_in_args);
+    if (!sync)
+        return false;
+    methods[1].setObject(*sync);
+
+    JSObject* async = new_proxy_method(cx, &proxy_call_async, data,
+                                       info->name, "Async", n_in_args);
+    if (!async)
+        return false;
+    methods[2].setObject(*async);
+
+    JSObject* array = JS::NewArrayObject(cx, methods);
+    if (!array)
+        return false;
+    args.rval().setObject(*array);
+    return true;
+}
+
+// A method of an exported D-Bus object, whose reply is packed according to an
+// out signature parsed once, when the object is wrapped
+struct ExportedMethod {
+    JS::Heap<jsid> id;        // The implementation is this[name], or...
+    JS::Heap<jsid> async_id;  // ...this[`${name}Async`]
+    std::string out_type_string;
+    Maybe<Gjs::VariantSignature> out_signature;
+    size_t n_out_args = 0;
+};
+
+using ExportedMethods = std::unordered_map<std::string, ExportedMethod>;
+
+// Reserved slots of the object holding the dispatch table of an exported
+// object, which is shared by the native functions that handle its calls
+enum ExportedObjectSlot : size_t {
+    EXPORTED_METHODS,
+    EXPORTED_JS_OBJECT,
+    // The WeakMap of invocations that were already returned, also used by the
+    // Gio.DBusMethodInvocation.return_*() overrides
+    EXPORTED_INVOCATIONS,
+    EXPORTED_N_SLOTS,
+};
+
+static void exported_object_finalize(JS::GCContext*, JSObject* obj) {
+    delete JS::GetMaybePtrFromReservedSlot<ExportedMethods>(obj,
+                                                            EXPORTED_METHODS);
+}
+
+static void exported_object_trace(JSTracer* trc, JSObject* obj) {
+    auto* methods =
+        JS::GetMaybePtrFromReservedSlot<ExportedMethods>(obj, EXPORTED_METHODS);
+    if (!methods)
+        return;
+
+    for (auto& entry : *methods) {
+        JS::TraceEdge(trc, &entry.second.id, "ExportedMethod::id");
+        JS::TraceEdge(trc, &entry.second.async_id, "ExportedMethod::async_id");
+    }
+}
+
+static constexpr JSClassOps exported_object_class_ops = {
+    nullptr,  // addProperty
+    nullptr,  // deleteProperty
+    nullptr,  // enumerate
+    nullptr,  // newEnumerate
+    nullptr,  // resolve
+    nullptr,  // mayResolve
+    &exported_object_finalize,
+    nullptr,  // call
+    nullptr,  // construct
+    &exported_object_trace,
+};
+
+static constexpr JSClass exported_object_class = {
+    "GjsDBusExportedObject",
+    JSCLASS_HAS_RESERVED_SLOTS(EXPORTED_N_SLOTS) | JSCLASS_FOREGROUND_FINALIZE,
+    &exported_object_class_ops,
+};
+
+// The state of one incoming method call, for the native functions that take
+// part in replying to it
+class MethodCall {
+    JSContext* m_cx;
+    JS::RootedObject m_data;
+    JS::RootedObject m_invocation_obj;
+    GDBusMethodInvocation* m_invocation = nullptr;
+    const char* m_name = nullptr;
+    const ExportedMethod* m_method = nullptr;
+
+ public:
+    explicit MethodCall(JSContext* cx)
+        : m_cx(cx), m_data(cx), m_invocation_obj(cx) {}
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool init(JSObject* data, JS::HandleValue invocation) {
+        m_data = data;
+
+        if (!invocation.isObject()) {
+            gjs_throw(m_cx, "Expected a Gio.DBusMethodInvocation");
+            return false;
+        }
+        m_invocation_obj = &invocation.toObject();
+
+        GObject* gobj;
+        if (!ObjectBase::typecheck(m_cx, m_invocation_obj,
+                                   G_TYPE_DBUS_METHOD_INVOCATION) ||
+            !ObjectBase::to_c_ptr(m_cx, m_invocation_obj, &gobj))
+            return false;
+        if (!gobj) {
+            gjs_throw(m_cx, "Method invocation was already disposed");
+            return false;
+        }
+        m_invocation = G_DBUS_METHOD_INVOCATION(gobj);
+        m_name = g_dbus_method_invocation_get_method_name(m_invocation);
+
+        auto* methods = JS::GetMaybePtrFromReservedSlot<ExportedMethods>(
+            m_data, EXPORTED_METHODS);
+        auto it = methods->find(m_name);
+        if (it != methods->end())
+            m_method = &it->second;
+        return true;
+    }
+
+    [[nodiscard]] const char* name() const { return m_name; }
+    [[nodiscard]] const ExportedMethod* method() const { return m_method; }
+    [[nodiscard]] GDBusMethodInvocation* invocation() const {
+        return m_invocation;
+    }
+    [[nodiscard]] JS::HandleObject invocation_obj() const {
+        return m_invocation_obj;
+    }
+    [[nodiscard]] JSObject* data() const { return m_data; }
+
+    [[nodiscard]] JSObject* js_object() const {
+        return &JS::GetReservedSlot(m_data, EXPORTED_JS_OBJECT).toObject();
+    }
+
+    [[nodiscard]] JSObject* invocations_map() const {
+        return &JS::GetReservedSlot(m_data, EXPORTED_INVOCATIONS).toObject();
+    }
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool was_returned(bool* returned) const {
+        JS::RootedObject invocations{m_cx, invocations_map()};
+        JS::RootedValue key{m_cx, JS::ObjectValue(*m_invocation_obj)};
+        JS::RootedValue entry{m_cx};
+        if (!JS::GetWeakMapEntry(m_cx, invocations, key, &entry))
+            return false;
+        *returned = !entry.isUndefined();
+        return true;
+    }
+
+    void log_exception(JS::HandleValue exc) const {
+        Gjs::AutoChar message{
+            g_strdup_printf("Exception in method call: %s", m_name)};
+        JS::RootedString message_str{m_cx, JS_NewStringCopyZ(m_cx, message)};
+        if (!message_str)
+            JS_ClearPendingException(m_cx);
+        gjs_log_exception_full(m_cx, exc, message_str, G_LOG_LEVEL_WARNING);
+    }
+
+    // Logs @message with the current stack, as logError(new Error(), message)
+    // does in the overrides
+    void log_error(const char* message) const {
+        JS::RootedValue exc{m_cx};
+        gjs_throw_literal(m_cx, "");
+        if (!JS_GetPendingException(m_cx, &exc))
+            return;
+        JS_ClearPendingException(m_cx);
+
+        JS::ConstUTF8CharsZ chars{message, strlen(message)};
+        JS::RootedString message_str{m_cx, JS_NewStringCopyUTF8Z(m_cx, chars)};
+        if (!message_str)
+            JS_ClearPendingException(m_cx);
+        gjs_log_exception_full(m_cx, exc, message_str, G_LOG_LEVEL_WARNING);
+    }
+
+    // Calls one of the g_dbus_method_invocation_return_*() functions with a
+    // new reference, unless the invocation was already returned, in the same
+    // way as the Gio.DBusMethodInvocation.return_*() overrides
+    template <typename F>
+    GJS_JSAPI_RETURN_CONVENTION bool return_with(F&& return_func) {
+        JS::RootedObject invocations{m_cx, invocations_map()};
+        JS::RootedValue key{m_cx, JS::ObjectValue(*m_invocation_obj)};
+        JS::RootedValue previous{m_cx};
+        if (!JS::GetWeakMapEntry(m_cx, invocations, key, &previous))
+            return false;
+
+        if (!previous.isUndefined()) {
+            // Not an exception, for compatibility, but point to both returns
+            JS::RootedObject previous_obj{m_cx, &previous.toObject()};
+            JS::RootedValue previous_stack{m_cx};
+            JS::UniqueChars invocation_str, stack_str;
+            if (JSString* str = JS::ToString(m_cx, key))
+                invocation_str = JS_EncodeStringToUTF8(m_cx, str);
+            if (!invocation_str ||
+                !JS_GetProperty(m_cx, previous_obj, "previousCallStack",
+                                &previous_stack))
+                return false;
+            if (JSString* str = JS::ToString(m_cx, previous_stack))
+                stack_str = JS_EncodeStringToUTF8(m_cx, str);
+            if (!stack_str)
+                return false;
+
+            // Skip the first line, as the overrides do
+            const char* stack = strchr(stack_str.get(), '\n');
+            Gjs::AutoChar message{g_strdup_printf(
+                "%s (%s) already returned @\n%s", invocation_str.get(), m_name,
+                stack ? stack + 1 : "")};
+            log_error(message);
+            return true;
+        }
+
+        // The overrides drop the first line of the call stack, which is their
+        // own frame, so start with an empty line instead
+        JS::RootedObject entry_obj{m_cx, JS_NewPlainObject(m_cx)};
+        JS::RootedValue name{m_cx};
+        JS::RootedObject frame{m_cx};
+        JS::RootedString stack{m_cx};
+        JS::RootedString first_line{m_cx, JS_NewStringCopyZ(m_cx, "\n")};
+        if (!entry_obj || !first_line ||
+            !gjs_string_from_utf8(m_cx, m_name, &name) ||
+            !JS::CaptureCurrentStack(m_cx, &frame) ||
+            !JS::BuildStackString(m_cx, nullptr, frame, &stack) ||
+            !(stack = JS_ConcatStrings(m_cx, first_line, stack)) ||
+            !JS_DefineProperty(m_cx, entry_obj, "methodName", name,
+                               JSPROP_ENUMERATE) ||
+            !JS_DefineProperty(m_cx, entry_obj, "previousCallStack", stack,
+                               JSPROP_ENUMERATE))
+            return false;
+        JS::RootedValue entry{m_cx, JS::ObjectValue(*entry_obj)};
+        if (!JS::SetWeakMapEntry(m_cx, invocations, key, entry))
+            return false;
+
+        return_func(
+            static_cast<GDBusMethodInvocation*>(g_object_ref(m_invocation)));
+        return true;
+    }
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool return_value(JS::HandleValue value);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool return_error(JS::HandleValue exc);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool maybe_return_error(JS::HandleValue exc);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool return_unknown_method() {
+        Gjs::AutoChar message{g_strdup_printf(
+            "Missing handler for DBus method %s: neither %s() nor %sAsync() is "
+            "implemented",
+            m_name, m_name, m_name)};
+        log_error(message);
+        return return_with([this](GDBusMethodInvocation* invocation) {
+            g_dbus_method_invocation_return_error(
+                invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+                "Method %s is not implemented", m_name);
+        });
+    }
+};
+
+// Packs the return value of the implementation according to the out signature.
+// A GLib.Variant is returned as is, undefined means no out arguments, and a
+// single out argument does not need to be wrapped in an array. Returns a full
+// reference to a GLib.Variant's GVariant, or a floating one to a new GVariant.
+GJS_JSAPI_RETURN_CONVENTION
+static GVariant* pack_reply(JSContext* cx, const char* method_name,
+                            const ExportedMethod* method,
+                            JS::HandleValue value, GUnixFDList** fd_list_out) {
+    *fd_list_out = nullptr;
+
+    if (value.isUndefined())
+        return g_variant_new_tuple(nullptr, 0);
+
+    JS::RootedObject obj{cx};
+    if (value.isObject()) {
+        obj = &value.toObject();
+        if (StructBase::typecheck(cx, obj, G_TYPE_VARIANT,
+                                  GjsTypecheckNoThrow{})) {
+            GVariant* variant = StructBase::to_c_ptr<GVariant>(cx, obj);
+            return variant ? g_variant_ref(variant) : nullptr;
+        }
+    }
+
+    if (!method) {
+        gjs_throw(cx, "No out signature for method %s", method_name);
+        return nullptr;
+    }
+
+    const Gjs::VariantSignature* signature =
+        method->out_signature.ptrOr(nullptr);
+    std::shared_ptr<const Gjs::VariantSignature> parsed;
+    if (!signature) {
+        // Throws the error from parsing the signature
+        GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+        parsed = gjs->variant_signatures().lookup(
+            cx, method->out_type_string.c_str());
+        if (!parsed)
+            return nullptr;
+        signature = parsed.get();
+    }
+
+    // A Gio.UnixFDList can follow the out arguments if there are handles
+    GType fd_list_type = g_type_from_name("GUnixFDList");
+    bool is_array = false;
+    if (obj && fd_list_type != G_TYPE_INVALID &&
+        method->out_type_string.find('h') != std::string::npos) {
+        uint32_t len;
+        JS::RootedValue last{cx};
+        if (!JS::IsArrayObject(cx, obj, &is_array))
+            return nullptr;
+        if (is_array && (!JS::GetArrayLength(cx, obj, &len) ||
+                         (len > 0 && !JS_GetElement(cx, obj, len - 1, &last))))
+            return nullptr;
+
+        if (is_array && last.isObject()) {
+            JS::RootedObject last_obj{cx, &last.toObject()};
+            GObject* gobj;
+            if (ObjectBase::typecheck(cx, last_obj, fd_list_type,
+                                      GjsTypecheckNoThrow{})) {
+                if (!ObjectBase::to_c_ptr(cx, last_obj, &gobj))
+                    return nullptr;
+                *fd_list_out = reinterpret_cast<GUnixFDList*>(gobj);
+                // The out arguments are the other elements, which are packed
+                // as a tuple that ignores the extra one
+                return gjs_variant_pack(cx, *signature, value);
+            }
+        }
+    }
+
+    if (method->n_out_args == 1)
+        return gjs_variant_pack_tuple(cx, *signature,
+                                      JS::HandleValueArray{value});
+
+    return gjs_variant_pack(cx, *signature, value);
+}
+
+bool MethodCall::return_value(JS::HandleValue value) {
+    GUnixFDList* fd_list;
+    GVariant* reply = pack_reply(m_cx, m_name, m_method, value, &fd_list);
+    if (!reply) {
+        JS::RootedValue exc{m_cx};
+        if (!JS_GetPendingException(m_cx, &exc))
+            return false;
+        JS_ClearPendingException(m_cx);
+        log_exception(exc);
+
+        // If we don't do this, the other side will never see a reply
+        return return_with([](GDBusMethodInvocation* invocation) {
+            g_dbus_method_invocation_return_dbus_error(
+                invocation, "org.gnome.gjs.JSError.ValueError",
+                "Service implementation returned an incorrect value type");
+        });
+    }
+
+    // Only sinks the floating reference of a reply that was packed here
+    Gjs::AutoGVariant sunk_reply{g_variant_take_ref(reply)};
+    return return_with(
+        [&sunk_reply, fd_list](GDBusMethodInvocation* invocation) {
+            g_dbus_method_invocation_return_value_with_unix_fd_list(
+                invocation, sunk_reply, fd_list);
+        });
+}
+
+// A GLib.Error is returned as is. Other errors are logged, and returned as a
+// D-Bus error named after the JS error, e.g. org.gnome.gjs.JSError.TypeError.
+bool MethodCall::return_error(JS::HandleValue exc) {
+    if (exc.isObject()) {
+        JS::RootedObject obj{m_cx, &exc.toObject()};
+        if (ErrorBase::typecheck(m_cx, obj, GjsTypecheckNoThrow{})) {
+            GError* error = ErrorBase::to_c_ptr(m_cx, obj);
+            if (!error)
+                return false;
+            return return_with([error](GDBusMethodInvocation* invocation) {
+                g_dbus_method_invocation_return_gerror(invocation, error);
+            });
+        }
+    }
+
+    const GjsAtoms& atoms = GjsContextPrivate::atoms(m_cx);
+    JS::RootedValue v_name{m_cx}, v_message{m_cx};
+    if (exc.isObject()) {
+        JS::RootedObject obj{m_cx, &exc.toObject()};
+        if (!JS_GetPropertyById(m_cx, obj, atoms.name(), &v_name) ||
+            !JS_GetPropertyById(m_cx, obj, atoms.message(), &v_message))
+            return false;
+    } else {
+        v_message.set(exc);
+    }
+
+    std::string error_name{"Error"};
+    if (!v_name.isUndefined()) {
+        JS::UniqueChars name = gjs_string_to_utf8(m_cx, v_name);
+        if (!name)
+            return false;
+        error_name = name.get();
+    }
+    // Likely to be a normal JS error
+    if (error_name.find('.') == std::string::npos)
+        error_name.insert(0, "org.gnome.gjs.JSError.");
+
+    JS::RootedString message_str{m_cx, JS::ToString(m_cx, v_message)};
+    if (!message_str)
+        return false;
+    JS::UniqueChars message = JS_EncodeStringToUTF8(m_cx, message_str);
+    if (!message)
+        return false;
+
+    log_exception(exc);
+
+    return return_with(
+        [&error_name, &message](GDBusMethodInvocation* invocation) {
+            g_dbus_method_invocation_return_dbus_error(
+                invocation, error_name.c_str(), message.get());
+        });
+}
+
+// For fooAsync() implementations, which may already have returned the
+// invocation before throwing
+bool MethodCall::maybe_return_error(JS::HandleValue exc) {
+    bool returned;
+    if (!was_returned(&returned))
+        return false;
+
+    if (returned) {
+        log_exception(exc);
+        return true;
+    }
+
+    return return_error(exc);
+}
+
+// Returns a function that replies to the invocation when called
+GJS_JSAPI_RETURN_CONVENTION
+static JSObject* new_reply_func(JSContext* cx, JSNative native,
+                                const MethodCall& call, const char* name) {
+    JSFunction* func = js::NewFunctionWithReserved(cx, native, 1, 0, name);
+    if (!func)
+        return nullptr;
+
+    JSObject* func_obj = JS_GetFunctionObject(func);
+    js::SetFunctionNativeReserved(func_obj, 0, JS::ObjectValue(*call.data()));
+    js::SetFunctionNativeReserved(func_obj, 1,
+                                  JS::ObjectValue(*call.invocation_obj()));
+    return func_obj;
+}
+
+template <bool (MethodCall::*REPLY)(JS::HandleValue)>
+GJS_JSAPI_RETURN_CONVENTION static bool reply_func(JSContext* cx,
+                                                   unsigned argc,
+                                                   JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedValue invocation{
+        cx, js::GetFunctionNativeReserved(&args.callee(), 1)};
+
+    MethodCall call{cx};
+    if (!call.init(&js::GetFunctionNativeReserved(&args.callee(), 0).toObject(),
+                   invocation) ||
+        !(call.*REPLY)(args.get(0)))
+        return false;
+
+    args.rval().setUndefined();
+    return true;
+}
+
+// If `value` has a callable property `name`, calls it with a function that
+// replies to the invocation, as in `value?.then?.(reply)`
+GJS_JSAPI_RETURN_CONVENTION
+static bool maybe_call_with_reply_funcs(JSContext* cx, JS::HandleValue value,
+                                        const char* name,
+                                        const JS::HandleValueArray& funcs,
+                                        bool* called) {
+    *called = false;
+    if (!value.isObject())
+        return true;
+
+    JS::RootedObject obj{cx, &value.toObject()};
+    JS::RootedValue method{cx};
+    if (!JS_GetProperty(cx, obj, name, &method))
+        return false;
+    if (!method.isObject() || !JS::IsCallable(&method.toObject()))
+        return true;
+
+    JS::RootedValue ignored_rval{cx};
+    *called = true;
+    return JS::Call(cx, value, method, funcs, &ignored_rval);
+}
+
+// The handler for the handle-method-call signal of a Gio.DBusExportedObject:
+// unpacks the in arguments, calls the implementation, and packs the reply
+GJS_JSAPI_RETURN_CONVENTION
+static bool exported_method_call(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!args.requireAtLeast(cx, "handle-method-call handler", 4))
+        return false;
+
+    MethodCall call{cx};
+    if (!call.init(&js::GetFunctionNativeReserved(&args.callee(), 0).toObject(),
+                   args[3]))
+        return false;
+
+    if (!args[2].isObject()) {
+        gjs_throw(cx, "Expected a GLib.Variant for the parameters");
+        return false;
+    }
+    JS::RootedObject params_obj{cx, &args[2].toObject()};
+    if (!StructBase::typecheck(cx, params_obj, G_TYPE_VARIANT))
+        return false;
+    GVariant* parameters = StructBase::to_c_ptr<GVariant>(cx, params_obj);
+    if (!parameters)
+        return false;
+
+    JS::RootedValue fd_list{cx, JS::NullValue()};
+    GDBusMessage* message =
+        g_dbus_method_invocation_get_message(call.invocation());
+    if (GUnixFDList* list = g_dbus_message_get_unix_fd_list(message)) {
+        JSObject* wrapper =
+            ObjectInstance::wrapper_from_gobject(cx, G_OBJECT(list));
+        if (!wrapper)
+            return false;
+        fd_list.setObject(*wrapper);
+    }
+
+    args.rval().setUndefined();
+    const ExportedMethod* method = call.method();
+    if (!method)
+        return call.return_unknown_method();
+
+    JS::RootedObject js_obj{cx, call.js_object()};
+    JS::RootedValue this_value{cx, JS::ObjectValue(*js_obj)};
+    JS::RootedValue impl{cx}, retval{cx}, exc{cx};
+
+    // Prefer the synchronous implementation, if available
+    JS::RootedId id{cx, method->id};
+    if (!JS_GetPropertyById(cx, js_obj, id, &impl))
+        return false;
+    if (JS::ToBoolean(impl)) {
+        JS::RootedValueVector impl_args{cx};
+        size_t n_children = g_variant_n_children(parameters);
+        if (!impl_args.reserve(n_children + 1)) {
+            JS_ReportOutOfMemory(cx);
+            return false;
+        }
+
+        JS::RootedValue arg{cx};
+        bool ok = true;
+        for (size_t ix = 0; ok && ix < n_children; ix++) {
+            Gjs::AutoGVariant child{g_variant_get_child_value(parameters, ix)};
+            ok = gjs_variant_unpack(cx, child, GjsVariantUnpack::DEEP, &arg);
+            if (ok)
+                impl_args.infallibleAppend(arg);
+        }
+        impl_args.infallibleAppend(fd_list);
+
+        if (!ok || !JS::Call(cx, this_value, impl, impl_args, &retval)) {
+            if (!JS_GetPendingException(cx, &exc))
+                return false;
+            JS_ClearPendingException(cx);
+            return call.return_error(exc);
+        }
+
+        // The implementation may return a promise for the reply
+        JS::RootedValueArray<2> reply_funcs{cx};
+        JSObject* resolved = new_reply_func(
+            cx, &reply_func<&MethodCall::return_value>, call, "resolved");
+        if (!resolved)
+            return false;
+        reply_funcs[0].setObject(*resolved);
+        JSObject* rejected = new_reply_func(
+            cx, &reply_func<&MethodCall::return_error>, call, "rejected");
+        if (!rejected)
+            return false;
+        reply_funcs[1].setObject(*rejected);
+
+        bool is_thenable;
+        if (!maybe_call_with_reply_funcs(cx, retval, "then", reply_funcs,
+                                         &is_thenable))
+            return false;
+        if (is_thenable)
+            return true;
+
+        return call.return_value(retval);
+    }
+
+    JS::RootedId async_id{cx, method->async_id};
+    if (!JS_GetPropertyById(cx, js_obj, async_id, &impl))
+        return false;
+    if (!JS::ToBoolean(impl))
+        return call.return_unknown_method();
+
+    // fooAsync(parameters, invocation, fdList) returns the invocation itself
+    JS::RootedValueArray<3> impl_args{cx};
+    if (!gjs_variant_unpack(cx, parameters, GjsVariantUnpack::DEEP,
+                            impl_args[0]))
+        return false;
+    impl_args[1].setObject(*call.invocation_obj());
+    impl_args[2].set(fd_list);
+
+    if (!JS::Call(cx, this_value, impl, impl_args, &retval)) {
+        if (!JS_GetPendingException(cx, &exc))
+            return false;
+        JS_ClearPendingException(cx);
+        return call.maybe_return_error(exc);
+    }
+
+    JS::RootedValueArray<1> catch_func{cx};
+    JSObject* rejected = new_reply_func(
+        cx, &reply_func<&MethodCall::maybe_return_error>, call, "rejected");
+    if (!rejected)
+        return false;
+    catch_func[0].setObject(*rejected);
+
+    bool unused;
+    return maybe_call_with_reply_funcs(cx, retval, "catch", catch_func,
+                                       &unused);
+}
+
+// makeMethodCallHandler(interfaceInfo, jsObj, invocations): Returns a handler
+// for the handle-method-call signal of a Gio.DBusExportedObject that calls the
+// methods of jsObj. Looks up the out signatures of all the methods up front.
+GJS_JSAPI_RETURN_CONVENTION
+static bool make_method_call_handler(JSContext* cx, unsigned argc,
+                                     JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject info_obj{cx}, js_obj{cx}, invocations{cx};
+    if (!gjs_parse_call_args(cx, "makeMethodCallHandler", args, "ooo",
+                             "interfaceInfo", &info_obj, "jsObj", &js_obj,
+                             "invocations", &invocations))
+        return false;
+
+    if (!StructBase::typecheck(cx, info_obj, G_TYPE_DBUS_INTERFACE_INFO))
+        return false;
+    auto* info = StructBase::to_c_ptr<GDBusInterfaceInfo>(cx, info_obj);
+    if (!info)
+        return false;
+
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    auto methods = std::make_unique<ExportedMethods>();
+    JS::RootedString name_str{cx};
+    JS::RootedId id{cx};
+    for (GDBusMethodInfo** m = info->methods; m && *m; m++) {
+        ExportedMethod method;
+
+        std::string async_name{(*m)->name};
+        async_name += "Async";
+        if (!(name_str = JS_AtomizeString(cx, (*m)->name)) ||
+            !JS_StringToId(cx, name_str, &id))
+            return false;
+        method.id = id;
+        if (!(name_str = JS_AtomizeString(cx, async_name.c_str())) ||
+            !JS_StringToId(cx, name_str, &id))
+            return false;
+        method.async_id = id;
+
+        method.out_type_string = '(';
+        for (GDBusArgInfo** arg = (*m)->out_args; arg && *arg; arg++) {
+            method.out_type_string += (*arg)->signature;
+            method.n_out_args++;
+        }
+        method.out_type_string += ')';
+
+        // A bad signature is reported when the method returns, as before
+        std::shared_ptr<const Gjs::VariantSignature> out_signature =
+            gjs->variant_signatures().lookup(cx,
+                                             method.out_type_string.c_str());
+        if (out_signature)
+            method.out_signature.emplace(*out_signature);
+        else
+            JS_ClearPendingException(cx);
+
+        methods->emplace((*m)->name, std::move(method));
+    }
+
+    JS::RootedObject data{cx, JS_NewObject(cx, &exported_object_class)};
+    if (!data)
+        return false;
+    JS::SetReservedSlot(data, EXPORTED_METHODS,
+                        JS::PrivateValue(methods.release()));
+    JS::SetReservedSlot(data, EXPORTED_JS_OBJECT, JS::ObjectValue(*js_obj));
+    JS::SetReservedSlot(data, EXPORTED_INVOCATIONS,
+                        JS::ObjectValue(*invocations));
+
+    JSFunction* handler = js::NewFunctionWithReserved(
+        cx, &exported_method_call, 4, 0, "handleMethodCall");
+    if (!handler)
+        return false;
+    JSObject* handler_obj = JS_GetFunctionObject(handler);
+    js::SetFunctionNativeReserved(handler_obj, 0, JS::ObjectValue(*data));
+
+    args.rval().setObject(*handler_obj);
+    return true;
+}
+
+static JSFunctionSpec dbus_module_funcs[] = {
+    JS_FN("makeProxyMethods", make_proxy_methods, 1, 0),
+    JS_FN("makeMethodCallHandler", make_method_call_handler, 3, 0),
+    JS_FS_END};
+
+bool gjs_define_dbus_stuff(JSContext* cx, JS::MutableHandleObject module) {
+    JSObject* new_obj = JS_NewPlainObject(cx);
+    if (!new_obj)
+        return false;
+    module.set(new_obj);
+
+    return JS_DefineFunctions(cx, module, dbus_module_funcs);
+}
@@ -0,0 +1,111 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>  // for move
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "gjs/auto.h"
+#include "gjs/directory-cache.h"
+#include "util/log.h"
+
+namespace Gjs {
+
+int64_t DirectoryCache::query_mtime(GFile* directory) {
+    AutoUnref<GFileInfo> info{g_file_query_info(
+        directory,
+        G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+        G_FILE_QUERY_INFO_NONE, nullptr, nullptr)};
+    if (!info)
+        return 0;
+    uint64_t seconds =
+        g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+    uint32_t usec = g_file_info_get_attribute_uint32(
+        info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+    return int64_t(seconds) * G_USEC_PER_SEC + usec;
+}
+
+const DirectoryCache::Listing& DirectoryCache::ensure_listing(
+    const char* dirname) {
+    auto it = m_listings.find(dirname);
+    if (it != m_listings.end())
+        return it->second;
+
+    Listing listing;
+
+    // new_for_commandline_arg handles resource:/// paths
+    AutoUnref<GFile> directory{g_file_new_for_commandline_arg(dirname)};
+    // Before listing, so that a change made meanwhile is seen by refresh()
+    listing.mtime = query_mtime(directory);
+    listing.listed_at = g_get_real_time();
+    AutoError error;
+    AutoUnref<GFileEnumerator> direnum{g_file_enumerate_children(
+        directory, "standard::name,standard::type", G_FILE_QUERY_INFO_NONE,
+        nullptr, &error)};
+
+    if (direnum) {
+        while (true) {
+            GFileInfo* info;
+            if (!g_file_enumerator_iterate(direnum, &info, nullptr, nullptr,
+                                           nullptr) ||
+                !info)
+                break;
+
+            const char* name = g_file_info_get_name(info);
+            GFileType type = g_file_info_get_file_type(info);
+            // UNKNOWN is reserved for children that don't exist
+            if (type == G_FILE_TYPE_UNKNOWN)
+                type = G_FILE_TYPE_REGULAR;
+            listing.types.emplace(name, type);
+            listing.entries.emplace_back(name, type);
+        }
+    } else {
+        // Cache a missing directory as empty, too
+        gjs_debug(GJS_DEBUG_IMPORTER, "Cannot list search path entry %s: %s",
+                  dirname, error->message);
+    }
+
+    gjs_debug(GJS_DEBUG_IMPORTER, "Cached %zu entries of search path entry %s",
+              listing.entries.size(), dirname);
+
+    return m_listings.emplace(dirname, std::move(listing)).first->second;
+}
+
+GFileType DirectoryCache::child_type(const char* dirname, const char* name) {
+    const Listing& listing = ensure_listing(dirname);
+    auto it = listing.types.find(name);
+    return it == listing.types.end() ? G_FILE_TYPE_UNKNOWN : it->second;
+}
+
+DirectoryCache::Entries DirectoryCache::children(const char* dirname) {
+    return ensure_listing(dirname).entries;
+}
+
+bool DirectoryCache::refresh(const std::string& dirname) {
+    auto it = m_listings.find(dirname);
+    if (it == m_listings.end())
+        return false;
+
+    const Listing& listing = it->second;
+    AutoUnref<GFile> directory{
+        g_file_new_for_commandline_arg(dirname.c_str())};
+    bool racy = listing.mtime != 0 &&
+                listing.listed_at - listing.mtime < RACY_INTERVAL_US;
+    if (!racy && query_mtime(directory) == listing.mtime)
+        return false;
+
+    gjs_debug(GJS_DEBUG_IMPORTER, "Listing search path entry %s again",
+              dirname.c_str());
+    m_listings.erase(it);
+    ensure_listing(dirname.c_str());
+    return true;
+}
+
+}  // namespace Gjs
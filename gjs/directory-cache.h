@@ -0,0 +1,75 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <utility>  // for pair
+#include <vector>
+
+#include <gio/gio.h>
+
+namespace Gjs {
+
+/* Per-context cache of the contents of the directories on the legacy importer's
+ * search path. Each directory is listed once with g_file_enumerate_children(),
+ * after which looking for `name.js`, `name/`, or `__init__.js` in it is a hash
+ * lookup instead of a stat() call.
+ *
+ * Listings are not watched for changes. Instead, before reporting that a module
+ * was not found, the importer asks for the listings of its search path to be
+ * refreshed, which costs one stat() per directory, and searches again only if
+ * one of the directories was modified since it was listed. That way, modules
+ * that are added later can still be imported.
+ *
+ * Modification times have a coarse granularity on some file systems, so a
+ * directory that was modified shortly before it was listed may have changed
+ * again without its mtime changing. Such listings are always refreshed.
+ */
+class DirectoryCache {
+ public:
+    using Entries = std::vector<std::pair<std::string, GFileType>>;
+
+ private:
+    struct Listing {
+        // In the order returned by the enumerator
+        Entries entries;
+        std::unordered_map<std::string, GFileType> types;
+        // Of the directory, in µs, or 0 if it couldn't be queried
+        int64_t mtime;
+        // Wall clock time when the directory was listed, in µs
+        int64_t listed_at;
+    };
+
+    std::unordered_map<std::string, Listing> m_listings;
+
+    const Listing& ensure_listing(const char* dirname);
+    static int64_t query_mtime(GFile* directory);
+
+ public:
+    /* Returns the type of the child `name` of the search path directory
+     * `dirname` (as given in the search path, see
+     * g_file_new_for_commandline_arg()), or G_FILE_TYPE_UNKNOWN if there is no
+     * such child or the directory doesn't exist. */
+    [[nodiscard]]
+    GFileType child_type(const char* dirname, const char* name);
+
+    // Returns a copy of the children of the search path directory `dirname`
+    [[nodiscard]] Entries children(const char* dirname);
+
+    // Modifications this close to the listing may not have changed the mtime
+    static constexpr int64_t RACY_INTERVAL_US = 2 * G_USEC_PER_SEC;
+
+    /* Lists the directory `dirname` again if it may have been modified since
+     * it was listed. Returns whether it was listed again. */
+    bool refresh(const std::string& dirname);
+    void clear() { m_listings.clear(); }
+};
+
+}  // namespace Gjs
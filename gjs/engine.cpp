@@ -128,6 +128,8 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved) {
 class GjsInit {
  public:
     GjsInit() {
+        gjs_perf_map_init();
+
         const char* reason = JS_InitWithFailureDiagnostic();
         if (reason)
             g_error("Could not initialize JavaScript: %s", reason);
@@ -0,0 +1,199 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+
+#include <algorithm>  // for clamp, max, min
+#include <cmath>      // for sqrt
+
+#include <glib.h>
+
+#include "gjs/event-loop-monitor.h"
+#include "util/log.h"
+
+namespace Gjs {
+
+size_t Histogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS)
+        return value;
+
+    // Values in [2^n, 2^(n+1)) with n >= SUB_BUCKET_BITS go into one of the
+    // SUB_BUCKETS linear buckets of width 2^(n - SUB_BUCKET_BITS).
+    // g_bit_storage() takes an unsigned long, which may be only 32 bits.
+    unsigned n_bits = value >> 32 ? 32 + g_bit_storage(value >> 32)
+                                  : g_bit_storage(value);
+    unsigned shift = n_bits - 1 - SUB_BUCKET_BITS;
+    size_t sub_bucket = (value >> shift) - SUB_BUCKETS;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + sub_bucket;
+}
+
+uint64_t Histogram::bucket_upper_bound(size_t index) {
+    if (index < SUB_BUCKETS)
+        return index;
+
+    unsigned shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t sub_bucket = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + sub_bucket) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    m_buckets[bucket_index(value)]++;
+    m_min = m_count ? std::min(m_min, value) : value;
+    m_max = std::max(m_max, value);
+    m_count++;
+    m_sum += value;
+    m_sum_squares += static_cast<double>(value) * value;
+}
+
+void Histogram::reset() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+    m_sum = 0.0;
+    m_sum_squares = 0.0;
+}
+
+double Histogram::mean() const { return m_count ? m_sum / m_count : 0.0; }
+
+double Histogram::stddev() const {
+    if (m_count < 2)
+        return 0.0;
+    double mean = this->mean();
+    double variance = m_sum_squares / m_count - mean * mean;
+    return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+uint64_t Histogram::percentile(double percentile) const {
+    if (m_count == 0)
+        return 0;
+
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    auto target = static_cast<uint64_t>(percentile / 100.0 * m_count + 0.5);
+    target = std::max(target, uint64_t{1});
+
+    uint64_t seen = 0;
+    for (size_t ix = 0; ix < N_BUCKETS; ix++) {
+        seen += m_buckets[ix];
+        if (seen >= target)
+            return std::clamp(bucket_upper_bound(ix), min(), m_max);
+    }
+    return m_max;
+}
+
+struct EventLoopMonitor::TimerSource {
+    GSource base;
+    EventLoopMonitor* monitor;
+};
+
+// The poll function has no user data, so it finds the monitor through this.
+// Only one monitor can be active per thread, since there is one GjsContext per
+// thread.
+static thread_local EventLoopMonitor* s_polling_monitor = nullptr;
+
+EventLoopMonitor::EventLoopMonitor()
+    : m_main_context(g_main_context_ref_thread_default()),
+      m_resolution_us(0) {}
+
+EventLoopMonitor::~EventLoopMonitor() { stop(); }
+
+int64_t EventLoopMonitor::elapsed() const {
+    int64_t end_time = running() ? g_get_monotonic_time() : m_stop_time;
+    return end_time - m_start_time;
+}
+
+int EventLoopMonitor::poll_func(GPollFD* fds, unsigned n_fds, int timeout) {
+    EventLoopMonitor* self = s_polling_monitor;
+    g_assert(self && "Poll function installed without a monitor");
+
+    if (timeout == 0)
+        return self->m_chained_poll(fds, n_fds, timeout);
+
+    int64_t before = g_get_monotonic_time();
+    int retval = self->m_chained_poll(fds, n_fds, timeout);
+    self->m_idle_us += g_get_monotonic_time() - before;
+    return retval;
+}
+
+void EventLoopMonitor::schedule(int64_t now) {
+    m_expected_time = now + m_resolution_us;
+    g_source_set_ready_time(m_timer, m_expected_time);
+}
+
+gboolean EventLoopMonitor::on_timer_dispatch(GSource* source, GSourceFunc,
+                                             void*) {
+    EventLoopMonitor* self = reinterpret_cast<TimerSource*>(source)->monitor;
+
+    int64_t now = g_get_monotonic_time();
+    self->m_delay.record(std::max(now - self->m_expected_time, int64_t{0}));
+    self->schedule(now);
+    return G_SOURCE_CONTINUE;
+}
+
+void EventLoopMonitor::start(int64_t resolution_us) {
+    g_assert(resolution_us > 0);
+    stop();
+    reset();
+
+    static GSourceFuncs timer_funcs = {
+        nullptr, nullptr, &EventLoopMonitor::on_timer_dispatch, nullptr,
+        nullptr, nullptr};
+
+    m_resolution_us = resolution_us;
+    m_start_time = g_get_monotonic_time();
+
+    m_timer = g_source_new(&timer_funcs, sizeof(TimerSource));
+    reinterpret_cast<TimerSource*>(m_timer)->monitor = this;
+    g_source_set_priority(m_timer, G_PRIORITY_DEFAULT);
+    g_source_set_static_name(m_timer, "[gjs] Event loop monitor");
+    schedule(m_start_time);
+    g_source_attach(m_timer, m_main_context);
+
+    if (!s_polling_monitor) {
+        s_polling_monitor = this;
+        m_chained_poll = g_main_context_get_poll_func(m_main_context);
+        g_main_context_set_poll_func(m_main_context,
+                                     &EventLoopMonitor::poll_func);
+    } else {
+        g_warning("Another event loop monitor is already active on this "
+                  "thread; loop utilization will not be measured");
+    }
+
+    gjs_debug(GJS_DEBUG_CONTEXT,
+              "Event loop monitor started with resolution %" G_GINT64_FORMAT
+              " us",
+              resolution_us);
+}
+
+void EventLoopMonitor::stop() {
+    if (!m_timer)
+        return;
+
+    g_source_destroy(m_timer);
+    g_source_unref(m_timer);
+    m_timer = nullptr;
+    m_stop_time = g_get_monotonic_time();
+
+    if (s_polling_monitor == this) {
+        g_main_context_set_poll_func(m_main_context, m_chained_poll);
+        m_chained_poll = nullptr;
+        s_polling_monitor = nullptr;
+    }
+
+    gjs_debug(GJS_DEBUG_CONTEXT, "Event loop monitor stopped");
+}
+
+void EventLoopMonitor::reset() {
+    m_delay.reset();
+    m_idle_us = 0;
+    m_start_time = m_stop_time = g_get_monotonic_time();
+    if (m_timer)
+        schedule(m_start_time);
+}
+
+}  // namespace Gjs
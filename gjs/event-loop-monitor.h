@@ -0,0 +1,101 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+
+#include <array>
+
+#include <glib.h>
+
+#include "gjs/auto.h"
+
+namespace Gjs {
+
+/* Fixed-size log-linear histogram of non-negative integer values, in the spirit
+ * of HdrHistogram. Each power of two is split into 16 linear sub-buckets, so
+ * the relative error of a reported value is at most 1/16. Recording a value
+ * never allocates. */
+class Histogram {
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr unsigned SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t N_BUCKETS =
+        SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    std::array<uint64_t, N_BUCKETS> m_buckets;
+    uint64_t m_count;
+    uint64_t m_min;
+    uint64_t m_max;
+    double m_sum;
+    double m_sum_squares;
+
+    [[nodiscard]] static size_t bucket_index(uint64_t value);
+    [[nodiscard]] static uint64_t bucket_upper_bound(size_t index);
+
+ public:
+    Histogram() { reset(); }
+
+    void record(uint64_t value);
+    void reset();
+
+    [[nodiscard]] uint64_t count() const { return m_count; }
+    [[nodiscard]] uint64_t min() const { return m_count ? m_min : 0; }
+    [[nodiscard]] uint64_t max() const { return m_max; }
+    [[nodiscard]] double mean() const;
+    [[nodiscard]] double stddev() const;
+    // Percentile in the range 0-100
+    [[nodiscard]] uint64_t percentile(double percentile) const;
+};
+
+/* Measures main loop responsiveness, like Node's monitorEventLoopDelay() and
+ * eventLoopUtilization().
+ *
+ * The delay is sampled by a timer source on the thread-default main context,
+ * which is scheduled every `resolution` and records how late it was actually
+ * dispatched. Utilization is measured by wrapping the main context's poll
+ * function: time spent blocked in poll() counts as idle, everything else as
+ * active. */
+class EventLoopMonitor {
+    struct TimerSource;
+
+    AutoPointer<GMainContext, GMainContext, g_main_context_unref>
+        m_main_context;
+    GSource* m_timer = nullptr;
+    GPollFunc m_chained_poll = nullptr;
+
+    Histogram m_delay;  // in µs
+    int64_t m_resolution_us;
+    int64_t m_expected_time = 0;
+
+    int64_t m_start_time = 0;
+    int64_t m_stop_time = 0;
+    int64_t m_idle_us = 0;
+
+    static gboolean on_timer_dispatch(GSource*, GSourceFunc, void* data);
+    static int poll_func(GPollFD* fds, unsigned n_fds, int timeout);
+    void schedule(int64_t now);
+
+ public:
+    EventLoopMonitor();
+    ~EventLoopMonitor();
+
+    EventLoopMonitor(const EventLoopMonitor&) = delete;
+    EventLoopMonitor& operator=(const EventLoopMonitor&) = delete;
+
+    void start(int64_t resolution_us);
+    void stop();
+    void reset();
+
+    [[nodiscard]] bool running() const { return !!m_timer; }
+    [[nodiscard]] const Histogram& delay() const { return m_delay; }
+    [[nodiscard]] int64_t resolution() const { return m_resolution_us; }
+    [[nodiscard]] int64_t elapsed() const;
+    [[nodiscard]] int64_t idle() const { return m_idle_us; }
+};
+
+}  // namespace Gjs
@@ -49,9 +49,11 @@
 #ifdef G_OS_UNIX
 #include <glib-unix.h>
 #endif
+#include <glib/gstdio.h>
 #include <inttypes.h>
 #include <iomanip>
 #include <js/AllocPolicy.h>
+#include <js/AllocationRecording.h>
 #include <js/Array.h>
 #include <js/ArrayBuffer.h>
 #include <js/BigInt.h>
@@ -152,6 +154,8 @@
 #include <sysprof-capture.h>
 #endif
 #ifdef HAVE_UNISTD_H
+#include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 #ifdef _WIN32
@@ -303,6 +303,8 @@ class GjsInternalGlobal : GjsBaseGlobal {
         JS_FN("setModulePrivate", gjs_internal_set_module_private, 2, 0),
         JS_FN("uriExists", gjs_internal_uri_exists, 1, 0),
         JS_FN("atob", gjs_internal_atob, 1, 0),
+        JS_FN("clearResolutionCache", gjs_internal_clear_resolution_cache, 0,
+              0),
         JS_FS_END};
 
     static constexpr JSClass klass = {
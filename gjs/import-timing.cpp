@@ -0,0 +1,177 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>  // for strcmp
+
+#include <algorithm>  // for sort
+#include <chrono>
+#include <string>
+#include <utility>  // for pair
+#include <vector>
+
+#include <glib.h>
+
+#include "gi/gjs_gi_trace.h"
+#include "gjs/context-private.h"
+#include "gjs/import-timing.h"
+#include "gjs/profiler-private.h"
+#include "util/log.h"
+#include "util/misc.h"  // for LogFile
+
+namespace Gjs {
+
+static const char* phase_name(ImportPhase phase) {
+    switch (phase) {
+        case ImportPhase::RESOLVE:
+            return "Resolve";
+        case ImportPhase::FETCH:
+            return "Fetch";
+        case ImportPhase::COMPILE:
+            return "Compile";
+        case ImportPhase::LINK:
+            return "Link";
+        case ImportPhase::EVALUATE:
+            return "Evaluate";
+        default:
+            g_assert_not_reached();
+    }
+}
+
+static void add_profiler_mark(GjsProfiler* profiler, ImportPhase phase,
+                              const char* module, int64_t begin_us,
+                              int64_t duration_us) {
+    ProfilerTimePoint begin{std::chrono::microseconds{begin_us}};
+    ProfilerDuration duration{std::chrono::microseconds{duration_us}};
+    gjs_profiler_add_mark(profiler, begin, duration, "Import",
+                          phase_name(phase), module);
+}
+
+int64_t ImportTimings::Entry::total() const {
+    int64_t total = 0;
+    for (int64_t us : phase_us)
+        total += us;
+    return total;
+}
+
+void ImportTimings::record(const std::string& module, ImportPhase phase,
+                           int64_t duration_us) {
+    m_entries[module].phase_us[size_t(phase)] += duration_us;
+}
+
+void ImportTimings::report(FILE* fp) const {
+    std::vector<std::pair<const std::string*, const Entry*>> sorted;
+    sorted.reserve(m_entries.size());
+    for (const auto& [module, entry] : m_entries)
+        sorted.emplace_back(&module, &entry);
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second->total() > b.second->total();
+    });
+
+    std::array<int64_t, N_IMPORT_PHASES> phase_totals{};
+
+    fprintf(fp, "# Import timings (ms), slowest first #\n\n");
+    fprintf(fp, "%10s %10s %10s %10s %10s %10s  %s\n", "total", "resolve",
+            "fetch", "compile", "link", "evaluate", "module");
+    for (const auto& [module, entry] : sorted) {
+        fprintf(fp, "%10.3f", entry->total() / 1000.0);
+        for (size_t ix = 0; ix < N_IMPORT_PHASES; ix++) {
+            fprintf(fp, " %10.3f", entry->phase_us[ix] / 1000.0);
+            phase_totals[ix] += entry->phase_us[ix];
+        }
+        fprintf(fp, "  %s\n", module->c_str());
+    }
+
+    int64_t total = 0;
+    for (int64_t us : phase_totals)
+        total += us;
+    fprintf(fp, "%10.3f", total / 1000.0);
+    for (int64_t us : phase_totals)
+        fprintf(fp, " %10.3f", us / 1000.0);
+    fprintf(fp, "  (%zu modules)\n", m_entries.size());
+}
+
+void ImportTimings::report() const {
+    const char* filename = m_output.c_str();
+    if (strcmp(filename, "stderr") == 0 || strcmp(filename, "1") == 0)
+        filename = nullptr;
+
+    LogFile file{filename, stderr};
+    if (file.has_error()) {
+        g_warning("Cannot write import timings to %s: %s", filename,
+                  file.errmsg());
+        return;
+    }
+    report(file.fp());
+}
+
+AutoImportTimer::AutoImportTimer(JSContext* cx, ImportPhase phase,
+                                 const char* module)
+    : m_phase(phase) {
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    m_timings = gjs->import_timings();
+    if (gjs->profiler() && gjs_profiler_is_running(gjs->profiler()))
+        m_profiler = gjs->profiler();
+    m_traced = TRACE_ENABLED(GJS_MODULE_PHASE_END);
+    TRACE(GJS_MODULE_PHASE_START(phase_name(phase), module ? module : ""));
+
+    if (module && wants_module())
+        m_module = module;
+    if (!active())
+        return;
+
+    if (m_timings) {
+        m_parent = m_timings->m_current;
+        m_timings->m_current = this;
+    }
+    m_begin_us = g_get_monotonic_time();
+}
+
+AutoImportTimer::~AutoImportTimer() {
+    const char* module = m_module.empty() ? "<unknown>" : m_module.c_str();
+    TRACE(GJS_MODULE_PHASE_END(phase_name(m_phase), module));
+    if (!active())
+        return;
+
+    int64_t duration_us = g_get_monotonic_time() - m_begin_us;
+
+    if (m_profiler && !m_deferred)
+        add_profiler_mark(m_profiler, m_phase, module, m_begin_us, duration_us);
+
+    if (m_timings) {
+        g_assert(m_timings->m_current == this &&
+                 "Import timers must be strictly nested");
+        m_timings->m_current = m_parent;
+        if (m_parent)
+            m_parent->m_children_us += duration_us;
+        if (!m_deferred)
+            m_timings->record(module, m_phase, duration_us - m_children_us);
+    }
+}
+
+int64_t AutoImportTimer::elapsed_us() const {
+    return g_get_monotonic_time() - m_begin_us - m_children_us;
+}
+
+void record_import_phase(JSContext* cx, ImportPhase phase, const char* module,
+                         int64_t begin_us) {
+    record_import_phase(cx, phase, module, begin_us,
+                        g_get_monotonic_time() - begin_us);
+}
+
+void record_import_phase(JSContext* cx, ImportPhase phase, const char* module,
+                         int64_t begin_us, int64_t duration_us) {
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+
+    if (gjs->profiler() && gjs_profiler_is_running(gjs->profiler()))
+        add_profiler_mark(gjs->profiler(), phase, module, begin_us,
+                          duration_us);
+    if (ImportTimings* timings = gjs->import_timings())
+        timings->record(module, phase, duration_us);
+}
+
+}  // namespace Gjs
@@ -0,0 +1,110 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+#include <stdio.h>  // for FILE
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <utility>  // for move
+
+#include <js/TypeDecls.h>
+
+#include "gjs/profiler.h"
+
+namespace Gjs {
+
+enum class ImportPhase : uint8_t {
+    RESOLVE,
+    FETCH,
+    COMPILE,
+    LINK,
+    EVALUATE,
+};
+static constexpr size_t N_IMPORT_PHASES = size_t(ImportPhase::EVALUATE) + 1;
+
+class AutoImportTimer;
+
+/* Accumulates the time spent in each phase of importing, per module. This
+ * covers ES modules, legacy imports.* script modules, and GI namespaces. Only
+ * present if GJS_IMPORT_TIMINGS is set; the report is written when the context
+ * is disposed. */
+class ImportTimings {
+    friend class AutoImportTimer;
+
+    struct Entry {
+        std::array<int64_t, N_IMPORT_PHASES> phase_us{};
+        [[nodiscard]] int64_t total() const;
+    };
+
+    std::unordered_map<std::string, Entry> m_entries;
+    std::string m_output;
+    // Innermost running timer, so that nested imports can be subtracted from
+    // the time of the import that triggered them
+    AutoImportTimer* m_current = nullptr;
+
+ public:
+    // `output` is a file path, or "stderr" or "1" for stderr
+    explicit ImportTimings(const char* output) : m_output(output) {}
+
+    void record(const std::string& module, ImportPhase, int64_t duration_us);
+    void report(FILE* fp) const;
+    void report() const;
+};
+
+/* Times one phase of importing one module, and records it in the context's
+ * ImportTimings, if any, and as a Sysprof mark if the profiler is running.
+ * Time spent in nested timers is not counted. Does nothing if neither is
+ * enabled, apart from firing the module__phase__start/end USDT probes. The
+ * module may be given later with set_module(), for when it's not known until
+ * the phase is done, as in resolving. */
+class AutoImportTimer {
+    AutoImportTimer* m_parent = nullptr;
+    ImportTimings* m_timings = nullptr;
+    GjsProfiler* m_profiler = nullptr;
+    std::string m_module;
+    int64_t m_begin_us = 0;
+    int64_t m_children_us = 0;
+    ImportPhase m_phase;
+    bool m_traced = false;  // a tracer is attached to the end probe
+    bool m_deferred = false;
+
+ public:
+    AutoImportTimer(JSContext*, ImportPhase, const char* module = nullptr);
+    ~AutoImportTimer();
+
+    AutoImportTimer(const AutoImportTimer&) = delete;
+    AutoImportTimer& operator=(const AutoImportTimer&) = delete;
+
+    [[nodiscard]] bool active() const { return m_timings || m_profiler; }
+    // Whether to bother computing the module name for set_module()
+    [[nodiscard]] bool wants_module() const { return active() || m_traced; }
+    void set_module(const char* module) { m_module = module; }
+    void set_module(std::string&& module) { m_module = std::move(module); }
+
+    // For when the module is only known some time after the phase, as in
+    // resolving a dynamic import: the timer doesn't record anything itself,
+    // and begin_us() and elapsed_us() are passed to record_import_phase()
+    // later instead
+    void defer() { m_deferred = true; }
+    [[nodiscard]] int64_t begin_us() const { return m_begin_us; }
+    [[nodiscard]] int64_t elapsed_us() const;
+};
+
+/* For phases that don't run synchronously, such as fetching a module
+ * asynchronously; records the time from `begin_us` (monotonic time) until now.
+ * Not subtracted from any enclosing timer. */
+void record_import_phase(JSContext*, ImportPhase, const char* module,
+                         int64_t begin_us);
+// Same, with a duration measured earlier by a deferred AutoImportTimer
+void record_import_phase(JSContext*, ImportPhase, const char* module,
+                         int64_t begin_us, int64_t duration_us);
+
+}  // namespace Gjs
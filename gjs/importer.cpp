@@ -5,7 +5,7 @@
 #include <config.h>
 
 #include <stdint.h>
-#include <string.h>  // for size_t, strcmp, strlen
+#include <string.h>  // for size_t, strchr, strcmp, strlen
 
 #ifdef _WIN32
 #    include <windows.h>
@@ -47,6 +47,7 @@
 #include "gjs/atoms.h"
 #include "gjs/auto.h"
 #include "gjs/context-private.h"
+#include "gjs/directory-cache.h"
 #include "gjs/gerror-result.h"
 #include "gjs/global.h"
 #include "gjs/importer.h"
@@ -311,9 +312,12 @@ static bool import_module_init(JSContext* cx, GFile* file,
                                 &ignored);
 }
 
+/* `exists` is false if the directory listing showed that there is no
+ * __init__.js, in which case an empty module is created without trying to load
+ * the file. */
 GJS_JSAPI_RETURN_CONVENTION
 static JSObject* load_module_init(JSContext* cx, JS::HandleObject in_object,
-                                  GFile* file) {
+                                  GFile* file, bool exists) {
     bool found;
     const GjsAtoms& atoms = GjsContextPrivate::atoms(cx);
 
@@ -338,7 +342,7 @@ static JSObject* load_module_init(JSContext* cx, JS::HandleObject in_object,
     if (!module_obj)
         return nullptr;
 
-    if (!import_module_init(cx, file, module_obj))
+    if (exists && !import_module_init(cx, file, module_obj))
         return nullptr;
 
     if (!JS_DefinePropertyById(cx, in_object, atoms.module_init(), module_obj,
@@ -351,8 +355,9 @@ static JSObject* load_module_init(JSContext* cx, JS::HandleObject in_object,
 GJS_JSAPI_RETURN_CONVENTION
 static bool load_module_elements(JSContext* cx, JS::HandleObject in_object,
                                  JS::MutableHandleIdVector prop_ids,
-                                 GFile* file) {
-    JS::RootedObject module_obj(cx, load_module_init(cx, in_object, file));
+                                 GFile* file, bool exists) {
+    JS::RootedObject module_obj(cx,
+                                load_module_init(cx, in_object, file, exists));
     if (!module_obj)
         return false;
 
@@ -373,13 +378,14 @@ static bool load_module_elements(JSContext* cx, JS::HandleObject in_object,
  */
 GJS_JSAPI_RETURN_CONVENTION
 static bool import_symbol_from_init_js(JSContext* cx, JS::HandleObject importer,
-                                       GFile* directory, const char* name,
-                                       bool* result) {
+                                       GFile* directory, bool init_js_exists,
+                                       const char* name, bool* result) {
     bool found;
     Gjs::AutoUnref<GFile> file{
         g_file_get_child(directory, MODULE_INIT_FILENAME)};
 
-    JS::RootedObject module_obj(cx, load_module_init(cx, importer, file));
+    JS::RootedObject module_obj(
+        cx, load_module_init(cx, importer, file, init_js_exists));
     if (!module_obj || !JS_AlreadyHasOwnProperty(cx, module_obj, name, &found))
         return false;
 
@@ -429,58 +435,24 @@ static bool import_file_on_module(JSContext* cx, JS::HandleObject obj,
     return true;
 }
 
+/* Searches each directory in the importer's search path for the module, and
+ * imports it if found. On success, *found indicates whether the module was
+ * found; the names of the search path directories are added to
+ * *searched_dirnames. */
 GJS_JSAPI_RETURN_CONVENTION
-static bool do_import(JSContext* cx, JS::HandleObject obj, JS::HandleId id) {
-    JS::RootedObject search_path{cx};
-    const GjsAtoms& atoms = GjsContextPrivate::atoms(cx);
-
-    if (!gjs_object_require_property(cx, obj, "importer", atoms.search_path(),
-                                     &search_path))
-        return false;
-
-    bool is_array;
-    if (!JS::IsArrayObject(cx, search_path, &is_array))
-        return false;
-    if (!is_array) {
-        gjs_throw(cx, "searchPath property on importer is not an array");
-        return false;
-    }
-
-    uint32_t search_path_len;
-    if (!JS::GetArrayLength(cx, search_path, &search_path_len)) {
-        gjs_throw(cx, "searchPath array has no length");
-        return false;
-    }
-
-    JS::UniqueChars name;
-    if (!gjs_get_string_id(cx, id, &name))
-        return false;
-    if (!name) {
-        gjs_throw(cx, "Importing invalid module name");
-        return false;
-    }
-
-    // null if this is the root importer
-    JS::RootedValue parent{cx};
-    if (!JS_GetPropertyById(cx, obj, atoms.parent_module(), &parent))
-        return false;
-
-    // First try importing an internal module like gi
-    if (parent.isNull() &&
-        Gjs::NativeModuleDefineFuncs::get().is_registered(name.get())) {
-        if (!gjs_import_native_module(cx, obj, name.get()))
-            return false;
-
-        gjs_debug(GJS_DEBUG_IMPORTER, "successfully imported module '%s'",
-                  name.get());
-        return true;
-    }
-
-    Gjs::AutoChar filename{g_strdup_printf("%s.js", name.get())};
+static bool import_from_search_path(
+    JSContext* cx, JS::HandleObject obj, JS::HandleId id, const char* name,
+    JS::HandleObject search_path, uint32_t search_path_len, bool* found,
+    std::vector<std::string>* searched_dirnames) {
+    Gjs::DirectoryCache& dir_cache =
+        GjsContextPrivate::from_cx(cx)->directory_cache();
+    Gjs::AutoChar filename{g_strdup_printf("%s.js", name)};
     std::vector<std::string> directories;
     JS::RootedValue elem{cx};
     JS::RootedString str{cx};
 
+    *found = false;
+
     for (uint32_t i = 0; i < search_path_len; ++i) {
         elem.setUndefined();
         if (!JS_GetElement(cx, search_path, i, &elem)) {
@@ -507,25 +479,29 @@ static bool do_import(JSContext* cx, JS::HandleObject obj, JS::HandleId id) {
         if (dirname[0] == '\0')
             continue;
 
+        searched_dirnames->emplace_back(dirname.get());
+
         Gjs::AutoUnref<GFile> directory{
             g_file_new_for_commandline_arg(dirname.get())};
 
         // Try importing __init__.js and loading the symbol from it
-        bool found = false;
-        if (!import_symbol_from_init_js(cx, obj, directory, name.get(), &found))
+        bool init_js_exists = dir_cache.child_type(dirname.get(),
+                                                   MODULE_INIT_FILENAME) !=
+                              G_FILE_TYPE_UNKNOWN;
+        if (!import_symbol_from_init_js(cx, obj, directory, init_js_exists,
+                                        name, found))
             return false;
-        if (found)
+        if (*found)
             return true;
 
         // Second try importing a directory (a sub-importer)
-        Gjs::AutoUnref<GFile> file{g_file_get_child(directory, name.get())};
-
-        if (g_file_query_file_type(file, GFileQueryInfoFlags(0), nullptr) ==
+        if (dir_cache.child_type(dirname.get(), name) ==
             G_FILE_TYPE_DIRECTORY) {
+            Gjs::AutoUnref<GFile> file{g_file_get_child(directory, name)};
             Gjs::AutoChar full_path{g_file_get_parse_name(file)};
             gjs_debug(GJS_DEBUG_IMPORTER,
                       "Adding directory '%s' to child importer '%s'",
-                      full_path.get(), name.get());
+                      full_path.get(), name);
             directories.emplace_back(full_path.get());
         }
 
@@ -538,20 +514,18 @@ static bool do_import(JSContext* cx, JS::HandleObject obj, JS::HandleId id) {
             continue;
 
         // Third, if it's not a directory, try importing a file
-        file = g_file_get_child(directory, filename.get());
-        bool exists = g_file_query_exists(file, nullptr);
-
-        if (!exists) {
-            Gjs::AutoChar full_path{g_file_get_parse_name(file)};
-            gjs_debug(GJS_DEBUG_IMPORTER,
-                      "JS import '%s' not found in %s at %s", name.get(),
-                      dirname.get(), full_path.get());
+        if (dir_cache.child_type(dirname.get(), filename) ==
+            G_FILE_TYPE_UNKNOWN) {
+            gjs_debug(GJS_DEBUG_IMPORTER, "JS import '%s' not found in %s",
+                      name, dirname.get());
             continue;
         }
 
-        if (import_file_on_module(cx, obj, id, name.get(), file)) {
+        Gjs::AutoUnref<GFile> file{g_file_get_child(directory, filename)};
+        if (import_file_on_module(cx, obj, id, name, file)) {
             gjs_debug(GJS_DEBUG_IMPORTER, "successfully imported module '%s'",
-                      name.get());
+                      name);
+            *found = true;
             return true;
         }
 
@@ -563,14 +537,105 @@ static bool do_import(JSContext* cx, JS::HandleObject obj, JS::HandleId id) {
     }
 
     if (!directories.empty()) {
-        if (!import_directory(cx, obj, name.get(), directories))
+        if (!import_directory(cx, obj, name, directories))
             return false;
 
         gjs_debug(GJS_DEBUG_IMPORTER, "successfully imported directory '%s'",
+                  name);
+        *found = true;
+    }
+
+    return true;
+}
+
+// Properties that are looked up on arbitrary objects, for example by await or
+// JSON.stringify(), are not worth refreshing the search path for when they are
+// not found. Neither are names that can't be a file in a directory.
+[[nodiscard]]
+static bool may_be_module_name(const char* name) {
+    static const char* const probed_names[] = {"then", "toJSON", "constructor"};
+    for (const char* probed : probed_names) {
+        if (strcmp(name, probed) == 0)
+            return false;
+    }
+    return name[0] != '.' && !strchr(name, '/');
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool do_import(JSContext* cx, JS::HandleObject obj, JS::HandleId id) {
+    JS::RootedObject search_path{cx};
+    const GjsAtoms& atoms = GjsContextPrivate::atoms(cx);
+
+    if (!gjs_object_require_property(cx, obj, "importer", atoms.search_path(),
+                                     &search_path))
+        return false;
+
+    bool is_array;
+    if (!JS::IsArrayObject(cx, search_path, &is_array))
+        return false;
+    if (!is_array) {
+        gjs_throw(cx, "searchPath property on importer is not an array");
+        return false;
+    }
+
+    uint32_t search_path_len;
+    if (!JS::GetArrayLength(cx, search_path, &search_path_len)) {
+        gjs_throw(cx, "searchPath array has no length");
+        return false;
+    }
+
+    JS::UniqueChars name;
+    if (!gjs_get_string_id(cx, id, &name))
+        return false;
+    if (!name) {
+        gjs_throw(cx, "Importing invalid module name");
+        return false;
+    }
+
+    // null if this is the root importer
+    JS::RootedValue parent{cx};
+    if (!JS_GetPropertyById(cx, obj, atoms.parent_module(), &parent))
+        return false;
+
+    // First try importing an internal module like gi
+    if (parent.isNull() &&
+        Gjs::NativeModuleDefineFuncs::get().is_registered(name.get())) {
+        if (!gjs_import_native_module(cx, obj, name.get()))
+            return false;
+
+        gjs_debug(GJS_DEBUG_IMPORTER, "successfully imported module '%s'",
                   name.get());
         return true;
     }
 
+    bool found;
+    std::vector<std::string> searched_dirnames;
+    if (!import_from_search_path(cx, obj, id, name.get(), search_path,
+                                 search_path_len, &found, &searched_dirnames))
+        return false;
+    if (found)
+        return true;
+
+    // The cached directory listings may be out of date, if the module was added
+    // after they were made. Refresh the ones that changed and try once more
+    // before giving up.
+    if (may_be_module_name(name.get())) {
+        Gjs::DirectoryCache& dir_cache =
+            GjsContextPrivate::from_cx(cx)->directory_cache();
+        bool changed = false;
+        for (const std::string& dirname : searched_dirnames)
+            changed = dir_cache.refresh(dirname) || changed;
+        searched_dirnames.clear();
+
+        if (changed &&
+            !import_from_search_path(cx, obj, id, name.get(), search_path,
+                                     search_path_len, &found,
+                                     &searched_dirnames))
+            return false;
+        if (found)
+            return true;
+    }
+
     /* If no exception occurred, the problem is just that we got to the end of
      * the path. Be sure an exception is set. */
     g_assert(!JS_IsExceptionPending(cx));
@@ -632,35 +697,30 @@ static bool importer_new_enumerate(JSContext* cx, JS::HandleObject object,
             g_file_new_for_commandline_arg(dirname.get())};
         Gjs::AutoUnref<GFile> file{
             g_file_get_child(directory, MODULE_INIT_FILENAME)};
-
-        if (!load_module_elements(cx, object, properties, file))
+        Gjs::DirectoryCache& dir_cache =
+            GjsContextPrivate::from_cx(cx)->directory_cache();
+        bool init_js_exists = dir_cache.child_type(dirname.get(),
+                                                   MODULE_INIT_FILENAME) !=
+                              G_FILE_TYPE_UNKNOWN;
+
+        if (!load_module_elements(cx, object, properties, file,
+                                  init_js_exists))
             return false;
 
-        // new_for_commandline_arg handles resource:/// paths
-        Gjs::AutoUnref<GFileEnumerator> direnum{g_file_enumerate_children(
-            directory, "standard::name,standard::type", G_FILE_QUERY_INFO_NONE,
-            nullptr, nullptr)};
-
-        while (true) {
-            GFileInfo* info;
-            GFile* file;
-            if (!direnum || !g_file_enumerator_iterate(direnum, &info, &file,
-                                                       nullptr, nullptr))
-                break;
-            if (info == nullptr || file == nullptr)
-                break;
-
-            Gjs::AutoChar filename{g_file_get_basename(file)};
+        Gjs::DirectoryCache::Entries children =
+            dir_cache.children(dirname.get());
+        for (const auto& [child_name, type] : children) {
+            const char* filename = child_name.c_str();
 
             // skip hidden files and directories (.svn, .git, ...)
-            if (filename.get()[0] == '.')
+            if (filename[0] == '.')
                 continue;
 
             // skip module init file
             if (strcmp(filename, MODULE_INIT_FILENAME) == 0)
                 continue;
 
-            if (g_file_info_get_file_type(info) == G_FILE_TYPE_DIRECTORY) {
+            if (type == G_FILE_TYPE_DIRECTORY) {
                 jsid id = gjs_intern_string_to_id(cx, filename);
                 if (id.isVoid())
                     return false;
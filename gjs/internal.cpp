@@ -4,9 +4,11 @@
 #include <config.h>
 
 #include <stddef.h>  // for size_t
+#include <stdint.h>
 #include <string.h>
 
 #include <memory>  // for unique_ptr
+#include <string>
 
 #include <gio/gio.h>
 #include <glib-object.h>
@@ -33,17 +35,20 @@
 #include <js/ValueArray.h>
 #include <jsapi.h>        // for JS_NewPlainObject, JS_ObjectIsFunction
 #include <jsfriendapi.h>  // for JS_GetObjectFunction, SetFunctionNativeReserved
+#include <mozilla/Maybe.h>
 
 #include "gjs/auto.h"
 #include "gjs/context-private.h"
 #include "gjs/engine.h"
 #include "gjs/gerror-result.h"
 #include "gjs/global.h"
+#include "gjs/import-timing.h"
 #include "gjs/internal.h"
 #include "gjs/jsapi-util-args.h"
 #include "gjs/jsapi-util.h"
 #include "gjs/macros.h"
 #include "gjs/module.h"
+#include "gjs/resolution-cache.h"
 #include "util/log.h"
 #include "util/misc.h"
 
@@ -75,8 +80,11 @@ bool gjs_load_internal_module(JSContext* cx, const char* identifier) {
 
     Gjs::AutoChar script;
     size_t script_len;
-    if (!gjs_load_internal_source(cx, full_path, script.out(), &script_len))
-        return false;
+    {
+        Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::FETCH, full_path};
+        if (!gjs_load_internal_source(cx, full_path, script.out(), &script_len))
+            return false;
+    }
 
     JS::SourceText<mozilla::Utf8Unit> buf;
     if (!buf.init(cx, script.get(), script_len, JS::SourceOwnership::Borrowed))
@@ -90,9 +98,13 @@ bool gjs_load_internal_module(JSContext* cx, const char* identifier) {
     Gjs::AutoInternalRealm ar{cx};
     GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
     JS::RootedObject internal_global{cx, gjs->internal_global()};
-    JS::RootedObject module{cx, JS::CompileModule(cx, options, buf)};
-    if (!module)
-        return false;
+    JS::RootedObject module{cx};
+    {
+        Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::COMPILE, full_path};
+        module = JS::CompileModule(cx, options, buf);
+        if (!module)
+            return false;
+    }
 
     JS::RootedObject registry{cx, gjs_get_module_registry(internal_global)};
 
@@ -100,10 +112,18 @@ bool gjs_load_internal_module(JSContext* cx, const char* identifier) {
     if (key.isVoid())
         return false;
 
+    if (!gjs_global_registry_set(cx, registry, key, module))
+        return false;
+
+    {
+        Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::LINK, full_path};
+        if (!JS::ModuleLink(cx, module))
+            return false;
+    }
+
+    Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::EVALUATE, full_path};
     JS::RootedValue ignore{cx};
-    return gjs_global_registry_set(cx, registry, key, module) &&
-           JS::ModuleLink(cx, module) &&
-           JS::ModuleEvaluate(cx, module, &ignore);
+    return JS::ModuleEvaluate(cx, module, &ignore);
 }
 
 static bool handle_wrong_args(JSContext* cx) {
@@ -155,6 +175,8 @@ bool gjs_internal_set_global_module_loader(JSContext* cx, unsigned argc,
 static bool compile_module(JSContext* cx, const JS::UniqueChars& uri,
                            JS::HandleString source,
                            JS::MutableHandleValue v_module_out) {
+    Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::COMPILE, uri.get()};
+
     JS::CompileOptions options(cx);
     options.setFileAndLine(uri.get(), 1).setSourceIsLazy(false);
 
@@ -437,8 +459,16 @@ bool gjs_internal_resolve_relative_resource_or_file(JSContext* cx,
                              "uri", &uri, "relativePath", &relative_path))
         return handle_wrong_args(cx);
 
+    Gjs::ResolutionCache& cache =
+        GjsContextPrivate::from_cx(cx)->resolution_cache();
+    if (const std::string* cached =
+            cache.lookup_relative(uri.get(), relative_path.get()))
+        return gjs_uri_object(cx, cached->c_str(), args.rval());
+
     Gjs::AutoChar output_uri{g_uri_resolve_relative(
         uri.get(), relative_path.get(), G_URI_FLAGS_NONE, nullptr)};
+    if (output_uri)
+        cache.store_relative(uri.get(), relative_path.get(), output_uri);
 
     return gjs_uri_object(cx, output_uri.get(), args.rval());
 }
@@ -450,6 +480,7 @@ bool gjs_internal_load_resource_or_file(JSContext* cx, unsigned argc,
     if (!gjs_parse_call_args(cx, "loadResourceOrFile", args, "s", "uri", &uri))
         return handle_wrong_args(cx);
 
+    Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::FETCH, uri.get()};
     Gjs::AutoUnref<GFile> file{g_file_new_for_uri(uri.get())};
 
     char* contents;
@@ -482,9 +513,42 @@ bool gjs_internal_uri_exists(JSContext* cx, unsigned argc, JS::Value* vp) {
     if (!gjs_parse_call_args(cx, "uriExists", args, "!s", "uri", &uri))
         return handle_wrong_args(cx);
 
+    // Missing files are cached too; most lookups of bare specifiers will miss
+    // in all but one of the module search path entries
+    Gjs::ResolutionCache& cache =
+        GjsContextPrivate::from_cx(cx)->resolution_cache();
+    mozilla::Maybe<bool> cached = cache.lookup_exists(uri.get());
+    if (cached) {
+        args.rval().setBoolean(*cached);
+        return true;
+    }
+
     Gjs::AutoUnref<GFile> file{g_file_new_for_uri(uri.get())};
+    bool exists = g_file_query_exists(file, nullptr);
+    cache.store_exists(uri.get(), exists);
 
-    args.rval().setBoolean(g_file_query_exists(file, nullptr));
+    args.rval().setBoolean(exists);
+    return true;
+}
+
+/**
+ * gjs_internal_clear_resolution_cache:
+ *
+ * JS function exposed as `clearResolutionCache` in the internal global scope.
+ *
+ * Forgets all cached module specifier resolutions and URI existence checks.
+ * Called when the module search path changes.
+ *
+ * Returns: JS undefined
+ */
+bool gjs_internal_clear_resolution_cache(JSContext* cx, unsigned argc,
+                                         JS::Value* vp) {
+    JS::CallArgs args = CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "clearResolutionCache", args, ""))
+        return handle_wrong_args(cx);
+
+    GjsContextPrivate::from_cx(cx)->resolution_cache().clear();
+    args.rval().setUndefined();
     return true;
 }
 
@@ -511,6 +575,8 @@ bool gjs_internal_atob(JSContext* cx, unsigned argc, JS::Value* vp) {
 class PromiseData {
  public:
     JSContext* cx;
+    // For import timings
+    int64_t begin_time;
 
  private:
     JS::PersistentRooted<JSFunction*> m_resolve;
@@ -522,7 +588,10 @@ class PromiseData {
  public:
     explicit PromiseData(JSContext* a_cx, JSFunction* resolve,
                          JSFunction* reject)
-        : cx(a_cx), m_resolve(cx, resolve), m_reject(cx, reject) {}
+        : cx(a_cx),
+          begin_time(g_get_monotonic_time()),
+          m_resolve(cx, resolve),
+          m_reject(cx, reject) {}
 
     static PromiseData* from_ptr(void* ptr) {
         return static_cast<PromiseData*>(ptr);
@@ -561,12 +630,15 @@ static void load_async_callback(GObject* file, GAsyncResult* res, void* data) {
 
     Gjs::AutoMainRealm ar{gjs};
 
+    Gjs::AutoChar uri{g_file_get_uri(G_FILE(file))};
+    Gjs::record_import_phase(promise->cx, Gjs::ImportPhase::FETCH, uri,
+                             promise->begin_time);
+
     char* contents;
     size_t length;
     Gjs::AutoError error;
     if (!g_file_load_contents_finish(G_FILE(file), res, &contents, &length,
                                      /* etag_out = */ nullptr, &error)) {
-        Gjs::AutoChar uri{g_file_get_uri(G_FILE(file))};
         gjs_throw_custom(promise->cx, JSEXN_ERR, "ImportError",
                          "Unable to load file async from: %s (%s)", uri.get(),
                          error->message);
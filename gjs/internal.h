@@ -46,5 +46,8 @@ bool gjs_internal_load_resource_or_file_async(JSContext*, unsigned, JS::Value*);
 GJS_JSAPI_RETURN_CONVENTION
 bool gjs_internal_uri_exists(JSContext*, unsigned, JS::Value*);
 
+GJS_JSAPI_RETURN_CONVENTION
+bool gjs_internal_clear_resolution_cache(JSContext*, unsigned, JS::Value*);
+
 GJS_JSAPI_RETURN_CONVENTION
 bool gjs_internal_atob(JSContext*, unsigned, JS::Value*);
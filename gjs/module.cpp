@@ -5,6 +5,7 @@
 #include <config.h>
 
 #include <stddef.h>     // for size_t
+#include <stdint.h>     // for int64_t
 #include <string.h>
 
 #include <string>
@@ -49,12 +50,14 @@
 #include "gjs/deprecation.h"
 #include "gjs/gerror-result.h"
 #include "gjs/global.h"
+#include "gjs/import-timing.h"
 #include "gjs/jsapi-util-args.h"
 #include "gjs/jsapi-util.h"
 #include "gjs/macros.h"
 #include "gjs/mem-private.h"
 #include "gjs/module.h"
 #include "gjs/native.h"
+#include "gjs/resolution-cache.h"
 #include "util/log.h"
 #include "util/misc.h"
 
@@ -127,14 +130,21 @@ class GjsScriptModule {
         if (!priv)
             return false;
 
-        JS::RootedScript script(cx, JS::Compile(cx, options, buf));
-        if (!script)
-            return false;
+        JS::RootedScript script(cx);
+        {
+            Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::COMPILE, uri};
+            script = JS::Compile(cx, options, buf);
+            if (!script)
+                return false;
+        }
 
         JS::SetScriptPrivate(script, JS::ObjectValue(*priv));
-        JS::RootedValue ignored_retval(cx);
-        if (!JS_ExecuteScript(cx, scope_chain, script, &ignored_retval))
-            return false;
+        {
+            Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::EVALUATE, uri};
+            JS::RootedValue ignored_retval(cx);
+            if (!JS_ExecuteScript(cx, scope_chain, script, &ignored_retval))
+                return false;
+        }
 
         GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
         gjs->schedule_gc_if_needed();
@@ -151,14 +161,17 @@ class GjsScriptModule {
         Gjs::AutoError error;
         Gjs::AutoChar script;
         size_t script_len = 0;
+        Gjs::AutoChar uri{g_file_get_uri(file)};
 
-        if (!(g_file_load_contents(file, nullptr, script.out(), &script_len,
-                                   nullptr, &error)))
-            return gjs_throw_gerror_message(cx, error);
+        {
+            Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::FETCH, uri};
+            if (!(g_file_load_contents(file, nullptr, script.out(), &script_len,
+                                       nullptr, &error)))
+                return gjs_throw_gerror_message(cx, error);
+        }
         g_assert(script);
 
         Gjs::AutoChar full_path{g_file_get_parse_name(file)};
-        Gjs::AutoChar uri{g_file_get_uri(file)};
         return evaluate_import(cx, module, script, script_len, full_path, uri);
     }
 
@@ -486,14 +499,47 @@ bool gjs_populate_module_meta(JSContext* cx, JS::HandleValue private_ref,
     return true;
 }
 
+// Returns the URI stored in a module's private object, for import timings. Does
+// not throw; returns an empty string if there is none.
+static std::string module_uri_for_timing(JSContext* cx,
+                                         JS::HandleObject module) {
+    JS::RootedValue v_priv{cx, JS::GetModulePrivate(module)};
+    if (!v_priv.isObject())
+        return {};
+
+    JS::AutoSaveExceptionState saved_exc{cx};
+    JS::RootedObject priv{cx, &v_priv.toObject()};
+    JS::RootedValue v_uri{cx};
+    JS::UniqueChars uri;
+    if (!JS_GetPropertyById(cx, priv, GjsContextPrivate::atoms(cx).uri(),
+                            &v_uri) ||
+        !v_uri.isString() ||
+        !(uri = JS_EncodeStringToUTF8(cx, v_uri.toString())))
+        return {};
+    return uri.get();
+}
+
 // Canonicalize specifier so that differently-spelled specifiers referring to
-// the same module don't result in duplicate entries in the registry
+// the same module don't result in duplicate entries in the registry. The result
+// is cached, since this is done for every import.
 static bool canonicalize_specifier(JSContext* cx,
                                    JS::MutableHandleString specifier) {
     JS::UniqueChars specifier_utf8 = JS_EncodeStringToUTF8(cx, specifier);
     if (!specifier_utf8)
         return false;
 
+    Gjs::ResolutionCache& cache =
+        GjsContextPrivate::from_cx(cx)->resolution_cache();
+    if (const std::string* cached =
+            cache.lookup_canonical(specifier_utf8.get())) {
+        JS::ConstUTF8CharsZ chars{cached->c_str(), cached->size()};
+        JS::RootedString new_specifier{cx, JS_NewStringCopyUTF8Z(cx, chars)};
+        if (!new_specifier)
+            return false;
+        specifier.set(new_specifier);
+        return true;
+    }
+
     Gjs::AutoChar scheme, host, path, query;
     if (!g_uri_split(specifier_utf8.get(), G_URI_FLAGS_NONE, scheme.out(),
                      nullptr, host.out(), nullptr, path.out(), query.out(),
@@ -518,6 +564,7 @@ static bool canonicalize_specifier(JSContext* cx,
     Gjs::AutoChar canonical_specifier{
         g_uri_join(G_URI_FLAGS_NONE, scheme.get(), nullptr, host.get(), -1,
                    path.get(), query.get(), nullptr)};
+    cache.store_canonical(specifier_utf8.get(), canonical_specifier);
     JS::ConstUTF8CharsZ chars{canonical_specifier, strlen(canonical_specifier)};
     JS::RootedString new_specifier{cx, JS_NewStringCopyUTF8Z(cx, chars)};
     if (!new_specifier)
@@ -567,12 +614,16 @@ JSObject* gjs_module_resolve(JSContext* cx,
               gjs_debug_string(specifier).c_str(),
               gjs_debug_value(importing_module_priv).c_str(), global.get());
 
+    Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::RESOLVE};
     JS::RootedValue result(cx);
     if (!JS::Call(cx, loader, "moduleResolveHook", args, &result))
         return nullptr;
 
     g_assert(result.isObject() && "resolve hook failed to return an object!");
-    return &result.toObject();
+    JS::RootedObject module{cx, &result.toObject()};
+    if (timer.wants_module())
+        timer.set_module(module_uri_for_timing(cx, module));
+    return module;
 }
 
 // Call JS::FinishDynamicModuleImport() with the values stashed in the function.
@@ -621,12 +672,45 @@ static bool fail_import(JSContext* cx, const JS::CallArgs& args) {
     return false;
 }
 
+// Records the time that gjs_dynamic_module_resolve() spent resolving, now that
+// the module is known; under the specifier if resolving failed. Does not throw.
+static void record_dynamic_resolve(JSContext* cx, const JS::CallArgs& args,
+                                   JS::HandleObject module) {
+    JS::Value callback_priv = js::GetFunctionNativeReserved(&args.callee(), 0);
+    JS::RootedObject callback_data{cx, &callback_priv.toObject()};
+
+    JS::AutoSaveExceptionState saved_exc{cx};
+    JS::RootedValue begin_us{cx}, duration_us{cx}, v_specifier{cx};
+    if (!JS_GetProperty(cx, callback_data, "resolve_begin_us", &begin_us) ||
+        !JS_GetProperty(cx, callback_data, "resolve_us", &duration_us) ||
+        !JS_GetProperty(cx, callback_data, "specifier", &v_specifier) ||
+        !begin_us.isNumber() || !duration_us.isNumber())
+        return;
+
+    std::string name;
+    if (module)
+        name = module_uri_for_timing(cx, module);
+    if (name.empty() && v_specifier.isString()) {
+        JS::UniqueChars specifier =
+            JS_EncodeStringToUTF8(cx, v_specifier.toString());
+        if (specifier)
+            name = specifier.get();
+    }
+
+    Gjs::record_import_phase(cx, Gjs::ImportPhase::RESOLVE,
+                             name.empty() ? "<unknown>" : name.c_str(),
+                             static_cast<int64_t>(begin_us.toNumber()),
+                             static_cast<int64_t>(duration_us.toNumber()));
+}
+
 GJS_JSAPI_RETURN_CONVENTION
 static bool import_rejected(JSContext* cx, unsigned argc, JS::Value* vp) {
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
 
     gjs_debug(GJS_DEBUG_IMPORTER, "Async import promise rejected");
 
+    record_dynamic_resolve(cx, args, nullptr);
+
     // Throw the value that the promise is rejected with, so that
     // FinishDynamicModuleImport will reject the internal_promise with it.
     JS_SetPendingException(cx, args.get(0),
@@ -646,10 +730,32 @@ static bool import_resolved(JSContext* cx, unsigned argc, JS::Value* vp) {
     g_assert(args[0].isObject());
     JS::RootedObject module(cx, &args[0].toObject());
 
+    record_dynamic_resolve(cx, args, module);
+
+    // Only looked up if one of the timers records it
+    std::string uri;
+
+    {
+        Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::LINK};
+        if (timer.wants_module()) {
+            uri = module_uri_for_timing(cx, module);
+            timer.set_module(uri.c_str());
+        }
+        if (!JS::ModuleLink(cx, module))
+            return fail_import(cx, args);
+    }
+
     JS::RootedValue evaluation_promise(cx);
-    if (!JS::ModuleLink(cx, module) ||
-        !JS::ModuleEvaluate(cx, module, &evaluation_promise))
-        return fail_import(cx, args);
+    {
+        Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::EVALUATE};
+        if (timer.wants_module()) {
+            if (uri.empty())
+                uri = module_uri_for_timing(cx, module);
+            timer.set_module(uri.c_str());
+        }
+        if (!JS::ModuleEvaluate(cx, module, &evaluation_promise))
+            return fail_import(cx, args);
+    }
 
     g_assert(evaluation_promise.isObject() &&
              "got weird value from JS::ModuleEvaluate");
@@ -706,11 +812,34 @@ bool gjs_dynamic_module_resolve(JSContext* cx,
     args[0].set(importing_module_priv);
     args[1].setString(specifier);
 
+    Gjs::AutoImportTimer timer{cx, Gjs::ImportPhase::RESOLVE};
+    if (timer.wants_module()) {
+        JS::UniqueChars specifier_utf8 = JS_EncodeStringToUTF8(cx, specifier);
+        if (!specifier_utf8)
+            return false;
+        timer.set_module(specifier_utf8.get());
+    }
+
     JS::RootedValue result(cx);
     if (!JS::Call(cx, loader, "moduleResolveAsyncHook", args, &result))
         return JS::FinishDynamicModuleImport(cx, nullptr, importing_module_priv,
                                              module_request, internal_promise);
 
+    // Like the other phases, resolving is recorded under the resolved URI,
+    // which is only known once the promise settles
+    if (timer.active()) {
+        timer.defer();
+        if (!JS_DefineProperty(cx, callback_data, "resolve_begin_us",
+                               static_cast<double>(timer.begin_us()),
+                               JSPROP_PERMANENT) ||
+            !JS_DefineProperty(cx, callback_data, "resolve_us",
+                               static_cast<double>(timer.elapsed_us()),
+                               JSPROP_PERMANENT) ||
+            !JS_DefineProperty(cx, callback_data, "specifier", specifier,
+                               JSPROP_PERMANENT))
+            return false;
+    }
+
     // Release in finish_import
     GjsContextPrivate* priv = GjsContextPrivate::from_cx(cx);
     priv->main_loop_hold();
@@ -0,0 +1,450 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>  // for ENABLE_PROFILER
+
+#include <errno.h>
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+#include <string.h>  // for strcmp, strstr
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>  // for move
+#include <vector>
+
+#include <glib.h>
+
+#ifdef ENABLE_PROFILER
+#    include <sysprof-capture.h>
+#endif
+
+#include "gjs/auto.h"
+#include "gjs/gerror-result.h"
+#include "gjs/profiler-gecko.h"
+
+/* The Gecko profile format is what Firefox's built-in profiler produces. It is
+ * documented along with the processed format that the Firefox Profiler converts
+ * it into, in the docs-developer directory of
+ * https://github.com/firefox-devtools/profiler. Tables are written as a schema,
+ * mapping column names to indices, and an array of rows, and all strings of a
+ * thread are kept in a string table. */
+
+namespace Gjs {
+
+#ifdef ENABLE_PROFILER
+
+// Must match the "categories" array in the profile's meta object
+enum GeckoCategory : unsigned { OTHER, JAVASCRIPT, GJS, GC };
+
+static constexpr unsigned GECKO_PROFILE_VERSION = 27;
+
+static void append_json_string(std::string* out, const char* str) {
+    AutoChar valid;
+    if (!g_utf8_validate(str, -1, nullptr)) {
+        valid = g_utf8_make_valid(str, -1);
+        str = valid;
+    }
+
+    out->push_back('"');
+    for (const char* p = str; *p; p++) {
+        unsigned char c = *p;
+        if (c == '"' || c == '\\') {
+            out->push_back('\\');
+            out->push_back(c);
+        } else if (c < 0x20) {
+            char escape[8];
+            g_snprintf(escape, sizeof escape, "\\u%04x", c);
+            out->append(escape);
+        } else {
+            out->push_back(c);
+        }
+    }
+    out->push_back('"');
+}
+
+static void append_ms(std::string* out, double ms) {
+    char buf[G_ASCII_DTOSTR_BUF_SIZE];
+    out->append(g_ascii_formatd(buf, sizeof buf, "%.3f", ms));
+}
+
+class GeckoProfileBuilder {
+    struct Sample {
+        int64_t time;
+        int stack;  // -1 for an empty stack
+    };
+
+    struct Marker {
+        int64_t time;
+        int64_t duration;
+        unsigned name;  // in the string table
+        GeckoCategory category;
+        std::string group;
+        std::string message;
+    };
+
+    struct Counter {
+        std::string category;
+        std::string name;
+        std::string description;
+        int64_t last_value = 0;
+        std::vector<std::pair<int64_t, int64_t>> samples;  // time, change
+    };
+
+    int64_t m_start_time;
+    std::chrono::microseconds m_interval;
+    int32_t m_pid = 0;
+    int32_t m_tid = 0;
+
+    std::vector<std::string> m_strings;
+    std::unordered_map<std::string, unsigned> m_string_indices;
+    std::unordered_map<SysprofCaptureAddress, std::string> m_jitmap;
+    // Frames are identified by their string, and stacks by prefix and frame
+    std::vector<std::pair<unsigned, GeckoCategory>> m_frames;
+    std::unordered_map<unsigned, unsigned> m_frame_indices;
+    std::vector<std::pair<int, unsigned>> m_stacks;
+    std::unordered_map<uint64_t, unsigned> m_stack_indices;
+    std::vector<Sample> m_samples;
+    std::vector<Marker> m_markers;
+    std::unordered_map<unsigned, Counter> m_counters;
+    std::vector<unsigned> m_counter_order;
+
+    unsigned intern(const std::string& str) {
+        auto [it, inserted] = m_string_indices.emplace(str, m_strings.size());
+        if (inserted)
+            m_strings.push_back(str);
+        return it->second;
+    }
+
+    unsigned frame(const std::string& location) {
+        unsigned string = intern(location);
+        auto [it, inserted] = m_frame_indices.emplace(string, m_frames.size());
+        if (inserted) {
+            // JS frames look like "name (file:line:column)", which is also what
+            // the Firefox Profiler looks for to find their source
+            bool is_js = !location.empty() && location.back() == ')' &&
+                         location.find(" (") != std::string::npos;
+            m_frames.emplace_back(string, is_js ? JAVASCRIPT : GJS);
+        }
+        return it->second;
+    }
+
+    unsigned stack(int prefix, unsigned frame) {
+        uint64_t key = (uint64_t(prefix + 1) << 32) | frame;
+        auto [it, inserted] = m_stack_indices.emplace(key, m_stacks.size());
+        if (inserted)
+            m_stacks.emplace_back(prefix, frame);
+        return it->second;
+    }
+
+    [[nodiscard]]
+    double ms_since_start(int64_t time) const {
+        return (time - m_start_time) / 1e6;
+    }
+
+    void write_meta(std::string* out, double start_time) const;
+    void write_thread(std::string* out) const;
+    void write_counters(std::string* out) const;
+
+ public:
+    GeckoProfileBuilder(int64_t start_time, std::chrono::microseconds interval)
+        : m_start_time(start_time), m_interval(interval) {}
+
+    void add_jitmap(const SysprofCaptureJitmap*);
+    void add_sample(const SysprofCaptureSample*);
+    void add_mark(const SysprofCaptureMark*);
+    void define_counters(const SysprofCaptureCounterDefine*);
+    void set_counters(const SysprofCaptureCounterSet*);
+
+    [[nodiscard]] std::string build(double start_time) const;
+};
+
+void GeckoProfileBuilder::add_jitmap(const SysprofCaptureJitmap* jitmap) {
+    SysprofCaptureJitmapIter iter;
+    SysprofCaptureAddress address;
+    const char* name;
+
+    sysprof_capture_jitmap_iter_init(&iter, jitmap);
+    while (sysprof_capture_jitmap_iter_next(&iter, &address, &name))
+        m_jitmap.emplace(address, name);
+}
+
+void GeckoProfileBuilder::add_sample(const SysprofCaptureSample* sample) {
+    m_pid = sample->frame.pid;
+    m_tid = sample->tid;
+
+    // Addresses go from the innermost frame outwards. Frames without a jitmap
+    // entry are unlabelled native frames that GJS writes as a stack address.
+    int prefix = -1;
+    for (unsigned ix = sample->n_addrs; ix-- > 0;) {
+        auto it = m_jitmap.find(sample->addrs[ix]);
+        if (it != m_jitmap.end())
+            prefix = stack(prefix, frame(it->second));
+    }
+
+    m_samples.push_back({sample->frame.time, prefix});
+}
+
+void GeckoProfileBuilder::add_mark(const SysprofCaptureMark* mark) {
+    GeckoCategory category = OTHER;
+    if (strcmp(mark->group, "GJS") == 0 &&
+        (strcmp(mark->name, "Garbage collection") == 0 ||
+         strstr(mark->name, "weep")))  // "Sweep" or "Group sweep"
+        category = GC;
+
+    m_markers.push_back({mark->frame.time, mark->duration, intern(mark->name),
+                         category, mark->group, mark->message});
+}
+
+void GeckoProfileBuilder::define_counters(
+    const SysprofCaptureCounterDefine* define) {
+    for (unsigned ix = 0; ix < define->n_counters; ix++) {
+        const SysprofCaptureCounter& counter = define->counters[ix];
+        unsigned id = counter.id;
+        auto [it, inserted] = m_counters.emplace(
+            id, Counter{counter.category, counter.name, counter.description});
+        if (inserted)
+            m_counter_order.push_back(id);
+    }
+}
+
+void GeckoProfileBuilder::set_counters(const SysprofCaptureCounterSet* set) {
+    for (unsigned group = 0; group < set->n_values; group++) {
+        const SysprofCaptureCounterValues& values = set->values[group];
+        for (unsigned ix = 0; ix < G_N_ELEMENTS(values.ids); ix++) {
+            auto it = m_counters.find(values.ids[ix]);
+            if (values.ids[ix] == 0 || it == m_counters.end())
+                continue;
+
+            // Gecko counters record changes, which the Firefox Profiler adds up
+            Counter& counter = it->second;
+            int64_t value = values.values[ix].v64;
+            counter.samples.emplace_back(set->frame.time,
+                                         value - counter.last_value);
+            counter.last_value = value;
+        }
+    }
+}
+
+void GeckoProfileBuilder::write_meta(std::string* out,
+                                     double start_time) const {
+    out->append("{\"version\":" + std::to_string(GECKO_PROFILE_VERSION));
+    out->append(",\"startTime\":");
+    append_ms(out, start_time);
+    out->append(",\"shutdownTime\":null,\"interval\":");
+    append_ms(out, m_interval.count() / 1000.0);
+    out->append(
+        ",\"processType\":0,\"product\":\"GJS\",\"stackwalk\":0,\"debug\":0,"
+        "\"gcpoison\":0,\"asyncstack\":0,\"presymbolicated\":true,"
+        "\"categories\":["
+        "{\"name\":\"Other\",\"color\":\"grey\",\"subcategories\":[\"Other\"]},"
+        "{\"name\":\"JavaScript\",\"color\":\"yellow\","
+        "\"subcategories\":[\"Other\"]},"
+        "{\"name\":\"GJS\",\"color\":\"blue\",\"subcategories\":[\"Other\"]},"
+        "{\"name\":\"GC / CC\",\"color\":\"orange\","
+        "\"subcategories\":[\"Other\"]}],"
+        "\"markerSchema\":[{\"name\":\"GJS\","
+        "\"display\":[\"marker-chart\",\"marker-table\","
+        "\"timeline-overview\"],\"data\":["
+        "{\"key\":\"group\",\"label\":\"Group\",\"format\":\"string\"},"
+        "{\"key\":\"message\",\"label\":\"Message\","
+        "\"format\":\"string\"}]}]}");
+}
+
+void GeckoProfileBuilder::write_thread(std::string* out) const {
+    out->append(
+        "{\"name\":\"GeckoMain\",\"processType\":\"default\","
+        "\"processName\":\"gjs\",\"registerTime\":0,\"unregisterTime\":null,"
+        "\"pid\":" +
+        std::to_string(m_pid) + ",\"tid\":" + std::to_string(m_tid));
+
+    out->append(
+        ",\"samples\":{\"schema\":{\"stack\":0,\"time\":1,\"eventDelay\":2},"
+        "\"data\":[");
+    for (size_t ix = 0; ix < m_samples.size(); ix++) {
+        const Sample& sample = m_samples[ix];
+        out->append(ix ? ",[" : "[");
+        out->append(sample.stack < 0 ? "null" : std::to_string(sample.stack));
+        out->push_back(',');
+        append_ms(out, ms_since_start(sample.time));
+        out->append(",0]");
+    }
+
+    out->append(
+        "]},\"markers\":{\"schema\":{\"name\":0,\"startTime\":1,\"endTime\":2,"
+        "\"phase\":3,\"category\":4,\"data\":5},\"data\":[");
+    for (size_t ix = 0; ix < m_markers.size(); ix++) {
+        const Marker& marker = m_markers[ix];
+        out->append(ix ? ",[" : "[");
+        out->append(std::to_string(marker.name) + ',');
+        append_ms(out, ms_since_start(marker.time));
+        out->push_back(',');
+        append_ms(out, ms_since_start(marker.time + marker.duration));
+        // Phase 1 is an interval
+        out->append(",1," + std::to_string(marker.category) +
+                    ",{\"type\":\"GJS\",\"group\":");
+        append_json_string(out, marker.group.c_str());
+        out->append(",\"message\":");
+        append_json_string(out, marker.message.c_str());
+        out->append("}]");
+    }
+
+    out->append(
+        "]},\"stackTable\":{\"schema\":{\"prefix\":0,\"frame\":1},\"data\":[");
+    for (size_t ix = 0; ix < m_stacks.size(); ix++) {
+        auto [prefix, frame] = m_stacks[ix];
+        out->append(ix ? ",[" : "[");
+        out->append(prefix < 0 ? "null" : std::to_string(prefix));
+        out->append("," + std::to_string(frame) + "]");
+    }
+
+    out->append(
+        "]},\"frameTable\":{\"schema\":{\"location\":0,\"relevantForJS\":1,"
+        "\"innerWindowID\":2,\"implementation\":3,\"line\":4,\"column\":5,"
+        "\"category\":6,\"subcategory\":7},\"data\":[");
+    for (size_t ix = 0; ix < m_frames.size(); ix++) {
+        auto [location, category] = m_frames[ix];
+        out->append(ix ? ",[" : "[");
+        out->append(std::to_string(location) + ",false,0,null,null,null," +
+                    std::to_string(category) + ",0]");
+    }
+
+    out->append("]},\"stringTable\":[");
+    for (size_t ix = 0; ix < m_strings.size(); ix++) {
+        if (ix)
+            out->push_back(',');
+        append_json_string(out, m_strings[ix].c_str());
+    }
+    out->append("]}");
+}
+
+void GeckoProfileBuilder::write_counters(std::string* out) const {
+    bool first = true;
+    for (unsigned id : m_counter_order) {
+        const Counter& counter = m_counters.at(id);
+        if (counter.samples.empty())
+            continue;
+
+        out->append(first ? "{\"name\":" : ",{\"name\":");
+        first = false;
+        append_json_string(out, counter.name.c_str());
+        out->append(",\"category\":");
+        append_json_string(out, counter.category.c_str());
+        out->append(",\"description\":");
+        append_json_string(out, counter.description.c_str());
+        out->append(
+            ",\"sample_groups\":[{\"id\":0,\"samples\":{\"schema\":"
+            "{\"time\":0,\"count\":1,\"number\":2},\"data\":[");
+        for (size_t ix = 0; ix < counter.samples.size(); ix++) {
+            auto [time, change] = counter.samples[ix];
+            out->append(ix ? ",[" : "[");
+            append_ms(out, ms_since_start(time));
+            out->append("," + std::to_string(change) + ",0]");
+        }
+        out->append("]}}]}");
+    }
+}
+
+std::string GeckoProfileBuilder::build(double start_time) const {
+    std::string out{"{\"meta\":"};
+    write_meta(&out, start_time);
+    out.append(
+        ",\"libs\":[],\"pausedRanges\":[],\"processes\":[],\"threads\":[");
+    write_thread(&out);
+    out.append("],\"counters\":[");
+    write_counters(&out);
+    out.append("]}\n");
+    return out;
+}
+
+bool write_gecko_profile(const char* capture_path, const char* output_path,
+                         std::chrono::microseconds interval) {
+    AutoPointer<SysprofCaptureReader, SysprofCaptureReader,
+                sysprof_capture_reader_unref>
+        reader{sysprof_capture_reader_new(capture_path)};
+    if (!reader) {
+        g_warning("Failed to read profile capture %s: %s", capture_path,
+                  g_strerror(errno));
+        return false;
+    }
+
+    GeckoProfileBuilder builder{sysprof_capture_reader_get_start_time(reader),
+                                interval};
+
+    SysprofCaptureFrameType type;
+    while (sysprof_capture_reader_peek_type(reader, &type)) {
+        bool ok;
+        switch (type) {
+            case SYSPROF_CAPTURE_FRAME_JITMAP: {
+                auto* jitmap = sysprof_capture_reader_read_jitmap(reader);
+                if ((ok = jitmap != nullptr))
+                    builder.add_jitmap(jitmap);
+                break;
+            }
+            case SYSPROF_CAPTURE_FRAME_SAMPLE: {
+                auto* sample = sysprof_capture_reader_read_sample(reader);
+                if ((ok = sample != nullptr))
+                    builder.add_sample(sample);
+                break;
+            }
+            case SYSPROF_CAPTURE_FRAME_MARK: {
+                auto* mark = sysprof_capture_reader_read_mark(reader);
+                if ((ok = mark != nullptr))
+                    builder.add_mark(mark);
+                break;
+            }
+            case SYSPROF_CAPTURE_FRAME_CTRDEF: {
+                auto* define =
+                    sysprof_capture_reader_read_counter_define(reader);
+                if ((ok = define != nullptr))
+                    builder.define_counters(define);
+                break;
+            }
+            case SYSPROF_CAPTURE_FRAME_CTRSET: {
+                auto* set = sysprof_capture_reader_read_counter_set(reader);
+                if ((ok = set != nullptr))
+                    builder.set_counters(set);
+                break;
+            }
+            default:
+                ok = sysprof_capture_reader_skip(reader);
+        }
+
+        if (!ok) {
+            g_warning("Profile capture %s is corrupt", capture_path);
+            return false;
+        }
+    }
+
+    // Wall-clock time of the start of the capture, in ms since the epoch
+    double start_time = g_get_real_time() / 1000.0;
+    AutoPointer<GDateTime, GDateTime, g_date_time_unref> capture_time{
+        g_date_time_new_from_iso8601(sysprof_capture_reader_get_time(reader),
+                                     nullptr)};
+    if (capture_time)
+        start_time = g_date_time_to_unix_usec(capture_time) / 1000.0;
+
+    std::string profile = builder.build(start_time);
+
+    AutoError error;
+    if (!g_file_set_contents(output_path, profile.data(), profile.size(),
+                             &error)) {
+        g_warning("Failed to write profile: %s", error->message);
+        return false;
+    }
+
+    return true;
+}
+
+#else  // !ENABLE_PROFILER
+
+bool write_gecko_profile(const char*, const char*, std::chrono::microseconds) {
+    g_warning("Profiler is disabled. Recompile with it enabled to use.");
+    return false;
+}
+
+#endif  // ENABLE_PROFILER
+
+}  // namespace Gjs
@@ -0,0 +1,27 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <chrono>
+
+namespace Gjs {
+
+/* Converts a capture written by GjsProfiler into the Gecko profile format, for
+ * loading into the Firefox Profiler (https://profiler.firefox.com/). The stack
+ * samples become the samples of one thread, with JS frames and GJS's own frames
+ * in separate categories, the marks become markers, with GC marks in the GC
+ * category, and the counters become counter tracks. `interval` is the sampling
+ * period that the capture was made with.
+ *
+ * Returns false, after logging a warning, if the capture can't be read or the
+ * profile can't be written. Always fails if GJS was built without the
+ * profiler. */
+[[nodiscard]]
+bool write_gecko_profile(const char* capture_path, const char* output_path,
+                         std::chrono::microseconds interval);
+
+}  // namespace Gjs
@@ -6,11 +6,15 @@
 
 #include <config.h>
 
+#include <stddef.h>  // for size_t
 #include <stdint.h>
 
 #include <chrono>
 #include <ratio>  // for nano
 #include <string>
+#include <utility>  // for forward
+
+#include <glib-object.h>
 
 #include <js/GCAPI.h>  // for JSFinalizeStatus, JSGCStatus, GCReason
 #include <js/ProfilingCategory.h>
@@ -22,20 +26,60 @@
 #include "gjs/profiler.h"
 #include "util/misc.h"
 
-#define GJS_PROFILER_DYNAMIC_STRING(cx, str) \
-    js::GetContextProfilingStackIfEnabled(cx) ? (str) : ""
+namespace Gjs {
+
+/* Labels for the profiling stack are built once for each GI class member and
+ * kept for the life of the thread, so that labelling a call does not format a
+ * new string every time. Because the pointers stay valid, the sampler can also
+ * recognize labels that it has already written to the capture.
+ *
+ * A label is identified by a GType and two pointers, typically a static string
+ * for the kind of member and the member's name from the typelib or GParamSpec,
+ * which must all stay valid for the life of the program. */
+struct ProfilerLabelKey {
+    GType gtype;
+    const void* kind;
+    const void* member;
+
+    bool operator==(const ProfilerLabelKey& other) const {
+        return gtype == other.gtype && kind == other.kind &&
+               member == other.member;
+    }
+};
+
+[[nodiscard]] const char** profiler_label_slot(const ProfilerLabelKey&);
+[[nodiscard]] const char* intern_profiler_label(std::string&& label);
+
+// Returns the label for `key`, calling `format()` to build it the first time,
+// or "" without doing anything if the profiler is not recording
+template <typename F>
+[[nodiscard]] const char* profiler_label(JSContext* cx,
+                                         const ProfilerLabelKey& key,
+                                         F&& format) {
+    if (!js::GetContextProfilingStackIfEnabled(cx))
+        return "";
+
+    const char** slot = profiler_label_slot(key);
+    if (!*slot)
+        *slot = intern_profiler_label(std::forward<F>(format)());
+    return *slot;
+}
+
+}  // namespace Gjs
 
 class AutoProfilerLabel {
  public:
+    // dynamicString must stay valid for the life of the thread; use a label
+    // from Gjs::profiler_label()
     explicit AutoProfilerLabel(JSContext* cx, const char* label,
-                               const std::string& dynamicString,
+                               const char* dynamicString,
                                JS::ProfilingCategoryPair categoryPair =
                                    JS::ProfilingCategoryPair::OTHER,
                                uint32_t flags = 0)
         : m_stack(js::GetContextProfilingStackIfEnabled(cx)) {
         if (m_stack)
-            m_stack->pushLabelFrame(label, dynamicString.c_str(), this,
-                                    categoryPair, flags);
+            m_stack->pushLabelFrame(label, dynamicString, this, categoryPair,
+                                    flags);
     }
 
     ~AutoProfilerLabel() {
@@ -70,5 +114,42 @@ bool gjs_profiler_sample_gc_memory_info(
 
 void gjs_profiler_setup_signals(GjsProfiler*, GjsContext*);
 
+// Opens /tmp/perf-$PID.map if GJS_PERF_MAP is set
+void gjs_perf_map_init();
+[[nodiscard]] bool gjs_perf_map_is_enabled();
+// Names code at `address` for perf(1); `name` is copied
+void gjs_perf_map_add(const void* address, size_t size, const char* name);
+
+// Sets the interval between samples; the default is 1 ms
+void gjs_profiler_set_sampling_period(GjsProfiler*, std::chrono::microseconds);
+
+// Makes the profiler start a new timestamped capture file every `interval`
+// while running, deleting the oldest so that at most `keep` finished files are
+// left (unless `keep` is 0). With this, SIGUSR2 writes the kept files into one
+// capture instead of stopping the profiler.
+void gjs_profiler_set_rotation(GjsProfiler*, std::chrono::seconds interval,
+                               unsigned keep);
+
+/* Allocation sampling, off unless a probability greater than 0 is set before
+ * starting the profiler. SpiderMonkey then records each JS object allocation
+ * with that probability, and GJS records the creation of GObject and boxed
+ * wrappers likewise, each with the JS stack, as sysprof allocation records.
+ * For wrappers, check gjs_profiler_sample_allocation() before building the
+ * label for gjs_profiler_add_allocation(). */
+void gjs_profiler_set_allocation_sampling(GjsProfiler*, double probability);
+[[nodiscard]] bool gjs_profiler_sample_allocation(GjsProfiler*);
+void gjs_profiler_add_allocation(GjsProfiler*, const void* address,
+                                 size_t size, const char* label);
+
+/* Adds an integer counter to the capture, for statistics that are only kept on
+ * demand. Returns a handle for gjs_profiler_set_counter(). The counter is
+ * defined in the current capture, if any, and again in each new capture with
+ * its latest value. The strings are truncated to the capture format's limits,
+ * 32 bytes for the category and name and 52 for the description. */
+[[nodiscard]]
+unsigned gjs_profiler_add_counter(GjsProfiler*, const char* category,
+                                  const char* name, const char* description);
+void gjs_profiler_set_counter(GjsProfiler*, unsigned handle, int64_t value);
+
 void gjs_profiler_set_finalize_status(GjsProfiler*, JSFinalizeStatus);
 void gjs_profiler_set_gc_status(GjsProfiler*, JSGCStatus, JS::GCReason);
@@ -7,24 +7,33 @@
 #    include <signal.h>  // for siginfo_t, sigevent, sigaction, SIGPROF, ...
 #endif
 
+#include <errno.h>
+#include <inttypes.h>  // for PRIxPTR
+#include <stdint.h>
+#include <stdio.h>   // for FILE, fdopen, fprintf, setvbuf, sscanf
+#include <string.h>  // for memcpy, strcmp, strlen
+
+#ifdef HAVE_UNISTD_H
+#    include <fcntl.h>   // for open, O_CREAT, O_EXCL, O_NOFOLLOW, O_CLOEXEC
+#    include <unistd.h>  // for getpid, syscall, unlink, close
+#endif
+
 #ifdef ENABLE_PROFILER
 // IWYU has a weird loop where if this is present, it asks for it to be removed,
 // and if absent, asks for it to be added
 #    include <alloca.h>  // IWYU pragma: keep
-#    include <errno.h>
-#    include <stdint.h>
-#    include <stdio.h>        // for sscanf
-#    include <string.h>       // for memcpy, strlen
 #    include <sys/syscall.h>  // for __NR_gettid
 #    include <sys/types.h>    // for timer_t
 #    include <time.h>         // for size_t, CLOCK_MONOTONIC, itimerspec, ...
-#    ifdef HAVE_UNISTD_H
-#        include <unistd.h>  // for getpid, syscall
-#    endif
 #    include <array>
 #endif
 
 #include <chrono>
+#include <functional>  // for hash
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>  // for move
 
 #ifdef ENABLE_PROFILER
 #    include <algorithm>  // for min
@@ -37,19 +46,23 @@
 #    ifdef G_OS_UNIX
 #        include <glib-unix.h>
 #    endif
+#    include <glib/gstdio.h>  // for g_unlink
 #    include <sysprof-capture.h>
 #endif
 
-#include <js/GCAPI.h>           // for JSFinalizeStatus, JSGCStatus, GCReason
-#include <js/ProfilingStack.h>  // for EnableContextProfilingStack, ...
+#include <js/AllocationRecording.h>  // for EnableRecordingAllocations, ...
+#include <js/GCAPI.h>                // for JSFinalizeStatus, JSGCStatus, ...
+#include <js/ProfilingStack.h>       // for EnableContextProfilingStack, ...
 #include <js/TypeDecls.h>
 #include <mozilla/Atomics.h>  // for ProfilingStack operators
 #include <mozilla/Maybe.h>
 
 #include "gjs/auto.h"
 #include "gjs/context.h"
+#include "gjs/gerror-result.h"
 #include "gjs/jsapi-util.h"  // for gjs_explain_gc_reason
 #include "gjs/mem-private.h"
+#include "gjs/profiler-gecko.h"
 #include "gjs/profiler-private.h"  // IWYU pragma: associated
 #include "gjs/profiler.h"
 #include "util/misc.h"
@@ -88,6 +101,18 @@ using mozilla::Maybe, mozilla::Nothing, mozilla::Some,
 static const std::chrono::seconds FLUSH_DELAY = 3s;
 static const std::chrono::milliseconds SAMPLING_PERIOD = 1ms;
 
+#ifdef ENABLE_PROFILER
+// Must be a power of two
+static constexpr size_t JITMAP_CACHE_SIZE = 1024;
+
+struct JitmapCacheEntry {
+    const char* label;
+    const char* dynamic_string;
+    uint32_t generation;
+    SysprofCaptureAddress address;
+};
+#endif  // ENABLE_PROFILER
+
 // Custom packing for Maybe<ProfilerTimePoint>. We assume that 0 is not a value
 // that comes out of the monotonic clock and so can be used to indicate Nothing
 namespace mozilla::detail {
@@ -134,6 +159,16 @@ struct _GjsProfiler {
     // Cache previous values of counters so that we don't overrun the output
     // with counters that don't change very often
     uint64_t last_counter_values[GJS_N_COUNTERS];
+
+    /* Addresses that the capture writer assigned to the labels of stack
+     * frames, keyed by the label pointers, so that the signal handler doesn't
+     * have to format and look up a string for every frame of every sample.
+     * Only written by the signal handler, or with SIGPROF blocked. The labels
+     * of JS frames belong to their scripts, which can be finalized during GC
+     * and their labels' memory reused, so each GC sweep bumps the generation
+     * and thereby invalidates all entries, as does starting a new capture. */
+    std::array<JitmapCacheEntry, JITMAP_CACHE_SIZE> jitmap_cache;
+    volatile uint32_t jitmap_generation;
 #endif  // ENABLE_PROFILER
 
     // The filename to write to
@@ -145,6 +180,19 @@ struct _GjsProfiler {
 #ifdef ENABLE_PROFILER
     // Our POSIX timer to wakeup SIGPROF
     timer_t timer;
+    std::chrono::microseconds sampling_period;
+
+    /* For continuous profiling: if nonzero, a new capture file is started every
+     * rotation_interval while running, and only the newest rotation_keep
+     * finished files are kept (all of them, if 0). */
+    std::chrono::seconds rotation_interval;
+    unsigned rotation_keep;
+    GSource* rotation;
+    GQueue* segments;  // (element-type filename): capture files, oldest first
+
+    // For the Gecko format, the capture is written to this temporary file and
+    // converted when the profiler stops
+    char* gecko_capture_path;
 
     // Cached copy of our pid
     GPid pid;
@@ -159,14 +207,106 @@ struct _GjsProfiler {
     unsigned sigusr2_id;
     unsigned counter_base;  // index of first GObject memory counter
     unsigned gc_counter_base;  // index of first GC stats counter
+
+    /* Counters added with gjs_profiler_add_counter(), which are defined again
+     * in each new capture. The id of each is the one that the current capture
+     * assigned to it, and the value is its latest value. */
+    GArray* dynamic_counters;  // (element-type SysprofCaptureCounter)
+
+    /* Probability with which each JS object allocation and each creation of a
+     * GObject or boxed wrapper is recorded with its stack, or 0 if allocations
+     * are not sampled */
+    double allocation_probability;
 #endif  // ENABLE_PROFILER
 
     // If we are currently sampling
     unsigned running : 1;
+
+    // If the output should be converted to the Gecko profile format
+    unsigned gecko_format : 1;
 };
 
 static GjsContext* profiling_context;
 
+namespace Gjs {
+
+struct ProfilerLabelKeyHash {
+    size_t operator()(const ProfilerLabelKey& key) const {
+        size_t hash = std::hash<GType>{}(key.gtype);
+        hash = hash * 31 + std::hash<const void*>{}(key.kind);
+        return hash * 31 + std::hash<const void*>{}(key.member);
+    }
+};
+
+// There is only one GjsContext per thread, so these need no locking
+static thread_local std::unordered_map<ProfilerLabelKey, const char*,
+                                       ProfilerLabelKeyHash>
+    label_slots;
+static thread_local std::unordered_set<std::string> labels;
+
+const char** profiler_label_slot(const ProfilerLabelKey& key) {
+    return &label_slots[key];
+}
+
+// Equal labels built for different keys share a pointer
+const char* intern_profiler_label(std::string&& label) {
+    return labels.insert(std::move(label)).first->c_str();
+}
+
+}  // namespace Gjs
+
+/* perf(1) symbolizes code that doesn't belong to any ELF file by looking it up
+ * in /tmp/perf-$PID.map, a text file with one line per symbol giving its start
+ * address and size in hex, and its name. GJS lists the code of its GI callback
+ * trampolines there. Code compiled by SpiderMonkey's JIT goes into a jitdump
+ * file instead, for `perf inject --jit`, if SpiderMonkey was built with perf
+ * support and IONPERF is set. GJS doesn't set IONPERF itself: SpiderMonkey
+ * reads it in JS_Init(), which runs when libgjs is loaded, possibly into a
+ * process that already has threads, where changing the environment is not
+ * safe. */
+static FILE* perf_map;
+
+#ifdef G_OS_UNIX
+// The file name is predictable, so don't follow a link that someone else may
+// have put there, and only replace a file left over from an earlier process
+// with the same PID if it is ours to delete
+static int open_perf_map(const char* path) {
+    int flags = O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC;
+    int fd = open(path, flags, 0600);
+    if (fd == -1 && errno == EEXIST && unlink(path) == 0)
+        fd = open(path, flags, 0600);
+    return fd;
+}
+#endif
+
+void gjs_perf_map_init() {
+#ifdef G_OS_UNIX
+    if (!g_getenv("GJS_PERF_MAP"))
+        return;
+
+    Gjs::AutoChar path{g_strdup_printf("/tmp/perf-%jd.map",
+                                       static_cast<intmax_t>(getpid()))};
+    int fd = open_perf_map(path);
+    if (fd == -1 || !(perf_map = fdopen(fd, "w"))) {
+        g_warning("Failed to open %s: %s", path.get(), g_strerror(errno));
+        if (fd != -1)
+            close(fd);
+        return;
+    }
+
+    // perf usually reads the file after the process is gone, maybe crashed
+    setvbuf(perf_map, nullptr, _IOLBF, 0);
+#endif
+}
+
+bool gjs_perf_map_is_enabled() { return perf_map != nullptr; }
+
+void gjs_perf_map_add(const void* address, size_t size, const char* name) {
+    g_assert(perf_map && "perf map must be enabled");
+    fprintf(perf_map, "%" PRIxPTR " %zx %s\n",
+            reinterpret_cast<uintptr_t>(address), size, name);
+}
+
 #ifdef ENABLE_PROFILER
 
 [[nodiscard]]
@@ -284,9 +424,194 @@ static bool gjs_profiler_define_counters(GjsProfiler* self) {
     g_snprintf(gc_counters[Gjs::GCCounters::MALLOC_HEAP_BYTES].description,
                description_size, "Malloc bytes owned by tenured GC things");
 
+    if (!sysprof_capture_writer_define_counters(
+            self->capture, now.time_since_epoch().count(), -1, self->pid,
+            gc_counters.data(), Gjs::GCCounters::N_COUNTERS))
+        return false;
+
+    // Defining a counter also gives it its current value
+    GArray* dynamic = self->dynamic_counters;
+    if (dynamic->len == 0)
+        return true;
+    unsigned dynamic_base =
+        sysprof_capture_writer_request_counter(self->capture, dynamic->len);
+    for (unsigned ix = 0; ix < dynamic->len; ix++) {
+        auto& counter = g_array_index(dynamic, SysprofCaptureCounter, ix);
+        counter.id = dynamic_base + ix;
+    }
     return sysprof_capture_writer_define_counters(
         self->capture, now.time_since_epoch().count(), -1, self->pid,
-        gc_counters.data(), Gjs::GCCounters::N_COUNTERS);
+        &g_array_index(dynamic, SysprofCaptureCounter, 0), dynamic->len);
+}
+
+// Writes what the capture needs before any samples: the memory maps for
+// symbolizing native frames, and the counter definitions
+[[nodiscard]]
+static bool gjs_profiler_begin_capture(GjsProfiler* self) {
+    // Addresses from a previous capture writer are meaningless in this one
+    self->jitmap_generation++;
+    // Likewise, a new capture needs the first value of each counter
+    memset(self->last_counter_values, 0, sizeof self->last_counter_values);
+
+    if (!gjs_profiler_extract_maps(self)) {
+        g_warning("Failed to extract proc maps");
+        return false;
+    }
+
+    if (!gjs_profiler_define_counters(self)) {
+        g_warning("Failed to define sysprof counters");
+        return false;
+    }
+
+    return true;
+}
+
+// Writes the current value of all counters, to avoid gaps in the sysprof graph
+// at the end of a capture
+static void gjs_profiler_write_counters(GjsProfiler* self) {
+    ProfilerTimePoint now = profiler_timestamp();
+    std::array<unsigned, GJS_N_COUNTERS> ids;
+    std::array<SysprofCaptureCounterValue, GJS_N_COUNTERS> values;
+
+#    define FETCH_COUNTERS(name, ix)                \
+        {                                           \
+            uint64_t count = GJS_GET_COUNTER(name); \
+            ids[ix] = self->counter_base + (ix);    \
+            values[ix].v64 = count;                 \
+        }
+    GJS_FOR_EACH_COUNTER(FETCH_COUNTERS);
+#    undef FETCH_COUNTERS
+
+    if (!sysprof_capture_writer_set_counters(
+            self->capture, now.time_since_epoch().count(), -1, self->pid,
+            ids.data(), values.data(), GJS_N_COUNTERS))
+        g_warning("Failed to write last value of memory counters");
+}
+
+// Returns the name of the capture file. When rotating, the local time and
+// `suffix` are inserted before the extension, as in
+// gjs-1234-20260101-120000.syscap
+[[nodiscard]]
+static char* gjs_profiler_capture_path(GjsProfiler* self, const char* suffix) {
+    Gjs::AutoChar path{g_strdup(self->filename)};
+    if (!path)
+        path = g_strdup_printf("gjs-%jd.syscap",
+                               static_cast<intmax_t>(self->pid));
+
+    if (self->rotation_interval.count() == 0)
+        return path.release();
+
+    if (g_str_has_suffix(path, ".syscap"))
+        path.get()[strlen(path) - strlen(".syscap")] = '\0';
+
+    Gjs::AutoPointer<GDateTime, GDateTime, g_date_time_unref> now{
+        g_date_time_new_now_local()};
+    Gjs::AutoChar timestamp{g_date_time_format(now, "%Y%m%d-%H%M%S")};
+    return g_strdup_printf("%s-%s%s.syscap", path.get(), timestamp.get(),
+                           suffix);
+}
+
+// Deletes the oldest finished capture files, leaving rotation_keep of them
+// besides the one being written
+static void gjs_profiler_trim_segments(GjsProfiler* self) {
+    if (self->rotation_keep == 0)
+        return;
+
+    while (self->segments->length > self->rotation_keep + 1) {
+        Gjs::AutoChar path{
+            static_cast<char*>(g_queue_pop_head(self->segments))};
+        if (g_unlink(path) != 0)
+            g_warning("Failed to delete old profile capture %s: %s",
+                      path.get(), g_strerror(errno));
+    }
+}
+
+// Finishes the current capture file and continues in a new one
+static bool gjs_profiler_rotate(GjsProfiler* self) {
+    Gjs::AutoChar path{gjs_profiler_capture_path(self, "")};
+    // Don't overwrite a file started less than a second ago
+    for (unsigned n = 2; g_queue_find_custom(
+             self->segments, path,
+             [](const void* a, const void* b) {
+                 return strcmp(static_cast<const char*>(a),
+                               static_cast<const char*>(b));
+             });
+         n++) {
+        Gjs::AutoChar suffix{g_strdup_printf("-%u", n)};
+        path = gjs_profiler_capture_path(self, suffix);
+    }
+
+    SysprofCaptureWriter* capture = sysprof_capture_writer_new(path, 0);
+    if (!capture) {
+        g_warning("Failed to open profile capture %s", path.get());
+        return false;
+    }
+
+    // The SIGPROF handler must not write to either capture until the new one
+    // is set up, or see jitmap addresses cached for the old one
+    sigset_t sigprof, old_mask;
+    sigemptyset(&sigprof);
+    sigaddset(&sigprof, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &sigprof, &old_mask);
+
+    gjs_profiler_write_counters(self);
+    SysprofCaptureWriter* old_capture = std::exchange(self->capture, capture);
+    bool ok = gjs_profiler_begin_capture(self);
+    if (!ok)
+        std::swap(self->capture, old_capture);
+
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+    if (!ok) {
+        // Keep writing to the old capture file
+        sysprof_capture_writer_unref(old_capture);
+        g_unlink(path);
+        return false;
+    }
+
+    sysprof_capture_writer_flush(old_capture);
+    sysprof_capture_writer_unref(old_capture);
+
+    g_queue_push_tail(self->segments, path.release());
+    gjs_profiler_trim_segments(self);
+    return true;
+}
+
+// Writes the retained capture files, including what was sampled up to now, into
+// one capture file
+static void gjs_profiler_dump_window(GjsProfiler* self) {
+    if (!gjs_profiler_rotate(self))
+        return;
+
+    Gjs::AutoChar path{gjs_profiler_capture_path(self, "-window")};
+    SysprofCaptureWriter* writer = sysprof_capture_writer_new(path, 0);
+    if (!writer) {
+        g_warning("Failed to open profile capture %s", path.get());
+        return;
+    }
+
+    // The last segment is the one that was just started
+    unsigned n_segments = 0;
+    for (GList* l = self->segments->head; l && l->next; l = l->next) {
+        auto* segment = static_cast<char*>(l->data);
+        SysprofCaptureReader* reader = sysprof_capture_reader_new(segment);
+        if (!reader) {
+            g_warning("Failed to read profile capture %s: %s", segment,
+                      g_strerror(errno));
+            continue;
+        }
+
+        if (sysprof_capture_writer_cat(writer, reader))
+            n_segments++;
+        else
+            g_warning("Failed to copy profile capture %s", segment);
+        sysprof_capture_reader_unref(reader);
+    }
+
+    sysprof_capture_writer_flush(writer);
+    sysprof_capture_writer_unref(writer);
+
+    g_message("Profiler wrote %u capture files to %s", n_segments, path.get());
 }
 
 #endif  /* ENABLE_PROFILER */
@@ -334,6 +659,11 @@ GjsProfiler* gjs_profiler_new(GjsContext* gjs_context) {
     self->cx =
         static_cast<JSContext*>(gjs_context_get_native_context(gjs_context));
     self->pid = getpid();
+    self->sampling_period = SAMPLING_PERIOD;
+    self->segments = g_queue_new();
+    self->dynamic_counters = g_array_new(/* zero_terminated = */ false,
+                                         /* clear = */ true,
+                                         sizeof(SysprofCaptureCounter));
 #endif
     self->fd = -1;
 
@@ -365,6 +695,12 @@ void gjs_profiler_free(GjsProfiler* self) {
     g_clear_pointer(&self->capture, sysprof_capture_writer_unref);
     g_clear_pointer(&self->periodic_flush, g_source_destroy);
     g_clear_pointer(&self->target_capture, sysprof_capture_writer_unref);
+    g_queue_free_full(self->segments, g_free);
+    g_array_unref(self->dynamic_counters);
+    if (self->gecko_capture_path) {
+        g_unlink(self->gecko_capture_path);
+        g_free(self->gecko_capture_path);
+    }
 
     if (self->fd != -1)
         close(self->fd);
@@ -391,39 +727,30 @@ bool gjs_profiler_is_running(GjsProfiler* self) {
 
 #ifdef ENABLE_PROFILER
 
-static void gjs_profiler_sigprof(int signum [[maybe_unused]], siginfo_t* info,
-                                 void*) {
-    GjsProfiler* self = gjs_context_get_profiler(profiling_context);
-
-    g_assert(info && "SIGPROF handler called with invalid signal info");
-    g_assert(info->si_signo == SIGPROF &&
-             "SIGPROF handler called with other signal");
-
-    /*
-     * NOTE:
-     *
-     * This is the SIGPROF signal handler. Everything done in this thread
-     * needs to be things that are safe to do in a signal handler. One thing
-     * that is not okay to do, is *malloc*.
-     */
-
-    if (!self || info->si_code != SI_TIMER)
-        return;
-
-    uint32_t depth = self->stack.stackSize();
-    if (depth == 0)
-        return;
-
-    ProfilerTimePoint now = profiler_timestamp();
-
-    auto* addrs = static_cast<SysprofCaptureAddress*>(
-        alloca(sizeof(SysprofCaptureAddress) * depth));
+/* Fills @addrs with the capture addresses of the @depth frames of the profiling
+ * stack, innermost first, as sysprof expects them. Uses the jitmap cache, so it
+ * must only be called from the SIGPROF handler, or with SIGPROF blocked. Does
+ * not allocate. */
+static void gjs_profiler_stack_addresses(GjsProfiler* self, uint32_t depth,
+                                         SysprofCaptureAddress* addrs) {
+    uint32_t generation = self->jitmap_generation;
 
     for (uint32_t ix = 0; ix < depth; ix++) {
         js::ProfilingStackFrame& entry = self->stack.frames[ix];
         const char* label = entry.label();
         const char* dynamic_string = entry.dynamicString();
         uint32_t flipped = depth - 1 - ix;
+
+        size_t hash = (reinterpret_cast<uintptr_t>(label) >> 3) ^
+                      (reinterpret_cast<uintptr_t>(dynamic_string) >> 3) * 31;
+        JitmapCacheEntry& cached =
+            self->jitmap_cache[hash & (JITMAP_CACHE_SIZE - 1)];
+        if (cached.generation == generation && cached.label == label &&
+            cached.dynamic_string == dynamic_string) {
+            addrs[flipped] = cached.address;
+            continue;
+        }
+
         size_t label_length = strlen(label);
 
         /* 512 is an arbitrarily large size, very likely to be enough to hold
@@ -470,13 +797,46 @@ static void gjs_profiler_sigprof(int signum [[maybe_unused]], siginfo_t* info,
          * stack address of "this", which is not terribly useful since
          * everything will show up as [stack] when building callgraphs.
          */
-        if (final_string[0] != '\0')
+        if (final_string[0] != '\0') {
             addrs[flipped] =
                 sysprof_capture_writer_add_jitmap(self->capture, final_string);
-        else
+            cached = {label, dynamic_string, generation, addrs[flipped]};
+        } else {
             addrs[flipped] =
                 reinterpret_cast<SysprofCaptureAddress>(entry.stackAddress());
+        }
     }
+}
+
+static void gjs_profiler_sigprof(int signum [[maybe_unused]], siginfo_t* info,
+                                 void*) {
+    GjsProfiler* self = gjs_context_get_profiler(profiling_context);
+
+    g_assert(info && "SIGPROF handler called with invalid signal info");
+    g_assert(info->si_signo == SIGPROF &&
+             "SIGPROF handler called with other signal");
+
+    /*
+     * NOTE:
+     *
+     * This is the SIGPROF signal handler. Everything done in this thread
+     * needs to be things that are safe to do in a signal handler. One thing
+     * that is not okay to do, is *malloc*.
+     */
+
+    if (!self || info->si_code != SI_TIMER)
+        return;
+
+    uint32_t depth = self->stack.stackSize();
+    if (depth == 0)
+        return;
+
+    ProfilerTimePoint now = profiler_timestamp();
+
+    auto* addrs = static_cast<SysprofCaptureAddress*>(
+        alloca(sizeof(SysprofCaptureAddress) * depth));
+
+    gjs_profiler_stack_addresses(self, depth, addrs);
 
     if (!sysprof_capture_writer_add_sample(self->capture,
                                            now.time_since_epoch().count(), -1,
@@ -508,6 +868,56 @@ static void gjs_profiler_sigprof(int signum [[maybe_unused]], siginfo_t* info,
         gjs_profiler_stop(self);
 }
 
+/* Writes an allocation record with the current stack, below an innermost frame
+ * labelled @label which says what was allocated. */
+static void gjs_profiler_write_allocation(GjsProfiler* self,
+                                          SysprofCaptureAddress address,
+                                          int64_t size, const char* label) {
+    if (!self->running || !self->capture)
+        return;
+
+    // The SIGPROF handler writes to the same capture and jitmap cache
+    sigset_t sigprof, old_mask;
+    sigemptyset(&sigprof);
+    sigaddset(&sigprof, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &sigprof, &old_mask);
+
+    uint32_t depth = self->stack.stackSize();
+    auto* addrs = static_cast<SysprofCaptureAddress*>(
+        alloca(sizeof(SysprofCaptureAddress) * (depth + 1)));
+    addrs[0] = sysprof_capture_writer_add_jitmap(self->capture, label);
+    gjs_profiler_stack_addresses(self, depth, addrs + 1);
+
+    ProfilerTimePoint now = profiler_timestamp();
+    bool ok = sysprof_capture_writer_add_allocation_copy(
+        self->capture, now.time_since_epoch().count(), -1, self->pid, -1,
+        address, size, addrs, depth + 1);
+
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+    if (!ok)
+        g_warning_once("Failed to write allocation to the profile capture");
+}
+
+// Called by SpiderMonkey for the JS object allocations that it samples. It
+// must not GC or run JS code.
+static void gjs_profiler_record_js_allocation(JS::RecordAllocationInfo&& info) {
+    GjsProfiler* self = gjs_context_get_profiler(profiling_context);
+    if (!self)
+        return;
+
+    // e.g. "JS Object Array"
+    char label[128];
+    if (info.className)
+        g_snprintf(label, sizeof label, "JS %s %s", info.coarseType,
+                   info.className);
+    else
+        g_snprintf(label, sizeof label, "JS %s", info.coarseType);
+
+    // SpiderMonkey doesn't tell the address, and frees are not recorded
+    gjs_profiler_write_allocation(self, 0, info.size, label);
+}
+
 static gboolean profiler_auto_flush_cb(void* user_data) {
     auto* self = static_cast<GjsProfiler*>(user_data);
 
@@ -519,6 +929,25 @@ static gboolean profiler_auto_flush_cb(void* user_data) {
     return G_SOURCE_CONTINUE;
 }
 
+static gboolean profiler_rotate_cb(void* user_data) {
+    auto* self = static_cast<GjsProfiler*>(user_data);
+
+    if (!self->running)
+        return G_SOURCE_REMOVE;
+
+    gjs_profiler_rotate(self);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void gjs_profiler_stop_rotation(GjsProfiler* self) {
+    if (!self->rotation)
+        return;
+
+    g_source_destroy(self->rotation);
+    g_clear_pointer(&self->rotation, g_source_unref);
+}
+
 #endif  // ENABLE_PROFILER
 
 /**
@@ -555,13 +984,28 @@ void gjs_profiler_start(GjsProfiler* self) {
     } else if (self->fd != -1) {
         self->capture = sysprof_capture_writer_new_from_fd(self->fd, 0);
         self->fd = -1;
-    } else {
-        Gjs::AutoChar path{g_strdup(self->filename)};
-        if (!path)
-            path = g_strdup_printf("gjs-%jd.syscap",
-                                   static_cast<intmax_t>(self->pid));
+    } else if (self->gecko_format) {
+        // The Gecko profile is converted from one capture when stopping
+        if (self->rotation_interval.count() != 0) {
+            g_warning(
+                "GJS_PROFILER_ROTATE and GJS_PROFILER_KEEP are not supported "
+                "with the Gecko profile format, and are ignored");
+        }
 
+        Gjs::AutoError error;
+        int fd = g_file_open_tmp("gjs-XXXXXX.syscap", &self->gecko_capture_path,
+                                 &error);
+        if (fd != -1)
+            self->capture = sysprof_capture_writer_new_from_fd(fd, 0);
+        else
+            g_warning("Failed to create profile capture: %s", error->message);
+    } else {
+        Gjs::AutoChar path{gjs_profiler_capture_path(self, "")};
         self->capture = sysprof_capture_writer_new(path, 0);
+        if (self->capture && self->rotation_interval.count() != 0) {
+            g_queue_push_tail(self->segments, path.release());
+            gjs_profiler_trim_segments(self);
+        }
     }
 
     if (!self->capture) {
@@ -583,15 +1027,7 @@ void gjs_profiler_start(GjsProfiler* self) {
                         g_main_context_get_thread_default());
     }
 
-    if (!gjs_profiler_extract_maps(self)) {
-        g_warning("Failed to extract proc maps");
-        g_clear_pointer(&self->capture, sysprof_capture_writer_unref);
-        g_clear_pointer(&self->periodic_flush, g_source_destroy);
-        return;
-    }
-
-    if (!gjs_profiler_define_counters(self)) {
-        g_warning("Failed to define sysprof counters");
+    if (!gjs_profiler_begin_capture(self)) {
         g_clear_pointer(&self->capture, sysprof_capture_writer_unref);
         g_clear_pointer(&self->periodic_flush, g_source_destroy);
         return;
@@ -632,10 +1068,12 @@ void gjs_profiler_start(GjsProfiler* self) {
     }
 
     // Calculate sampling interval
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = std::chrono::nanoseconds{SAMPLING_PERIOD}.count();
-    its.it_value.tv_sec = 0;
-    its.it_value.tv_nsec = std::chrono::nanoseconds{SAMPLING_PERIOD}.count();
+    auto period_s =
+        std::chrono::floor<std::chrono::seconds>(self->sampling_period);
+    its.it_interval.tv_sec = period_s.count();
+    its.it_interval.tv_nsec =
+        std::chrono::nanoseconds{self->sampling_period - period_s}.count();
+    its.it_value = its.it_interval;
 
     // Now start this timer
     if (timer_settime(self->timer, 0, &its, &old_its) != 0) {
@@ -646,6 +1084,18 @@ void gjs_profiler_start(GjsProfiler* self) {
         return;
     }
 
+    // Rotation only makes sense for captures that GJS names itself
+    if (self->rotation_interval.count() != 0 && !self->target_capture &&
+        !g_queue_is_empty(self->segments)) {
+        self->rotation =
+            g_timeout_source_new_seconds(self->rotation_interval.count());
+        g_source_set_static_name(self->rotation, "[gjs] Profiler rotation");
+        g_source_set_priority(self->rotation, G_PRIORITY_LOW + 100);
+        g_source_set_callback(self->rotation, profiler_rotate_cb, self,
+                              nullptr);
+        g_source_attach(self->rotation, g_main_context_get_thread_default());
+    }
+
     self->running = true;
 
     // Notify the JS runtime of where to put stack info
@@ -654,6 +1104,12 @@ void gjs_profiler_start(GjsProfiler* self) {
     // Start recording stack info
     js::EnableContextProfilingStack(self->cx, true);
 
+    if (self->allocation_probability > 0) {
+        JS::EnableRecordingAllocations(self->cx,
+                                       gjs_profiler_record_js_allocation,
+                                       self->allocation_probability);
+    }
+
     g_message("Profiler started");
 
 #else  // !ENABLE_PROFILER
@@ -688,29 +1144,15 @@ void gjs_profiler_stop(GjsProfiler* self) {
 
 #ifdef ENABLE_PROFILER
 
-    // Write last value of memory counters, to avoid gaps in sysprof graph
-    ProfilerTimePoint now = profiler_timestamp();
-    std::array<unsigned, GJS_N_COUNTERS> ids;
-    std::array<SysprofCaptureCounterValue, GJS_N_COUNTERS> values;
-
-#    define FETCH_COUNTERS(name, ix)                \
-        {                                           \
-            uint64_t count = GJS_GET_COUNTER(name); \
-            ids[ix] = self->counter_base + (ix);    \
-            values[ix].v64 = count;                 \
-        }
-    GJS_FOR_EACH_COUNTER(FETCH_COUNTERS);
-#    undef FETCH_COUNTERS
-
-    if (!sysprof_capture_writer_set_counters(
-            self->capture, now.time_since_epoch().count(), -1, self->pid,
-            ids.data(), values.data(), GJS_N_COUNTERS))
-        g_warning("Failed to write last value of memory counters");
+    gjs_profiler_write_counters(self);
 
     struct itimerspec its = {{0}};
     timer_settime(self->timer, 0, &its, nullptr);
     timer_delete(self->timer);
 
+    if (self->allocation_probability > 0)
+        JS::DisableRecordingAllocations(self->cx);
+
     js::EnableContextProfilingStack(self->cx, false);
     js::SetContextProfilingStack(self->cx, nullptr);
 
@@ -718,6 +1160,21 @@ void gjs_profiler_stop(GjsProfiler* self) {
 
     g_clear_pointer(&self->capture, sysprof_capture_writer_unref);
     g_clear_pointer(&self->periodic_flush, g_source_destroy);
+    gjs_profiler_stop_rotation(self);
+
+    if (self->gecko_capture_path) {
+        Gjs::AutoChar path{g_strdup(self->filename)};
+        if (!path)
+            path = g_strdup_printf("gjs-%jd.json",
+                                   static_cast<intmax_t>(self->pid));
+
+        if (Gjs::write_gecko_profile(self->gecko_capture_path, path,
+                                     self->sampling_period))
+            g_message("Profile written to %s", path.get());
+
+        g_unlink(self->gecko_capture_path);
+        g_clear_pointer(&self->gecko_capture_path, g_free);
+    }
 
     g_message("Profiler stopped");
 
@@ -733,10 +1190,12 @@ static gboolean gjs_profiler_sigusr2(void* data) {
     GjsProfiler* current_profiler = gjs_context_get_profiler(gjs_context);
 
     if (current_profiler) {
-        if (gjs_profiler_is_running(current_profiler))
-            gjs_profiler_stop(current_profiler);
-        else
+        if (!gjs_profiler_is_running(current_profiler))
             gjs_profiler_start(current_profiler);
+        else if (current_profiler->rotation)
+            gjs_profiler_dump_window(current_profiler);
+        else
+            gjs_profiler_stop(current_profiler);
     }
 
     return G_SOURCE_CONTINUE;
@@ -854,6 +1313,70 @@ void gjs_profiler_set_filename(GjsProfiler* self, const char* filename) {
     self->filename = g_strdup(filename);
 }
 
+/**
+ * gjs_profiler_set_output_format:
+ * @self: A #GjsProfiler
+ * @format: "sysprof" or "gecko"
+ *
+ * Set the format of the file that the profiling data is written to when @self
+ * is stopped. The default, "sysprof", is a Sysprof capture. "gecko" is the JSON
+ * profile format that the Firefox Profiler loads, and changes the default file
+ * name to `gjs-$PID.json`. This does not apply to the file descriptor or
+ * capture writer set with gjs_profiler_set_fd() or
+ * gjs_profiler_set_capture_writer().
+ *
+ * Returns: false if @format is not a known format.
+ */
+bool gjs_profiler_set_output_format(GjsProfiler* self, const char* format) {
+    g_return_val_if_fail(self, false);
+    g_return_val_if_fail(!self->running, false);
+
+    if (strcmp(format, "sysprof") == 0)
+        self->gecko_format = false;
+    else if (strcmp(format, "gecko") == 0)
+        self->gecko_format = true;
+    else
+        return false;
+
+    return true;
+}
+
+/**
+ * gjs_profiler_convert_capture:
+ * @capture_path: a Sysprof capture written by the profiler
+ * @output_path: the file to write the converted profile to
+ * @format: the format to convert to; only "gecko" is supported
+ *
+ * Converts a capture that was already recorded, for example with
+ * `GJS_PROFILER_ROTATE`, in the same way as the profiler does when stopped
+ * after gjs_profiler_set_output_format(). The sampling period that the capture
+ * was recorded with is taken from `GJS_PROFILER_INTERVAL`, as when recording.
+ *
+ * Returns: false, after logging a warning, if the capture could not be
+ *   converted.
+ */
+bool gjs_profiler_convert_capture(const char* capture_path,
+                                  const char* output_path, const char* format) {
+    g_return_val_if_fail(capture_path, false);
+    g_return_val_if_fail(output_path, false);
+    g_return_val_if_fail(format, false);
+
+    if (strcmp(format, "gecko") != 0) {
+        g_warning("Cannot convert a profile capture to format '%s'", format);
+        return false;
+    }
+
+    std::chrono::microseconds sampling_period = SAMPLING_PERIOD;
+    if (const char* interval = g_getenv("GJS_PROFILER_INTERVAL")) {
+        uint64_t us = g_ascii_strtoull(interval, nullptr, 10);
+        if (us > 0)
+            sampling_period = std::chrono::microseconds{us};
+    }
+
+    return Gjs::write_gecko_profile(capture_path, output_path,
+                                    sampling_period);
+}
+
 void gjs_profiler_add_mark(GjsProfiler* self, ProfilerTimePoint time,
                            ProfilerDuration duration, const char* group,
                            const char* name, const char* message) {
@@ -918,6 +1441,130 @@ void gjs_profiler_set_fd(GjsProfiler* self, int fd) {
 #endif
 }
 
+void gjs_profiler_set_sampling_period(GjsProfiler* self,
+                                      std::chrono::microseconds period) {
+    g_return_if_fail(self);
+    g_return_if_fail(!self->running);
+    g_return_if_fail(period.count() > 0);
+
+#ifdef ENABLE_PROFILER
+    self->sampling_period = period;
+#else
+    (void)period;  // Unused in the no-profiler case
+#endif
+}
+
+void gjs_profiler_set_rotation(GjsProfiler* self,
+                               std::chrono::seconds interval, unsigned keep) {
+    g_return_if_fail(self);
+    g_return_if_fail(!self->running);
+
+#ifdef ENABLE_PROFILER
+    self->rotation_interval = interval;
+    self->rotation_keep = keep;
+#else
+    // Unused in the no-profiler case
+    (void)interval;
+    (void)keep;
+#endif
+}
+
+void gjs_profiler_set_allocation_sampling(GjsProfiler* self,
+                                          double probability) {
+    g_return_if_fail(self);
+    g_return_if_fail(!self->running);
+    g_return_if_fail(probability >= 0 && probability <= 1);
+
+#ifdef ENABLE_PROFILER
+    self->allocation_probability = probability;
+#else
+    (void)probability;  // Unused in the no-profiler case
+#endif
+}
+
+bool gjs_profiler_sample_allocation(GjsProfiler* self) {
+#ifdef ENABLE_PROFILER
+    return self->running && self->allocation_probability > 0 &&
+           g_random_double() < self->allocation_probability;
+#else
+    (void)self;  // Unused in the no-profiler case
+    return false;
+#endif
+}
+
+void gjs_profiler_add_allocation(GjsProfiler* self, const void* address,
+                                 size_t size, const char* label) {
+    g_return_if_fail(self);
+    g_return_if_fail(label);
+
+#ifdef ENABLE_PROFILER
+    gjs_profiler_write_allocation(
+        self, reinterpret_cast<SysprofCaptureAddress>(address), size, label);
+#else
+    // Unused in the no-profiler case
+    (void)address;
+    (void)size;
+#endif
+}
+
+unsigned gjs_profiler_add_counter(GjsProfiler* self, const char* category,
+                                  const char* name, const char* description) {
+    g_return_val_if_fail(self, 0);
+    g_return_val_if_fail(category && name && description, 0);
+
+#ifdef ENABLE_PROFILER
+    SysprofCaptureCounter counter{};
+    g_snprintf(counter.category, sizeof counter.category, "%s", category);
+    g_snprintf(counter.name, sizeof counter.name, "%s", name);
+    g_snprintf(counter.description, sizeof counter.description, "%s",
+               description);
+    counter.type = SYSPROF_CAPTURE_COUNTER_INT64;
+
+    if (self->running && self->capture) {
+        counter.id = sysprof_capture_writer_request_counter(self->capture, 1);
+        ProfilerTimePoint now = profiler_timestamp();
+        if (!sysprof_capture_writer_define_counters(
+                self->capture, now.time_since_epoch().count(), -1, self->pid,
+                &counter, 1))
+            g_warning("Failed to define sysprof counter %s", name);
+    }
+
+    unsigned handle = self->dynamic_counters->len;
+    g_array_append_val(self->dynamic_counters, counter);
+    return handle;
+#else
+    (void)category;  // Unused in the no-profiler case
+    (void)name;
+    (void)description;
+    return 0;
+#endif
+}
+
+void gjs_profiler_set_counter(GjsProfiler* self, unsigned handle,
+                              int64_t value) {
+    g_return_if_fail(self);
+
+#ifdef ENABLE_PROFILER
+    g_return_if_fail(handle < self->dynamic_counters->len);
+
+    auto& counter =
+        g_array_index(self->dynamic_counters, SysprofCaptureCounter, handle);
+    counter.value.v64 = value;
+
+    if (self->running && self->capture) {
+        unsigned id = counter.id;
+        ProfilerTimePoint now = profiler_timestamp();
+        if (!sysprof_capture_writer_set_counters(
+                self->capture, now.time_since_epoch().count(), -1, self->pid,
+                &id, &counter.value, 1))
+            g_warning("Failed to write sysprof counter %s", counter.name);
+    }
+#else
+    (void)handle;  // Unused in the no-profiler case
+    (void)value;
+#endif
+}
+
 void gjs_profiler_set_finalize_status(GjsProfiler* self,
                                       JSFinalizeStatus status) {
 #ifdef ENABLE_PROFILER
@@ -954,6 +1601,8 @@ void gjs_profiler_set_finalize_status(GjsProfiler* self,
             self->group_sweep_begin_time = Some(now);
             break;
         case JSFINALIZE_GROUP_END:
+            // Scripts in this group may have been finalized
+            self->jitmap_generation++;
             if (self->group_sweep_begin_time) {
                 gjs_profiler_add_mark(self, *self->group_sweep_begin_time,
                                       now - *self->group_sweep_begin_time,
@@ -962,6 +1611,7 @@ void gjs_profiler_set_finalize_status(GjsProfiler* self,
             self->group_sweep_begin_time = Nothing{};
             break;
         case JSFINALIZE_COLLECTION_END:
+            self->jitmap_generation++;
             if (self->sweep_begin_time) {
                 gjs_profiler_add_mark(self, *self->sweep_begin_time,
                                       now - *self->sweep_begin_time, "GJS",
@@ -28,6 +28,11 @@ GJS_EXPORT
 void gjs_profiler_set_filename(GjsProfiler* self, const char* filename);
 GJS_EXPORT
 void gjs_profiler_set_fd(GjsProfiler* self, int fd);
+GJS_EXPORT
+bool gjs_profiler_set_output_format(GjsProfiler* self, const char* format);
+GJS_EXPORT
+bool gjs_profiler_convert_capture(const char* capture_path,
+                                  const char* output_path, const char* format);
 
 GJS_EXPORT
 void gjs_profiler_start(GjsProfiler* self);
@@ -0,0 +1,71 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <string>
+#include <utility>  // for move
+
+#include <mozilla/Maybe.h>
+
+#include "gjs/resolution-cache.h"
+#include "util/log.h"
+
+namespace Gjs {
+
+std::string ResolutionCache::relative_key(const char* base_uri,
+                                          const char* relative_path) {
+    // NUL cannot occur in either part, so the key is unambiguous
+    std::string key{base_uri};
+    key += '\0';
+    key += relative_path;
+    return key;
+}
+
+const std::string* ResolutionCache::lookup_canonical(
+    const std::string& specifier) const {
+    auto it = m_canonical.find(specifier);
+    return it == m_canonical.end() ? nullptr : &it->second;
+}
+
+void ResolutionCache::store_canonical(std::string&& specifier,
+                                      const char* canonical) {
+    m_canonical.insert_or_assign(std::move(specifier), canonical);
+}
+
+const std::string* ResolutionCache::lookup_relative(
+    const char* base_uri, const char* relative_path) const {
+    auto it = m_relative.find(relative_key(base_uri, relative_path));
+    return it == m_relative.end() ? nullptr : &it->second;
+}
+
+void ResolutionCache::store_relative(const char* base_uri,
+                                     const char* relative_path,
+                                     const char* resolved_uri) {
+    m_relative.insert_or_assign(relative_key(base_uri, relative_path),
+                                resolved_uri);
+}
+
+mozilla::Maybe<bool> ResolutionCache::lookup_exists(const char* uri) const {
+    auto it = m_exists.find(uri);
+    if (it == m_exists.end())
+        return mozilla::Nothing{};
+    return mozilla::Some(it->second);
+}
+
+void ResolutionCache::store_exists(const char* uri, bool exists) {
+    m_exists.insert_or_assign(uri, exists);
+}
+
+void ResolutionCache::clear() {
+    gjs_debug(GJS_DEBUG_IMPORTER,
+              "Clearing module resolution cache (%zu canonical, %zu relative, "
+              "%zu existence entries)",
+              m_canonical.size(), m_relative.size(), m_exists.size());
+    m_canonical.clear();
+    m_relative.clear();
+    m_exists.clear();
+}
+
+}  // namespace Gjs
@@ -0,0 +1,51 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <string>
+#include <unordered_map>
+
+#include <mozilla/Maybe.h>
+
+namespace Gjs {
+
+/* Per-context cache of the results of ES module specifier resolution, so that
+ * repeated imports of the same module don't need to create GFile objects or hit
+ * the filesystem again. It holds:
+ *  - canonical forms of specifiers (see canonicalize_specifier() in module.cpp)
+ *  - relative specifiers resolved against the URI of the importing module
+ *  - whether a URI exists, including negative entries for missing files
+ *
+ * The cache is cleared whenever the module search path changes: the context's
+ * search-path property, or the set of internal module URIs in loader.js. */
+class ResolutionCache {
+    std::unordered_map<std::string, std::string> m_canonical;
+    std::unordered_map<std::string, std::string> m_relative;
+    std::unordered_map<std::string, bool> m_exists;
+
+    [[nodiscard]]
+    static std::string relative_key(const char* base_uri,
+                                    const char* relative_path);
+
+ public:
+    [[nodiscard]]
+    const std::string* lookup_canonical(const std::string& specifier) const;
+    void store_canonical(std::string&& specifier, const char* canonical);
+
+    [[nodiscard]]
+    const std::string* lookup_relative(const char* base_uri,
+                                       const char* relative_path) const;
+    void store_relative(const char* base_uri, const char* relative_path,
+                        const char* resolved_uri);
+
+    [[nodiscard]] mozilla::Maybe<bool> lookup_exists(const char* uri) const;
+    void store_exists(const char* uri, bool exists);
+
+    void clear();
+};
+
+}  // namespace Gjs
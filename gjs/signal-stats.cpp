@@ -0,0 +1,151 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+
+#include <algorithm>  // for sort
+#include <chrono>
+#include <functional>  // for hash
+#include <string>
+#include <vector>
+
+#include <glib-object.h>
+#include <glib.h>
+
+#include "gjs/profiler-private.h"
+#include "gjs/signal-stats.h"
+
+namespace Gjs {
+
+size_t SignalStats::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<GType>{}(key.gtype);
+    hash = hash * 31 + std::hash<unsigned>{}(key.signal_id);
+    return hash * 31 + std::hash<GQuark>{}(key.detail);
+}
+
+SignalStats::~SignalStats() {
+    if (m_flush_source) {
+        g_source_destroy(m_flush_source);
+        g_clear_pointer(&m_flush_source, g_source_unref);
+    }
+}
+
+// Leaves the profiler's counters alone
+void SignalStats::reset() {
+    for (auto& [key, entry] : m_entries) {
+        entry.emissions = entry.handler_calls = 0;
+        entry.emission_time = entry.handler_time = {};
+    }
+}
+
+SignalStats::Entry* SignalStats::entry(GType gtype, unsigned signal_id,
+                                       GQuark detail) {
+    if (!m_running && !m_profiler)
+        return nullptr;
+
+    auto [it, inserted] = m_entries.try_emplace({gtype, signal_id, detail});
+    Entry& entry = it->second;
+    if (inserted) {
+        GSignalQuery query;
+        g_signal_query(signal_id, &query);
+        entry.type_name = g_type_name(gtype);
+        entry.signal_name = query.signal_name ? query.signal_name : "<unknown>";
+        if (detail) {
+            entry.signal_name += "::";
+            entry.signal_name += g_quark_to_string(detail);
+        }
+    }
+    return &entry;
+}
+
+void SignalStats::add_counters(Entry* entry) {
+    std::string name = entry->type_name + ' ' + entry->signal_name;
+    entry->calls_counter = gjs_profiler_add_counter(
+        m_profiler, "Signal handler calls", name.c_str(),
+        "Number of calls of JS handlers for a signal");
+    entry->time_counter = gjs_profiler_add_counter(
+        m_profiler, "Signal handler time", name.c_str(),
+        "Time spent in JS handlers for a signal, in us");
+    entry->has_counters = true;
+}
+
+void SignalStats::record(Entry* entry, bool is_emission,
+                         Clock::duration duration) {
+    if (m_running) {
+        if (is_emission) {
+            entry->emissions++;
+            entry->emission_time += duration;
+        } else {
+            entry->handler_calls++;
+            entry->handler_time += duration;
+        }
+    }
+
+    if (is_emission || !m_profiler)
+        return;
+    entry->profiler_calls++;
+    entry->profiler_time += duration;
+    if (!entry->has_counters)
+        add_counters(entry);
+    entry->counters_dirty = true;
+    schedule_flush();
+}
+
+// Counters are written at most every FLUSH_INTERVAL_MS, so that a storm of
+// signal emissions doesn't flood the capture
+void SignalStats::schedule_flush() {
+    if (m_flush_source || !gjs_profiler_is_running(m_profiler))
+        return;
+
+    m_flush_source = g_timeout_source_new(FLUSH_INTERVAL_MS);
+    g_source_set_callback(m_flush_source, &SignalStats::on_flush, this,
+                          nullptr);
+    g_source_set_static_name(m_flush_source, "[gjs] Signal statistics");
+    g_source_attach(m_flush_source, nullptr);
+}
+
+gboolean SignalStats::on_flush(void* data) {
+    auto* self = static_cast<SignalStats*>(data);
+    g_clear_pointer(&self->m_flush_source, g_source_unref);
+    self->flush_counters();
+    return G_SOURCE_REMOVE;
+}
+
+void SignalStats::flush_counters() {
+    for (auto& [key, entry] : m_entries) {
+        if (!entry.counters_dirty)
+            continue;
+
+        auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            entry.profiler_time);
+        gjs_profiler_set_counter(m_profiler, entry.calls_counter,
+                                 entry.profiler_calls);
+        gjs_profiler_set_counter(m_profiler, entry.time_counter,
+                                 time_us.count());
+        entry.counters_dirty = false;
+    }
+}
+
+SignalStats::AutoTimer::~AutoTimer() {
+    if (m_entry)
+        m_stats->record(m_entry, m_is_emission, Clock::now() - m_begin);
+}
+
+std::vector<const SignalStats::Entry*> SignalStats::sorted_entries() const {
+    std::vector<const Entry*> sorted;
+    sorted.reserve(m_entries.size());
+    for (const auto& [key, entry] : m_entries) {
+        if (entry.emissions > 0 || entry.handler_calls > 0)
+            sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) {
+        return a->handler_time > b->handler_time;
+    });
+    return sorted;
+}
+
+}  // namespace Gjs
@@ -0,0 +1,134 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+// SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 GNOME Foundation
+
+#pragma once
+
+#include <config.h>
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glib-object.h>
+#include <glib.h>
+
+#include "gjs/profiler.h"
+
+namespace Gjs {
+
+/* Counts signal emissions and calls of JS signal handlers, and the time spent
+ * in them, per instance GType and signal. The detail is part of the signal, so
+ * that each property's notify:: signal is counted separately.
+ *
+ * Handler calls are counted in Closure::marshal(), whoever emits the signal;
+ * emissions only if they come from JS, with emit(). Handler time includes
+ * converting the arguments.
+ *
+ * Created on demand by System.startSignalStats(), or when the profiler is
+ * enabled. In that case, each signal also gets two Sysprof counters, with the
+ * number of handler calls and the total handler time so far. These are kept
+ * apart from the statistics that JS sees, and are recorded for as long as the
+ * profiler exists, so that System.stopSignalStats() and resetSignalStats() do
+ * not stop or zero them in the middle of a capture. */
+class SignalStats {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string type_name;
+        std::string signal_name;  // including the detail, e.g. notify::label
+        uint64_t emissions = 0;
+        Clock::duration emission_time{};
+        uint64_t handler_calls = 0;
+        Clock::duration handler_time{};
+
+        // Handles and totals of the Sysprof counters, if created
+        bool has_counters = false;
+        bool counters_dirty = false;
+        unsigned calls_counter;
+        unsigned time_counter;
+        uint64_t profiler_calls = 0;
+        Clock::duration profiler_time{};
+    };
+
+    /* Times one emission or handler call until it goes out of scope. Does
+     * nothing if `entry` is null, that is, if statistics are not being
+     * recorded. */
+    class AutoTimer {
+     public:
+        enum Kind : bool { HANDLER, EMISSION };
+
+     private:
+        SignalStats* m_stats;
+        Entry* m_entry;
+        Clock::time_point m_begin;
+        bool m_is_emission;
+
+     public:
+        AutoTimer(SignalStats* stats, Entry* entry, Kind kind)
+            : m_stats(stats), m_entry(entry), m_is_emission(kind == EMISSION) {
+            if (m_entry)
+                m_begin = Clock::now();
+        }
+        ~AutoTimer();
+
+        AutoTimer(const AutoTimer&) = delete;
+        AutoTimer& operator=(const AutoTimer&) = delete;
+    };
+
+ private:
+    struct Key {
+        GType gtype;
+        unsigned signal_id;
+        GQuark detail;
+
+        bool operator==(const Key& other) const {
+            return gtype == other.gtype && signal_id == other.signal_id &&
+                   detail == other.detail;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    GjsProfiler* m_profiler;
+    GSource* m_flush_source = nullptr;
+    bool m_running = false;
+
+    void add_counters(Entry*);
+    void schedule_flush();
+    void flush_counters();
+    static gboolean on_flush(void* data);
+
+ public:
+    static constexpr unsigned FLUSH_INTERVAL_MS = 100;
+
+    // `profiler` may be null; if not, it must outlive this object
+    explicit SignalStats(GjsProfiler* profiler) : m_profiler(profiler) {}
+    ~SignalStats();
+
+    SignalStats(const SignalStats&) = delete;
+    SignalStats& operator=(const SignalStats&) = delete;
+
+    void start() { m_running = true; }
+    void stop() { m_running = false; }
+    void reset();
+    [[nodiscard]] bool running() const { return m_running; }
+
+    // Returns the entry for the signal, or null if neither JS nor the profiler
+    // is recording
+    [[nodiscard]] Entry* entry(GType, unsigned signal_id, GQuark detail);
+    void record(Entry*, bool is_emission, Clock::duration);
+
+    // Entries that have been emitted or handled, most handler time first
+    [[nodiscard]] std::vector<const Entry*> sorted_entries() const;
+};
+
+}  // namespace Gjs
@@ -191,6 +191,34 @@ describe('Cairo', function () {
             expect(sheared.y0).toBeCloseTo(2);
         });
 
+        it('checks the arguments of methods taking numbers', function () {
+            expect(() => cr.moveTo(1)).toThrowError(/moveTo/);
+            expect(() => cr.moveTo(1, 2, 3)).toThrowError(/Expected 2 arguments, got 3/);
+            expect(() => cr.setSourceRGBA(1, 0, Symbol('blue'), 1))
+                .toThrowError(/at argument 2 \(blue\)/);
+            cr.moveTo('1', 2);
+            expect(cr.getCurrentPoint()).toEqual([1, 2]);
+        });
+
+        it('appends a path from typed arrays', function () {
+            const {MOVE_TO, LINE_TO, CURVE_TO, CLOSE_PATH} = Cairo.PathDataType;
+            cr.appendPathData(new Uint8Array([MOVE_TO, LINE_TO, CURVE_TO, CLOSE_PATH]),
+                new Float64Array([1, 2, 8, 2, 8, 4, 6, 6, 3, 8]));
+            expect(cr.pathExtents()).toEqual([1, 2, 8, 8]);
+            expect(cr.getCurrentPoint()).toEqual([1, 2]);
+        });
+
+        it('does not append a path with missing coordinates', function () {
+            const {MOVE_TO, LINE_TO} = Cairo.PathDataType;
+            expect(() => cr.appendPathData(new Uint8Array([MOVE_TO, LINE_TO]),
+                new Float64Array([1, 2, 3]))).toThrowError(/need 4 coordinates/);
+            expect(() => cr.appendPathData(new Uint8Array([MOVE_TO, 42]),
+                new Float64Array([1, 2]))).toThrowError(/index 1/);
+            expect(() => cr.appendPathData([MOVE_TO], new Float64Array([1, 2])))
+                .toThrowError(TypeError);
+            expect(cr.hasCurrentPoint()).toBeFalse();
+        });
+
         it('can call various, otherwise untested, methods without crashing', function () {
             expect(() => {
                 cr.save();
@@ -348,6 +376,48 @@ describe('Cairo', function () {
         it('can fail creation', function () {
             expect(() => new Cairo.ImageSurface('too', 'few')).toThrow();
         });
+
+        it('exposes its pixels without copying', function () {
+            cr.setSourceRGBA(1, 0, 0, 1);
+            cr.paint();
+            const data = surface.getData();
+            expect(data).toBeInstanceOf(Uint8ClampedArray);
+            expect(data.length).toEqual(surface.getStride() * 10);
+            // ARGB32 is native-endian
+            const pixel = new Uint32Array(data.buffer, 0, 1);
+            expect(pixel[0]).toEqual(0xffff0000);
+
+            pixel[0] = 0xff00ff00;
+            surface.markDirty();
+            expect(new Uint32Array(surface.getData().buffer, 0, 1)[0])
+                .toEqual(0xff00ff00);
+        });
+
+        it('can be created from a typed array', function () {
+            const pixels = new Uint32Array([0xff0000ff, 0, 0, 0xff00ff00]);
+            const s = new Cairo.ImageSurface(Cairo.Format.ARGB32, 2, 2, pixels, 8);
+            expect(s.getStride()).toEqual(8);
+            expect(pixels.length).toEqual(0);  // detached
+            expect(Array.from(new Uint32Array(s.getData().buffer)))
+                .toEqual([0xff0000ff, 0, 0, 0xff00ff00]);
+        });
+
+        it('rejects a typed array that is too small', function () {
+            expect(() => new Cairo.ImageSurface(Cairo.Format.ARGB32, 2, 2,
+                new Uint8Array(4))).toThrowError(/too small/);
+        });
+
+        it('rejects a typed array that is not aligned in its buffer', function () {
+            const pixels = new Uint8Array(new ArrayBuffer(20), 1, 16);
+            expect(() => new Cairo.ImageSurface(Cairo.Format.ARGB32, 2, 2,
+                pixels, 8)).toThrowError(/multiple of 4/);
+            expect(pixels.length).toEqual(16);  // not detached
+        });
+
+        it('marks a rectangle dirty only with all four coordinates', function () {
+            expect(() => surface.markDirty(0, 0, 1, 1)).not.toThrow();
+            expect(() => surface.markDirty(0, 0)).toThrowError(/0 or 4/);
+        });
     });
 
     describe('surface', function () {
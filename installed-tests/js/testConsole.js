@@ -148,6 +148,28 @@ describe('console', function () {
         writer_func.calls.reset();
     });
 
+    it('logs the call site of each warning', function () {
+        function warnTwice() {
+            for (let i = 0; i < 2; i++) {
+                // eslint-disable-next-line max-statements-per-line
+                console.warn('a warning'); const error = new Error();
+                const [, file, line] = error.stack.split('\n').at(0).match(
+                    /^[^@]*@(.*):(\d+):\d+$/);
+
+                expect(writer_func).toHaveBeenCalledOnceWith(
+                    GLib.LogLevelFlags.LEVEL_WARNING,
+                    objectContainingLogMessage('a warning', {
+                        CODE_FILE: decodedStringMatching(RegExp.escape(file)),
+                        CODE_LINE: decodedStringMatching(`^${line}$`),
+                        CODE_FUNC: decodedStringMatching('^warnTwice$'),
+                    })
+                );
+                writer_func.calls.reset();
+            }
+        }
+        warnTwice();
+    });
+
     it('logs an informative message', function () {
         console.info('an informative message');
 
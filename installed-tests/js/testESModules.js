@@ -219,6 +219,14 @@ describe('Dynamic imports', function () {
         }
     });
 
+    it('consistently rejects a missing bare specifier on repeated imports', async function () {
+        for (let i = 0; i < 2; i++) {
+            // eslint-disable-next-line no-await-in-loop
+            await expectAsync(import('doesNotExistAnywhere'))
+                .toBeRejectedWith(jasmine.objectContaining({name: 'ImportError'}));
+        }
+    });
+
     it('rejects imports from a nonsense URI scheme', async function () {
         await expectAsync(import('scary:///module.js'))
             .toBeRejectedWith(jasmine.objectContaining({name: 'ImportError'}));
@@ -74,6 +74,15 @@ class Test {
         }))();
     }
 
+    throwThenReturnAsync(_parameters, invocation) {
+        GLib.idle_add(GLib.PRIORITY_DEFAULT, () => {
+            // This should be a no-op, the error was already returned
+            invocation.return_value(new GLib.Variant('(s)', ['Too late!']));
+            return GLib.SOURCE_REMOVE;
+        });
+        throw Error('Oh no!');
+    }
+
     thisDoesNotExist() {
         // We'll remove this later!
     }
@@ -450,6 +459,19 @@ describe('Exported DBus object', function () {
         expect(result).toBe('I\'m going to fail soon!');
     });
 
+    it('reports where an invocation that threw was already returned', async function () {
+        GLib.test_expect_message('Gjs', GLib.LogLevelFlags.LEVEL_WARNING,
+            'JS ERROR: Exception in method call: throwThenReturn: *Oh no!*');
+        GLib.test_expect_message('Gjs', GLib.LogLevelFlags.LEVEL_WARNING,
+            'JS ERROR: [object *] (throwThenReturn) already returned @*');
+
+        await expectAsync(proxy.throwThenReturnAsync()).toBeRejected();
+        await new Promise(resolve => GLib.idle_add(GLib.PRIORITY_LOW, () => {
+            resolve();
+            return GLib.SOURCE_REMOVE;
+        }));
+    });
+
     it('can still destructure the return value when an exception is thrown', function () {
         GLib.test_expect_message('Gjs', GLib.LogLevelFlags.LEVEL_WARNING,
             'JS ERROR: Exception in method call: alwaysThrowException: *');
@@ -492,6 +514,19 @@ describe('Exported DBus object', function () {
         await expectAsync(proxy.thisDoesNotExistAsync()).toBeRejected();
     });
 
+    it('returns an unknown method error for a missing handler', async function () {
+        delete Test.prototype.thisDoesNotExist;
+
+        GLib.test_expect_message('Gjs', GLib.LogLevelFlags.LEVEL_WARNING,
+            'JS ERROR: Missing handler for DBus method thisDoesNotExist: *');
+
+        await expectAsync(proxy.thisDoesNotExistAsync()).toBeRejectedWith(
+            jasmine.objectContaining({
+                domain: Gio.DBusError,
+                code: Gio.DBusError.UNKNOWN_METHOD,
+            }));
+    });
+
     it('can pass a parameter to a remote method that is not a JSON object', function () {
         proxy.nonJsonFrobateStuffRemote(42, ([result], excp) => {
             expect(result).toEqual('42 it is!');
@@ -534,6 +569,29 @@ describe('Exported DBus object', function () {
         expect(result).toEqual('1 2 3 4 5');
     });
 
+    it('throws an exception when passing too few in parameters to a remote method', function () {
+        expect(() => proxy.multipleInArgsRemote(1, 2, () => {}))
+            .toThrowError(/Not enough arguments passed for method: multipleInArgs/);
+    });
+
+    it('rejects the promise when passing too few in parameters to an async method', async function () {
+        await expectAsync(proxy.multipleInArgsAsync(1, 2))
+            .toBeRejectedWithError(/Not enough arguments passed/);
+    });
+
+    it('throws an exception when passing an invalid extra argument', function () {
+        expect(() => proxy.noInParameterRemote('foo'))
+            .toThrowError(/Argument 0 of method noInParameter/);
+    });
+
+    it('shares the methods of proxies created from the same wrapper', async function () {
+        const otherProxy = await ProxyClass.newAsync(Gio.DBus.session,
+            'org.gnome.gjs.Test', '/org/gnome/gjs/Test');
+        expect(otherProxy.frobateStuffAsync).toBe(proxy.frobateStuffAsync);
+        const [{hello}] = await otherProxy.frobateStuffAsync({});
+        expect(hello.deepUnpack()).toEqual('world');
+    });
+
     it('can call a remote method with no return value', function () {
         proxy.noReturnValueRemote(([result], excp) => {
             expect(result).not.toBeDefined();
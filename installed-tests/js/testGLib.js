@@ -77,6 +77,21 @@ describe('GVariant constructor', function () {
             .toEqual('pizza');
     });
 
+    it('constructs a byte array variant from a GLib.Bytes', function () {
+        const bytes = new GLib.Bytes(new TextEncoder().encode('pizza'));
+        const byteArrayVariant = new GLib.Variant('ay', bytes);
+        expect(new TextDecoder().decode(byteArrayVariant.deepUnpack()))
+            .toEqual('pizza');
+    });
+
+    it('keeps working with more signatures than fit in the cache', function () {
+        for (let n = 1; n <= 300; n++) {
+            const variant = new GLib.Variant(`(${'u'.repeat(n)})`,
+                new Array(n).fill(n));
+            expect(variant.n_children()).toBe(n);
+        }
+    });
+
     it('constructs a byte array variant from a string', function () {
         const byteArrayVariant = new GLib.Variant('ay', 'pizza');
         expect(new TextDecoder().decode(byteArrayVariant.deepUnpack()))
@@ -101,6 +116,36 @@ describe('GVariant constructor', function () {
     it('fails to construct an incomplete array variant', function () {
         expect(() => new GLib.Variant('a', [])).toThrowError(/GVariant signature/);
     });
+
+    it('fails to construct a variant with trailing types', function () {
+        expect(() => new GLib.Variant('ss', 'a')).toThrowError(TypeError, /GVariant signature/);
+    });
+
+    it('can reuse a signature after it was used with a wrong value', function () {
+        expect(() => new GLib.Variant('(iu)', [1, -1])).toThrowError(RangeError);
+        expect(new GLib.Variant('(iu)', [1, 2]).deepUnpack()).toEqual([1, 2]);
+    });
+
+    it('fails to construct a tuple variant with too few elements', function () {
+        expect(() => new GLib.Variant('(ss)', ['a'])).toThrowError(TypeError);
+    });
+
+    it('fails to construct an invalid object path variant', function () {
+        expect(() => new GLib.Variant('o', 'not a path')).toThrowError(TypeError);
+    });
+
+    it('constructs a dictionary variant with integer keys', function () {
+        const v = new GLib.Variant('a{ib}', {1: true, 2: false});
+        expect(v.deepUnpack()).toEqual({1: true, 2: false});
+    });
+
+    it('constructs a nested variant', function () {
+        const v = new GLib.Variant('a{sa(xmd)}', {
+            foo: [[-1, 0.5], [2 ** 40, null]],
+        });
+        expect(v.get_type_string()).toEqual('a{sa(xmd)}');
+        expect(v.deepUnpack()).toEqual({foo: [[-1, 0.5], [2 ** 40, null]]});
+    });
 });
 
 describe('GVariant unpack', function () {
@@ -118,6 +163,63 @@ describe('GVariant unpack', function () {
         expect(v.recursiveUnpack().foo instanceof GLib.Variant).toBeFalsy();
         expect(v.recursiveUnpack().foo).toEqual('bar');
     });
+
+    it('shallow leaves the children packed', function () {
+        const array = new GLib.Variant('ai', [1, 2, 3]).unpack();
+        expect(array.length).toBe(3);
+        expect(array[0] instanceof GLib.Variant).toBeTruthy();
+        expect(array[0].unpack()).toBe(1);
+    });
+
+    it('shallow unpacks dictionary keys', function () {
+        const dict = new GLib.Variant('a{ui}', {7: 8}).unpack();
+        expect(dict[7].unpack()).toBe(8);
+    });
+
+    it('deep unpacks arrays of fixed-size numbers', function () {
+        expect(new GLib.Variant('an', [-1, 2]).deepUnpack()).toEqual([-1, 2]);
+        expect(new GLib.Variant('at', [2 ** 53 - 1]).deepUnpack()).toEqual([2 ** 53 - 1]);
+        expect(new GLib.Variant('ad', [0.25, -Infinity]).deepUnpack())
+            .toEqual([0.25, -Infinity]);
+        expect(new GLib.Variant('au', []).deepUnpack()).toEqual([]);
+    });
+});
+
+describe('GVariant typed arrays', function () {
+    it('converts fixed-size number arrays to typed arrays', function () {
+        expect(new GLib.Variant('ad', [0.5, -2]).toTypedArray())
+            .toEqual(Float64Array.of(0.5, -2));
+        expect(new GLib.Variant('an', [-1, 1]).toTypedArray())
+            .toEqual(Int16Array.of(-1, 1));
+        expect(new GLib.Variant('at', [2 ** 60]).toTypedArray())
+            .toEqual(BigUint64Array.of(2n ** 60n));
+        expect(new GLib.Variant('ay', []).toTypedArray()).toEqual(new Uint8Array());
+    });
+
+    it('does not convert other types to typed arrays', function () {
+        expect(() => new GLib.Variant('as', ['a']).toTypedArray()).toThrowError(TypeError);
+        expect(() => new GLib.Variant('i', 1).toTypedArray()).toThrowError(TypeError);
+    });
+
+    it('packs typed arrays of the matching type', function () {
+        const samples = Float64Array.of(1.5, NaN, -0);
+        const v = new GLib.Variant('ad', samples);
+        samples[0] = 3;
+        expect(v.deepUnpack()).toEqual([1.5, NaN, -0]);
+
+        expect(new GLib.Variant('ax', BigInt64Array.of(-5n)).deepUnpack()).toEqual([-5]);
+        expect(new GLib.Variant('au', new Uint32Array(0)).n_children()).toBe(0);
+    });
+
+    it('packs a view into a larger buffer', function () {
+        const buffer = Int32Array.of(1, 2, 3, 4).buffer;
+        const v = new GLib.Variant('ai', new Int32Array(buffer, 4, 2));
+        expect(v.deepUnpack()).toEqual([2, 3]);
+    });
+
+    it('packs typed arrays of a different type element by element', function () {
+        expect(new GLib.Variant('ai', Float64Array.of(1, 2)).deepUnpack()).toEqual([1, 2]);
+    });
 });
 
 describe('GVariant strv', function () {
@@ -172,6 +274,50 @@ describe('GLib spawn processes', function () {
     });
 });
 
+describe('GLib functions called in a thread', function () {
+    it('resolve with the return value', async function () {
+        const path = GLib.build_filenamev([GLib.get_tmp_dir(), 'gjs-thread-test']);
+        GLib.file_set_contents(path, 'contents');
+        const [ok, contents] = await GLib.file_get_contents.callInThread(path);
+        expect(ok).toBeTrue();
+        expect(new TextDecoder().decode(contents)).toEqual('contents');
+        GLib.unlink(path);
+    });
+
+    it('reject with a thrown GError', async function () {
+        await expectAsync(GLib.file_get_contents.callInThread('/nonexistent'))
+            .toBeRejectedWith(jasmine.objectContaining({
+                domain: GLib.FileError,
+                code: GLib.FileError.NOENT,
+            }));
+    });
+
+    it('pass all the arguments to functions that are not methods', async function () {
+        const path = GLib.build_filenamev([GLib.get_tmp_dir(), 'gjs-thread-test-2']);
+        GLib.file_set_contents(path, 'abc');
+        const [, contents] = await GLib.file_get_contents.callInThread(path);
+        expect(contents.length).toBe(3);
+        GLib.unlink(path);
+
+        expect(() => GLib.file_get_contents.callInThread())
+            .toThrowError(/argument/);
+    });
+
+    it('take the instance of a method as the first argument', async function () {
+        const keyFile = new GLib.KeyFile();
+        keyFile.set_string('group', 'key', 'value');
+        const value = await keyFile.get_string.callInThread(keyFile, 'group',
+            'key');
+        expect(value).toEqual('value');
+    });
+
+    it('refuse functions that take callbacks', function () {
+        expect(() => GLib.spawn_async.callInThread(null, ['true'], null,
+            GLib.SpawnFlags.SEARCH_PATH, null))
+            .toThrowError(/callback/);
+    });
+});
+
 describe('GLib source function overrides', function () {
     let loop, spy;
 
@@ -37,6 +37,56 @@ describe('ListStore iterator', function () {
         for (let f of list)
             expect(f.value).toBe(i++);
     });
+
+    it('iterates over more items than fit in one batch', function () {
+        for (let i = 100; i < 1000; i++)
+            list.append(new Foo(i));
+        expect(Array.from(list, f => f.value)).toEqual([...Array(1000).keys()]);
+    });
+
+    it('sees changes made during iteration from the next batch on', function () {
+        for (let i = 100; i < 600; i++)
+            list.append(new Foo(i));
+        const values = [];
+        for (const f of list) {
+            values.push(f.value);
+            if (f.value === 10) {
+                list.remove(300);
+                list.insert(300, new Foo(-1));
+                list.append(new Foo(600));
+            }
+        }
+        expect(values.length).toBe(601);
+        expect(values[300]).toBe(-1);
+        expect(values.at(-1)).toBe(600);
+    });
+
+    it('stops at the end of the list after a batch in which items were removed', function () {
+        for (let i = 100; i < 300; i++)
+            list.append(new Foo(i));
+        const values = [];
+        for (const f of list) {
+            values.push(f.value);
+            if (f.value === 0)
+                list.splice(250, 50, []);
+        }
+        expect(values.length).toBe(256);
+    });
+
+    it('does not connect to the list while iterating', function () {
+        const signalId = GObject.signal_lookup('items-changed', Gio.ListModel);
+        const iter = list[Symbol.iterator]();
+        iter.next();
+        expect(GObject.signal_has_handler_pending(list, signalId, 0, false))
+            .toBeFalse();
+    });
+
+    it('fetches a range of items at once', function () {
+        expect(list.getItems(10, 3).map(f => f.value)).toEqual([10, 11, 12]);
+        expect(list.getItems(98, 5).map(f => f.value)).toEqual([98, 99]);
+        expect(list.getItems(100, 5)).toEqual([]);
+        expect(list.getItems(0, 100)[42]).toBe(list.get_item(42));
+    });
 });
 
 function compareFunc(a, b) {
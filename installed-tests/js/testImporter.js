@@ -273,3 +273,44 @@ describe('Importer', function () {
         expect(response).toBe('<( I did it! )');
     });
 });
+
+describe('Importer search path directory cache', function () {
+    const {GLib} = imports.gi;
+    let oldSearchPath, tmpdir;
+
+    beforeAll(function () {
+        oldSearchPath = imports.searchPath.slice();
+        tmpdir = GLib.dir_make_tmp('gjs-importer-XXXXXX');
+        const subdir = GLib.build_filenamev([tmpdir, 'withInit']);
+        GLib.mkdir_with_parents(subdir, 0o755);
+        GLib.file_set_contents(GLib.build_filenamev([subdir, '__init__.js']),
+            'var initValue = 7;');
+        imports.searchPath = [tmpdir];
+    });
+
+    afterAll(function () {
+        imports.searchPath = oldSearchPath;
+        GLib.unlink(GLib.build_filenamev([tmpdir, 'addedLater.js']));
+        GLib.unlink(GLib.build_filenamev([tmpdir, 'withInit', '__init__.js']));
+        GLib.rmdir(GLib.build_filenamev([tmpdir, 'withInit']));
+        GLib.rmdir(tmpdir);
+    });
+
+    it('loads __init__.js of a subdirectory', function () {
+        expect(imports.withInit.initValue).toBe(7);
+    });
+
+    it('still throws for names that are only probed', function () {
+        expect(() => imports.then)
+            .toThrow(jasmine.objectContaining({name: 'ImportError'}));
+    });
+
+    it('finds a module added after the directory was searched', function () {
+        expect(() => imports.addedLater)
+            .toThrow(jasmine.objectContaining({name: 'ImportError'}));
+
+        GLib.file_set_contents(GLib.build_filenamev([tmpdir, 'addedLater.js']),
+            'var value = 42;');
+        expect(imports.addedLater.value).toBe(42);
+    });
+});
@@ -6,6 +6,7 @@
 // SPDX-FileCopyrightText: 2019 Canonical, Ltd.
 
 import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
 import GObject from 'gi://GObject';
 import System from 'system';
 
@@ -68,6 +69,14 @@ describe('System.dumpMemoryInfo()', function () {
     });
 });
 
+describe('System.dumpCallStats()', function () {
+    it('throws if call statistics are not enabled', function () {
+        if (GLib.getenv('GJS_CALL_STATS'))
+            pending('GJS_CALL_STATS is set');
+        expect(() => System.dumpCallStats()).toThrowError(/GJS_CALL_STATS/);
+    });
+});
+
 describe('System.programPath', function () {
     it('is null when executed from minijasmine', function () {
         expect(System.programPath).toBe(null);
@@ -90,3 +99,130 @@ describe('System.programArgs', function () {
         expect(System.programArgs.pop()).toBe('--foo');
     });
 });
+
+describe('System event loop monitor', function () {
+    afterEach(function () {
+        System.stopEventLoopMonitor();
+    });
+
+    it('records main loop delays', async function () {
+        System.startEventLoopMonitor(1);
+        await new Promise(resolve => GLib.timeout_add(GLib.PRIORITY_DEFAULT, 5, () => {
+            // Block the main loop for a while
+            const end = GLib.get_monotonic_time() + 20000;
+            while (GLib.get_monotonic_time() < end);
+            resolve();
+            return GLib.SOURCE_REMOVE;
+        }));
+        await new Promise(resolve => GLib.timeout_add(GLib.PRIORITY_DEFAULT, 5, () => {
+            resolve();
+            return GLib.SOURCE_REMOVE;
+        }));
+
+        const delay = System.getEventLoopDelay();
+        expect(delay.count).toBeGreaterThan(0);
+        expect(delay.max).toBeGreaterThanOrEqual(15);
+        expect(delay.min).toBeLessThanOrEqual(delay.mean);
+        expect(delay.percentiles['50']).toBeLessThanOrEqual(delay.percentiles['99']);
+        expect(delay.resolution).toBe(1);
+
+        const elu = System.getEventLoopUtilization();
+        expect(elu.active).toBeGreaterThanOrEqual(15);
+        expect(elu.utilization).toBeGreaterThan(0);
+        expect(elu.utilization).toBeLessThanOrEqual(1);
+    });
+
+    it('can be reset', function () {
+        System.startEventLoopMonitor();
+        System.resetEventLoopMonitor();
+        expect(System.getEventLoopDelay().count).toBe(0);
+    });
+
+    it('rejects an invalid resolution', function () {
+        expect(() => System.startEventLoopMonitor(0)).toThrowError(/resolution/);
+    });
+});
+
+describe('System signal statistics', function () {
+    let action;
+
+    beforeEach(function () {
+        action = new Gio.SimpleAction({name: 'test'});
+        System.startSignalStats();
+        System.resetSignalStats();
+    });
+
+    afterEach(function () {
+        System.stopSignalStats();
+    });
+
+    function findEntry(signal) {
+        return System.getSignalStats().find(entry =>
+            entry.type === 'GSimpleAction' && entry.signal === signal);
+    }
+
+    it('counts handler calls, whoever emits the signal', function () {
+        action.connect('activate', () => {});
+        action.activate(null);
+        action.emit('activate', null);
+
+        const entry = findEntry('activate');
+        expect(entry.handlerCalls).toBe(2);
+        expect(entry.emissions).toBe(1);
+        expect(entry.handlerTime).toBeGreaterThanOrEqual(0);
+    });
+
+    it('counts each detail separately', function () {
+        action.connect('notify::enabled', () => {});
+        action.connect('notify::state', () => {});
+        action.enabled = false;
+
+        expect(findEntry('notify::enabled').handlerCalls).toBe(1);
+        expect(findEntry('notify::state')).toBeUndefined();
+    });
+
+    it('can be reset and stopped', function () {
+        action.connect('activate', () => {});
+        action.activate(null);
+        System.resetSignalStats();
+        expect(findEntry('activate')).toBeUndefined();
+
+        System.stopSignalStats();
+        action.activate(null);
+        expect(findEntry('activate')).toBeUndefined();
+    });
+});
+
+describe('System.getMetrics()', function () {
+    it('returns the runtime counters', function () {
+        const object = new GObject.Object();
+        const metrics = System.getMetrics();
+
+        expect(metrics.counters.object_instance).toBeGreaterThan(0);
+        expect(metrics.counters.everything).toBeGreaterThanOrEqual(
+            metrics.counters.object_instance);
+        expect(metrics.gc.heapBytes).toBeGreaterThan(0);
+        expect(metrics.gc.mallocBytes).toBeGreaterThanOrEqual(0);
+        expect(metrics.gc.majorCount).toBeGreaterThanOrEqual(0);
+        expect(metrics.wrappedGObjects).toBeGreaterThan(0);
+        expect(metrics.toggleQueueLength).toBeGreaterThanOrEqual(0);
+        expect(metrics.pendingMicrotasks).toBeGreaterThanOrEqual(0);
+        expect(object).toBeDefined();
+    });
+
+    it('counts garbage collections', function () {
+        const before = System.getMetrics().gc.majorCount;
+        System.gc();
+        expect(System.getMetrics().gc.majorCount).toBeGreaterThan(before);
+    });
+
+    it('includes the event loop statistics once the monitor was started', function () {
+        System.startEventLoopMonitor();
+        const {eventLoop} = System.getMetrics();
+        System.stopEventLoopMonitor();
+
+        expect(eventLoop.delayCount).toBeGreaterThanOrEqual(0);
+        expect(eventLoop.utilization).toBeGreaterThanOrEqual(0);
+        expect(eventLoop.utilization).toBeLessThanOrEqual(1);
+    });
+});
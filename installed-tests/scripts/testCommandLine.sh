@@ -135,6 +135,55 @@ while (f = iter.next_file(null)) {
 }
 EOF
 
+# this script prints numbered lines, and then ends either normally, with
+# System.exit() right away, or with System.exit() from the main loop
+cat <<'EOF' >bufferedoutput.js
+const {GLib} = imports.gi;
+const System = imports.system;
+for (let i = 1; i <= 1000; i++)
+    print(i);
+printerr('stderr');
+if (ARGV[0] === 'exit') {
+    System.exit(0);
+} else if (ARGV[0] === 'mainloop') {
+    const loop = new GLib.MainLoop(null, false);
+    GLib.idle_add(GLib.PRIORITY_DEFAULT, () => {
+        print('from main loop');
+        System.exit(0);
+        return GLib.SOURCE_REMOVE;
+    });
+    loop.run();
+}
+EOF
+
+# this script emits a signal from another thread, which should only be handled
+# once the main loop runs, if GJS_FORWARD_THREAD_CALLBACKS is set
+cat <<EOF >crossthread.js
+import GjsTestTools from 'gi://GjsTestTools';
+import GLib from 'gi://GLib';
+import GObject from 'gi://GObject';
+
+const Emitter = GObject.registerClass({
+    Signals: {'test': {}},
+}, class Emitter extends GObject.Object {});
+
+const emitter = new Emitter();
+const loop = new GLib.MainLoop(null, false);
+let calls = 0;
+emitter.connect('test', () => {
+    calls++;
+    loop.quit();
+});
+GjsTestTools.emit_test_signal_other_thread(emitter);
+print(\`before main loop: \${calls}\`);
+GLib.timeout_add_seconds(GLib.PRIORITY_DEFAULT, 5, () => {
+    loop.quit();
+    return GLib.SOURCE_REMOVE;
+});
+loop.run();
+print(\`after main loop: \${calls}\`);
+EOF
+
 total=0
 
 report () {
@@ -299,6 +348,10 @@ if $gjs --profile -c 1 2>&1 | grep -q 'Gjs-Message.*Profiler is disabled'; then
     skip "--profile should dump profiling data to the default file name" "$reason"
     skip "--profile with argument should dump profiling data to the named file" "$reason"
     skip "GJS_ENABLE_PROFILER=1 should enable the profiler" "$reason"
+    skip "--profile-format=gecko should write a Gecko profile" "$reason"
+    skip "--convert-profile should convert a capture to a Gecko profile" "$reason"
+    skip "GJS_PROFILER_ALLOCATIONS should record allocations" "$reason"
+    skip "GJS_PROFILER_ALLOCATIONS=0 should turn allocations off without a warning" "$reason"
 else
     rm -f gjs-*.syscap
     $gjs --profile -c 'imports.system.exit(0)' && stat gjs-*.syscap > /dev/null 2>&1
@@ -310,8 +363,40 @@ else
     GJS_ENABLE_PROFILER=1 $gjs -c 'imports.system.exit(0)' && stat gjs-*.syscap > /dev/null 2>&1
     report "GJS_ENABLE_PROFILER=1 should enable the profiler"
     rm -f gjs-*.syscap
+    $gjs --profile=foo.json --profile-format=gecko -c 'imports.system.exit(0)' && grep -q '"meta"' foo.json
+    report "--profile-format=gecko should write a Gecko profile"
+    rm -f foo.json
+    $gjs --profile=foo.syscap -c 'imports.system.exit(0)' && $gjs --convert-profile=foo.syscap && grep -q '"meta"' foo.json
+    report "--convert-profile should convert a capture to a Gecko profile"
+    rm -f foo.syscap foo.json
+    GJS_PROFILER_ALLOCATIONS=1 $gjs --profile=foo.syscap -c 'const a = [{}, []]; imports.system.exit(0)' && grep -aq 'JS Object' foo.syscap
+    report "GJS_PROFILER_ALLOCATIONS should record allocations"
+    rm -f foo.syscap
+    output=$(GJS_PROFILER_ALLOCATIONS=0 $gjs --profile=foo.syscap -c 'const a = [{}, []]; imports.system.exit(0)' 2>&1)
+    test -z "$output" && ! grep -aq 'JS Object' foo.syscap
+    report "GJS_PROFILER_ALLOCATIONS=0 should turn allocations off without a warning"
+    rm -f foo.syscap
 fi
 
+! $gjs --profile --profile-format=bogus -c 1 2>/dev/null
+report "--profile-format should reject unknown formats"
+
+# GJS_PERF_MAP
+pid=$(GJS_PERF_MAP=1 $gjs -c 'const {GLib, Gio} = imports.gi;
+    GLib.idle_add(GLib.PRIORITY_DEFAULT, () => GLib.SOURCE_REMOVE);
+    print(new Gio.Credentials().get_unix_pid());')
+test -n "$pid" && grep -q 'GJS callback GLib.SourceFunc' "/tmp/perf-$pid.map"
+report "GJS_PERF_MAP should write GI callback trampolines to the perf map"
+test -z "$pid" || rm -f "/tmp/perf-$pid.map"
+
+# GJS_CALL_STATS
+output=$(GJS_CALL_STATS=stderr $gjs -c 'imports.gi.GLib.get_user_name()' 2>&1)
+test -n "$output" -a -z "${output##*function GLib.get_user_name*}"
+report "GJS_CALL_STATS should report calls into GI functions"
+GJS_CALL_STATS=1 $gjs -c 'imports.system.dumpCallStats("foo.txt")' && grep -q 'GI call statistics' foo.txt
+report "System.dumpCallStats() should write GI call statistics"
+rm -f foo.txt
+
 # interpreter handles queued promise jobs correctly
 output=$($gjs promise.js)
 test $? -eq 42
@@ -392,7 +477,45 @@ output=$(LC_ALL=ar_EG $gjs int.js)
 test "$output" = "0666 0660"
 report "%Id prints Arabic digits in ar_EG locale $output"
 
+# GJS_FORWARD_THREAD_CALLBACKS
+if test "$GJS_USE_UNINSTALLED_FILES" = "1"; then
+    test_tools_dir="$TOP_BUILDDIR/installed-tests/js/libgjstesttools"
+else
+    # The test tools library is installed next to the scripts directory
+    test_tools_dir="$(dirname "$0")/.."
+fi
+output=$(GJS_FORWARD_THREAD_CALLBACKS=1 \
+    GI_TYPELIB_PATH="$test_tools_dir${GI_TYPELIB_PATH:+:$GI_TYPELIB_PATH}" \
+    LD_LIBRARY_PATH="$test_tools_dir${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}" \
+    $gjs -m crossthread.js)
+test "$output" = "before main loop: 0
+after main loop: 1"
+report "GJS_FORWARD_THREAD_CALLBACKS should run handlers of signals emitted on another thread on the main thread"
+
+# console.debug() messages that GLib's default writer would drop
+output=$(env -u G_MESSAGES_DEBUG $gjs -c "console.debug('%s', {toString() { print('formatted'); }})" 2>&1)
+test -z "$output"
+report "console.debug() should not format messages that would not be shown"
+output=$(G_MESSAGES_DEBUG=Gjs-Console $gjs -c "console.debug('%s', {toString() { return 'formatted'; }})" 2>&1)
+echo "$output" | grep -q 'Gjs-Console-DEBUG.*formatted'
+report "console.debug() should show messages if G_MESSAGES_DEBUG asks for them"
+
+# GJS_BUFFERED_OUTPUT
+for threshold in 1 100; do
+    for ending in normal exit; do
+        output=$(GJS_BUFFERED_OUTPUT=$threshold $gjs bufferedoutput.js $ending 2>/dev/null)
+        test "$output" = "$(seq 1 1000)"
+        report "GJS_BUFFERED_OUTPUT=$threshold should write all output in order on $ending exit"
+        output=$(GJS_BUFFERED_OUTPUT=$threshold $gjs bufferedoutput.js $ending 2>&1 >/dev/null)
+        test "$output" = "stderr"
+        report "GJS_BUFFERED_OUTPUT=$threshold should write error output on $ending exit"
+    done
+done
+output=$(GJS_BUFFERED_OUTPUT=1 $gjs bufferedoutput.js mainloop 2>/dev/null)
+test "$output" = "$(seq 1 1000; echo 'from main loop')"
+report "GJS_BUFFERED_OUTPUT should write output from the main loop before System.exit()"
+
 rm -f exit.js help.js promise.js awaitcatch.js doublegi.js argv.js int.js \
-    signalexit.js promiseexit.js
+    signalexit.js promiseexit.js crossthread.js bufferedoutput.js
 
 echo "1..$total"
@@ -88,6 +88,13 @@ $gjs -m dynamicTopLevelAwait.js
 test $? -eq 32
 report "ensure top level await can import modules"
 
+output=$(GJS_IMPORT_TIMINGS=stderr $gjs -m dynamicTopLevelAwait.js 2>&1)
+test -n "$output" -a -z "${output##*Import timings*}"
+report "GJS_IMPORT_TIMINGS should print an import timing report"
+test -z "${output##*dynamicTopLevelAwaitImportee.js*}"
+report "import timing report should include dynamically imported modules"
+! echo "$output" | grep -q ' \./dynamicTopLevelAwaitImportee\.js$'
+report "import timing report should list dynamic imports under their resolved URI"
 
 rm -f doubledynamic.js doubledynamicImportee.js \
       dynamicImplicitMainloop.js dynamicImplicitMainloopImportee.js \
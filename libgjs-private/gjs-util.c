@@ -431,6 +431,7 @@ void gjs_gtk_custom_sorter_set_sort_func(GObject* sorter,
     g_clear_object(&repo);
 }
 
+static bool log_writer_assumed_default = false;
 static bool log_writer_cleared = false;
 static void* log_writer_user_data = NULL;
 static GDestroyNotify log_writer_user_data_free = NULL;
@@ -531,6 +532,35 @@ void gjs_log_set_writer_func(GjsGLogWriterFunc func, void* user_data,
     g_log_set_writer_func(gjs_log_writer_func_wrapper, func, NULL);
 }
 
+/**
+ * gjs_log_writer_assume_default: (skip)
+ *
+ * Tells GJS that the program has not installed a writer function with
+ * g_log_set_writer_func() itself, which GLib provides no way to check. Only
+ * programs may install writer functions, so this is for the program to call,
+ * as the gjs interpreter does.
+ */
+void gjs_log_writer_assume_default(void) { log_writer_assumed_default = true; }
+
+/**
+ * gjs_log_writer_is_default: (skip)
+ *
+ * Checks whether structured log messages logged from the current thread are
+ * handled by GLib's default writer, rather than a function set with
+ * gjs_log_set_writer_func(). Unless the program has called
+ * gjs_log_writer_assume_default(), a writer function may have been installed
+ * with g_log_set_writer_func() directly, so this returns %FALSE.
+ *
+ * Returns: %TRUE if log messages go to the default writer
+ */
+gboolean gjs_log_writer_is_default(void) {
+    if (!log_writer_assumed_default)
+        return false;
+
+    return !log_writer_thread || log_writer_cleared ||
+           g_thread_self() != log_writer_thread;
+}
+
 /**
  * gjs_clear_terminal:
  *
@@ -69,6 +69,11 @@ void gjs_log_set_writer_func(GjsGLogWriterFunc func, void* user_data,
 GJS_EXPORT
 void gjs_log_set_writer_default(void);
 
+GJS_EXPORT
+void gjs_log_writer_assume_default(void);
+
+gboolean gjs_log_writer_is_default(void);
+
 /* For imports.gettext */
 typedef enum {
     GJS_LOCALE_CATEGORY_ALL = LC_ALL,
@@ -7,7 +7,10 @@
 #include <stddef.h>  // for size_t
 #include <stdint.h>
 
+#include <array>
+#include <iterator>  // for size
 #include <memory>
+#include <tuple>  // for apply
 
 #include <cairo.h>
 #include <girepository/girepository.h>
@@ -16,6 +19,9 @@
 #include <js/Array.h>  // for JS::NewArrayObject
 #include <js/CallArgs.h>
 #include <js/Conversions.h>
+#include <js/Exception.h>  // for JS_ClearPendingException
+#include <js/ErrorReport.h>  // for JSEXN_TYPEERR
+#include <js/GCAPI.h>        // for AutoCheckCannotGC
 #include <js/MemoryFunctions.h>  // for RemoveAssociatedMemory
 #include <js/Object.h>           // for GetReservedSlot, SetReservedSlot
 #include <js/PropertyAndElement.h>
@@ -25,7 +31,9 @@
 #include <js/TypeDecls.h>
 #include <js/Utility.h>  // for UniqueChars
 #include <js/Value.h>
+#include <js/experimental/TypedData.h>
 #include <jsapi.h>  // for JS_NewPlainObject
+#include <mozilla/Maybe.h>
 
 #include "gi/arg-inl.h"
 #include "gi/arg.h"
@@ -39,6 +47,8 @@
 #include "modules/cairo-memory.h"
 #include "modules/cairo-private.h"
 
+using mozilla::Maybe, mozilla::Some;
+
 #define GJS_CAIRO_CONTEXT_GET_PRIV_CR_CHECKED(cx, argc, vp, argv, obj) \
     GJS_GET_THIS(cx, argc, vp, argv, obj);                             \
     cairo_t* cr;                                                       \
@@ -163,16 +173,6 @@
     argv.rval().setUndefined();                                    \
     GJS_CAIRO_CONTEXT_DEFINE_FUNC_END
 
-#define GJS_CAIRO_CONTEXT_DEFINE_FUNC2(method, cfunc, fmt, t1, n1, t2, n2)    \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_BEGIN(method)                               \
-    t1 arg1;                                                                  \
-    t2 arg2;                                                                  \
-    if (!gjs_parse_call_args(cx, #method, argv, fmt, #n1, &arg1, #n2, &arg2)) \
-        return false;                                                         \
-    cfunc(cr, arg1, arg2);                                                    \
-    argv.rval().setUndefined();                                               \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_END
-
 #define GJS_CAIRO_CONTEXT_DEFINE_FUNC2B(method, cfunc, fmt, t1, n1, t2, n2)   \
     GJS_CAIRO_CONTEXT_DEFINE_FUNC_BEGIN(method)                               \
     t1 arg1;                                                                  \
@@ -183,61 +183,45 @@
     argv.rval().setBoolean(ret);                                              \
     GJS_CAIRO_CONTEXT_DEFINE_FUNC_END
 
-#define GJS_CAIRO_CONTEXT_DEFINE_FUNC3(method, cfunc, fmt, t1, n1, t2, n2, t3, \
-                                       n3)                                     \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_BEGIN(method)                                \
-    t1 arg1;                                                                   \
-    t2 arg2;                                                                   \
-    t3 arg3;                                                                   \
-    if (!gjs_parse_call_args(cx, #method, argv, fmt, #n1, &arg1, #n2, &arg2,   \
-                             #n3, &arg3))                                      \
-        return false;                                                          \
-    cfunc(cr, arg1, arg2, arg3);                                               \
-    argv.rval().setUndefined();                                                \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_END
-
-#define GJS_CAIRO_CONTEXT_DEFINE_FUNC4(method, cfunc, fmt, t1, n1, t2, n2, t3, \
-                                       n3, t4, n4)                             \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_BEGIN(method)                                \
-    t1 arg1;                                                                   \
-    t2 arg2;                                                                   \
-    t3 arg3;                                                                   \
-    t4 arg4;                                                                   \
-    if (!gjs_parse_call_args(cx, #method, argv, fmt, #n1, &arg1, #n2, &arg2,   \
-                             #n3, &arg3, #n4, &arg4))                          \
-        return false;                                                          \
-    cfunc(cr, arg1, arg2, arg3, arg4);                                         \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_END
+// Hot drawing methods such as moveTo() and setSourceRGBA() take only numbers,
+// and can be called tens of thousands of times per frame. Their arguments are
+// converted here rather than by gjs_parse_call_args(), whose format string
+// parsing is a large part of the cost of such a call. The errors are the same.
+template <size_t N>
+GJS_JSAPI_RETURN_CONVENTION static bool parse_number_args(
+    JSContext* cx, const char* method, const JS::CallArgs& args,
+    const char* const (&names)[N], std::array<double, N>* out) {
+    if (!args.requireAtLeast(cx, method, N))
+        return false;
+    if (args.length() > N) {
+        gjs_throw(cx, "Error invoking %s: Expected %zu arguments, got %u",
+                  method, N, args.length());
+        return false;
+    }
 
-#define GJS_CAIRO_CONTEXT_DEFINE_FUNC5(method, cfunc, fmt, t1, n1, t2, n2, t3, \
-                                       n3, t4, n4, t5, n5)                     \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_BEGIN(method)                                \
-    t1 arg1;                                                                   \
-    t2 arg2;                                                                   \
-    t3 arg3;                                                                   \
-    t4 arg4;                                                                   \
-    t5 arg5;                                                                   \
-    if (!gjs_parse_call_args(cx, #method, argv, fmt, #n1, &arg1, #n2, &arg2,   \
-                             #n3, &arg3, #n4, &arg4, #n5, &arg5))              \
-        return false;                                                          \
-    cfunc(cr, arg1, arg2, arg3, arg4, arg5);                                   \
-    argv.rval().setUndefined();                                                \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_END
+    for (size_t ix = 0; ix < N; ix++) {
+        if (args[ix].isNumber()) {
+            (*out)[ix] = args[ix].toNumber();
+        } else if (!JS::ToNumber(cx, args[ix], &(*out)[ix])) {
+            JS_ClearPendingException(cx);
+            gjs_throw(cx,
+                      "Error invoking %s, at argument %zu (%s): Couldn't "
+                      "convert to double",
+                      method, ix, names[ix]);
+            return false;
+        }
+    }
+    return true;
+}
 
-#define GJS_CAIRO_CONTEXT_DEFINE_FUNC6(method, cfunc, fmt, t1, n1, t2, n2, t3, \
-                                       n3, t4, n4, t5, n5, t6, n6)             \
-    GJS_CAIRO_CONTEXT_DEFINE_FUNC_BEGIN(method)                                \
-    t1 arg1;                                                                   \
-    t2 arg2;                                                                   \
-    t3 arg3;                                                                   \
-    t4 arg4;                                                                   \
-    t5 arg5;                                                                   \
-    t6 arg6;                                                                   \
-    if (!gjs_parse_call_args(cx, #method, argv, fmt, #n1, &arg1, #n2, &arg2,   \
-                             #n3, &arg3, #n4, &arg4, #n5, &arg5, #n6, &arg6))  \
-        return false;                                                          \
-    cfunc(cr, arg1, arg2, arg3, arg4, arg5, arg6);                             \
-    argv.rval().setUndefined();                                                \
+#define GJS_CAIRO_CONTEXT_DEFINE_FUNCF(method, cfunc, ...)            \
+    GJS_CAIRO_CONTEXT_DEFINE_FUNC_BEGIN(method)                       \
+    static constexpr const char* names[] = {__VA_ARGS__};             \
+    std::array<double, std::size(names)> args;                        \
+    if (!parse_number_args(cx, #method, argv, names, &args))          \
+        return false;                                                 \
+    std::apply([cr](auto... arg) { cfunc(cr, arg...); }, args);       \
+    argv.rval().setUndefined();                                       \
     GJS_CAIRO_CONTEXT_DEFINE_FUNC_END
 
 void CairoContext::add_associated_memory(JSObject* obj, cairo_t* cr) {
@@ -295,14 +279,12 @@ const JSPropertySpec CairoContext::proto_props[] = {
 
 // Methods
 
-GJS_CAIRO_CONTEXT_DEFINE_FUNC5(arc, cairo_arc, "fffff", double, xc, double, yc,
-                               double, radius, double, angle1, double, angle2)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC5(arcNegative, cairo_arc_negative, "fffff", double,
-                               xc, double, yc, double, radius, double, angle1,
-                               double, angle2)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC6(curveTo, cairo_curve_to, "ffffff", double, x1,
-                               double, y1, double, x2, double, y2, double, x3,
-                               double, y3)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(arc, cairo_arc, "xc", "yc", "radius", "angle1",
+                               "angle2")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(arcNegative, cairo_arc_negative, "xc", "yc",
+                               "radius", "angle1", "angle2")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(curveTo, cairo_curve_to, "x1", "y1", "x2", "y2",
+                               "x3", "y3")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(clip, cairo_clip)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(clipPreserve, cairo_clip_preserve)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0AFFFF(clipExtents, cairo_clip_extents)
@@ -331,64 +313,52 @@ GJS_CAIRO_CONTEXT_DEFINE_FUNC2B(inFill, cairo_in_fill, "ff", double, x, double,
                                 y)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC2B(inStroke, cairo_in_stroke, "ff", double, x,
                                 double, y)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC2(lineTo, cairo_line_to, "ff", double, x, double,
-                               y)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC2(moveTo, cairo_move_to, "ff", double, x, double,
-                               y)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(lineTo, cairo_line_to, "x", "y")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(moveTo, cairo_move_to, "x", "y")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(newPath, cairo_new_path)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(newSubPath, cairo_new_sub_path)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(paint, cairo_paint)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC1(paintWithAlpha, cairo_paint_with_alpha, "f",
-                               double, alpha)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(paintWithAlpha, cairo_paint_with_alpha, "alpha")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0AFFFF(pathExtents, cairo_path_extents)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(pushGroup, cairo_push_group)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC1(pushGroupWithContent,
                                cairo_push_group_with_content, "i",
                                cairo_content_t, content)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(popGroupToSource, cairo_pop_group_to_source)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC4(rectangle, cairo_rectangle, "ffff", double, x,
-                               double, y, double, width, double, height)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC6(relCurveTo, cairo_rel_curve_to, "ffffff", double,
-                               dx1, double, dy1, double, dx2, double, dy2,
-                               double, dx3, double, dy3)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC2(relLineTo, cairo_rel_line_to, "ff", double, dx,
-                               double, dy)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC2(relMoveTo, cairo_rel_move_to, "ff", double, dx,
-                               double, dy)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(rectangle, cairo_rectangle, "x", "y", "width",
+                               "height")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(relCurveTo, cairo_rel_curve_to, "dx1", "dy1",
+                               "dx2", "dy2", "dx3", "dy3")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(relLineTo, cairo_rel_line_to, "dx", "dy")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(relMoveTo, cairo_rel_move_to, "dx", "dy")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(resetClip, cairo_reset_clip)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(restore, cairo_restore)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC1(rotate, cairo_rotate, "f", double, angle)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(rotate, cairo_rotate, "angle")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(save, cairo_save)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC2(scale, cairo_scale, "ff", double, sx, double, sy)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(scale, cairo_scale, "sx", "sy")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setAntialias, cairo_set_antialias, "i",
                                cairo_antialias_t, antialias)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setFillRule, cairo_set_fill_rule, "i",
                                cairo_fill_rule_t, fill_rule)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setFontSize, cairo_set_font_size, "f", double,
-                               size)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(setFontSize, cairo_set_font_size, "size")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setLineCap, cairo_set_line_cap, "i",
                                cairo_line_cap_t, line_cap)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setLineJoin, cairo_set_line_join, "i",
                                cairo_line_join_t, line_join)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setLineWidth, cairo_set_line_width, "f", double,
-                               width)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setMiterLimit, cairo_set_miter_limit, "f",
-                               double, limit)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(setLineWidth, cairo_set_line_width, "width")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(setMiterLimit, cairo_set_miter_limit, "limit")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setOperator, cairo_set_operator, "i",
                                cairo_operator_t, op)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC1(setTolerance, cairo_set_tolerance, "f", double,
-                               tolerance)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC3(setSourceRGB, cairo_set_source_rgb, "fff",
-                               double, red, double, green, double, blue)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC4(setSourceRGBA, cairo_set_source_rgba, "ffff",
-                               double, red, double, green, double, blue, double,
-                               alpha)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(setTolerance, cairo_set_tolerance, "tolerance")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(setSourceRGB, cairo_set_source_rgb, "red",
+                               "green", "blue")
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(setSourceRGBA, cairo_set_source_rgba, "red",
+                               "green", "blue", "alpha")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(showPage, cairo_show_page)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(stroke, cairo_stroke)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0(strokePreserve, cairo_stroke_preserve)
 GJS_CAIRO_CONTEXT_DEFINE_FUNC0AFFFF(strokeExtents, cairo_stroke_extents)
-GJS_CAIRO_CONTEXT_DEFINE_FUNC2(translate, cairo_translate, "ff", double, tx,
-                               double, ty)
+GJS_CAIRO_CONTEXT_DEFINE_FUNCF(translate, cairo_translate, "tx", "ty")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC2FFAFF(userToDevice, cairo_user_to_device, "x",
                                     "y")
 GJS_CAIRO_CONTEXT_DEFINE_FUNC2FFAFF(userToDeviceDistance,
@@ -423,6 +393,100 @@ static bool appendPath_func(JSContext* cx, unsigned argc, JS::Value* vp) {
     return true;
 }
 
+// Number of coordinates that each cairo_path_data_type_t consumes
+[[nodiscard]]
+static size_t path_op_n_coords(uint8_t op) {
+    switch (op) {
+        case CAIRO_PATH_MOVE_TO:
+        case CAIRO_PATH_LINE_TO:
+            return 2;
+        case CAIRO_PATH_CURVE_TO:
+            return 6;
+        case CAIRO_PATH_CLOSE_PATH:
+            return 0;
+        default:
+            return SIZE_MAX;
+    }
+}
+
+// appendPathData(ops, coords): Appends a whole path in one call. ops is a
+// Uint8Array of Cairo.PathDataType values, and coords a Float64Array holding
+// the x and y coordinates of the points that the operations take in turn.
+GJS_JSAPI_RETURN_CONVENTION
+static bool appendPathData_func(JSContext* cx, unsigned argc, JS::Value* vp) {
+    GJS_CAIRO_CONTEXT_GET_PRIV_CR_CHECKED(cx, argc, vp, argv, obj);
+
+    JS::RootedObject ops{cx}, coords{cx};
+    if (!gjs_parse_call_args(cx, "appendPathData", argv, "oo", "ops", &ops,
+                             "coords", &coords))
+        return false;
+
+    if (!JS_IsUint8Array(ops)) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "ops must be a Uint8Array");
+        return false;
+    }
+    if (!JS_IsFloat64Array(coords)) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "coords must be a Float64Array");
+        return false;
+    }
+
+    size_t n_ops = JS_GetTypedArrayLength(ops);
+    size_t n_coords = JS_GetTypedArrayLength(coords);
+    size_t n_needed = 0;
+    Maybe<size_t> invalid_op;
+
+    {
+        JS::AutoCheckCannotGC nogc{cx};
+        bool is_shared;
+        const uint8_t* op_data = JS_GetUint8ArrayData(ops, &is_shared, nogc);
+        const double* c = JS_GetFloat64ArrayData(coords, &is_shared, nogc);
+
+        // Validate everything first, so that an invalid path is not
+        // half-appended
+        for (size_t ix = 0; ix < n_ops && !invalid_op; ix++) {
+            size_t n = path_op_n_coords(op_data[ix]);
+            if (n == SIZE_MAX)
+                invalid_op = Some(ix);
+            else
+                n_needed += n;
+        }
+
+        for (size_t ix = 0; ix < n_ops && !invalid_op && n_needed <= n_coords;
+             ix++) {
+            switch (op_data[ix]) {
+                case CAIRO_PATH_MOVE_TO:
+                    cairo_move_to(cr, c[0], c[1]);
+                    break;
+                case CAIRO_PATH_LINE_TO:
+                    cairo_line_to(cr, c[0], c[1]);
+                    break;
+                case CAIRO_PATH_CURVE_TO:
+                    cairo_curve_to(cr, c[0], c[1], c[2], c[3], c[4], c[5]);
+                    break;
+                case CAIRO_PATH_CLOSE_PATH:
+                    cairo_close_path(cr);
+                    break;
+            }
+            c += path_op_n_coords(op_data[ix]);
+        }
+    }
+
+    if (invalid_op) {
+        gjs_throw(cx, "Invalid path operation at index %zu", *invalid_op);
+        return false;
+    }
+    if (n_needed > n_coords) {
+        gjs_throw(cx, "Path operations need %zu coordinates, but got %zu",
+                  n_needed, n_coords);
+        return false;
+    }
+
+    argv.rval().setUndefined();
+    return gjs_cairo_check_status(cx, cairo_status(cr), "context");
+}
+
 GJS_JSAPI_RETURN_CONVENTION
 static bool copyPath_func(JSContext* cx, unsigned argc, JS::Value* vp) {
     GJS_CAIRO_CONTEXT_GET_PRIV_CR_CHECKED(cx, argc, vp, argv, obj);
@@ -891,6 +955,7 @@ static bool setFontMatrix_func(JSContext* cx, unsigned argc, JS::Value* vp) {
 const JSFunctionSpec CairoContext::proto_funcs[] = {
     JS_FN("$dispose", &CairoContext::dispose, 0, 0),
     JS_FN("appendPath", appendPath_func, 0, 0),
+    JS_FN("appendPathData", appendPathData_func, 2, 0),
     JS_FN("arc", arc_func, 0, 0),
     JS_FN("arcNegative", arcNegative_func, 0, 0),
     JS_FN("clip", clip_func, 0, 0),
@@ -4,15 +4,25 @@
 
 #include <config.h>
 
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+
+#include <utility>  // for move
+
 #include <cairo.h>
 
+#include <js/ArrayBuffer.h>
 #include <js/CallArgs.h>
+#include <js/ErrorReport.h>  // for JSEXN_TYPEERR
 #include <js/PropertyDescriptor.h>  // for JSPROP_READONLY
 #include <js/PropertySpec.h>
 #include <js/RootingAPI.h>
 #include <js/TypeDecls.h>
+#include <js/Utility.h>  // for js_free
+#include <js/experimental/TypedData.h>
 #include <jsapi.h>  // for JS_NewObjectWithGivenProto
 #include <jspubtd.h>  // for JSProtoKey
+#include <mozilla/UniquePtr.h>
 
 #include "gjs/auto.h"
 #include "gjs/jsapi-util-args.h"
@@ -26,14 +36,89 @@ JSObject* CairoImageSurface::new_proto(JSContext* cx, JSProtoKey) {
     return JS_NewObjectWithGivenProto(cx, nullptr, parent_proto);
 }
 
+static const cairo_user_data_key_t stolen_contents_key = {};
+
+// Creates a surface for the pixel data of a typed array. The contents of its
+// ArrayBuffer are taken over without copying, so the typed array is detached
+// afterwards and the data can be accessed again with getData().
+GJS_JSAPI_RETURN_CONVENTION
+static cairo_surface_t* create_for_typed_array(JSContext* cx,
+                                               cairo_format_t format,
+                                               int width, int height,
+                                               JS::HandleObject data,
+                                               int stride) {
+    if (!JS_IsTypedArrayObject(data)) {
+        gjs_throw_custom(cx, JSEXN_TYPEERR, nullptr,
+                         "ImageSurface data must be a typed array");
+        return nullptr;
+    }
+
+    if (stride < 0)
+        stride = cairo_format_stride_for_width(format, width);
+
+    // Cairo reads whole pixels of up to 4 bytes; the buffer itself is aligned
+    size_t offset = JS_GetTypedArrayByteOffset(data);
+    if (offset % 4 != 0) {
+        gjs_throw(cx,
+                  "ImageSurface data must start at a multiple of 4 bytes "
+                  "into its buffer, not %zu",
+                  offset);
+        return nullptr;
+    }
+
+    size_t n_bytes = JS_GetTypedArrayByteLength(data);
+    if (stride < 0 || height < 0 ||
+        n_bytes < static_cast<size_t>(stride) * height) {
+        gjs_throw(cx,
+                  "ImageSurface data of %zu bytes is too small for %d rows "
+                  "of %d bytes",
+                  n_bytes, height, stride);
+        return nullptr;
+    }
+
+    bool is_shared;
+    JS::RootedObject buffer{cx,
+                            JS_GetArrayBufferViewBuffer(cx, data, &is_shared)};
+    if (!buffer)
+        return nullptr;
+    if (is_shared) {
+        gjs_throw(cx, "ImageSurface data cannot be in shared memory");
+        return nullptr;
+    }
+
+    auto* contents =
+        static_cast<uint8_t*>(JS::StealArrayBufferContents(cx, buffer));
+    if (!contents)
+        return nullptr;
+
+    cairo_surface_t* surface = cairo_image_surface_create_for_data(
+        contents + offset, format, width, height, stride);
+    if (cairo_surface_set_user_data(surface, &stolen_contents_key, contents,
+                                    js_free) != CAIRO_STATUS_SUCCESS)
+        js_free(contents);
+
+    if (!gjs_cairo_check_status(cx, cairo_surface_status(surface),
+                                "surface")) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    return surface;
+}
+
 cairo_surface_t* CairoImageSurface::constructor_impl(JSContext* cx,
                                                      const JS::CallArgs& args) {
-    int format, width, height;
-    // create_for_data optional parameter
-    if (!gjs_parse_call_args(cx, "ImageSurface", args, "iii", "format", &format,
-                             "width", &width, "height", &height))
+    int format, width, height, stride = -1;
+    JS::RootedObject data{cx};
+    if (!gjs_parse_call_args(cx, "ImageSurface", args, "iii|oi", "format",
+                             &format, "width", &width, "height", &height,
+                             "data", &data, "stride", &stride))
         return nullptr;
 
+    if (data)
+        return create_for_typed_array(cx, static_cast<cairo_format_t>(format),
+                                      width, height, data, stride);
+
     cairo_surface_t* surface = cairo_image_surface_create(
         static_cast<cairo_format_t>(format), width, height);
 
@@ -161,6 +246,89 @@ static bool getStride_func(JSContext* cx, unsigned argc, JS::Value* vp) {
     return true;
 }
 
+static void unref_surface_contents(void*, void* surface) {
+    cairo_surface_destroy(static_cast<cairo_surface_t*>(surface));
+}
+
+// Returns the pixels of the surface as a Uint8ClampedArray, without copying.
+// The array keeps the surface alive. Drawing to the surface with cairo after
+// modifying the pixels requires calling markDirty() first.
+GJS_JSAPI_RETURN_CONVENTION
+static bool getData_func(JSContext* cx, unsigned argc, JS::Value* vp) {
+    GJS_GET_THIS(cx, argc, vp, rec, obj);
+
+    if (argc > 0) {
+        gjs_throw(cx, "ImageSurface.getData() takes no arguments");
+        return false;
+    }
+
+    cairo_surface_t* surface = CairoSurface::for_js(cx, obj);
+    if (!surface)
+        return false;
+
+    // Make sure pending drawing operations are visible in the data
+    cairo_surface_flush(surface);
+
+    unsigned char* data = cairo_image_surface_get_data(surface);
+    if (!gjs_cairo_check_status(cx, cairo_surface_status(surface), "surface"))
+        return false;
+
+    int stride = cairo_image_surface_get_stride(surface);
+    size_t n_bytes = static_cast<size_t>(stride) *
+                     cairo_image_surface_get_height(surface);
+    JSObject* array;
+    if (!data || n_bytes == 0) {
+        array = JS_NewUint8ClampedArray(cx, 0);
+    } else {
+        mozilla::UniquePtr<void, JS::BufferContentsDeleter> contents{
+            data, {unref_surface_contents, cairo_surface_reference(surface)}};
+        JS::RootedObject buffer{
+            cx, JS::NewExternalArrayBuffer(cx, n_bytes, std::move(contents))};
+        if (!buffer)
+            return false;
+        array = JS_NewUint8ClampedArrayWithBuffer(cx, buffer, 0, -1);
+    }
+    if (!array)
+        return false;
+
+    rec.rval().setObject(*array);
+    return true;
+}
+
+// markDirty() or markDirty(x, y, width, height): Tells cairo that the pixels,
+// or a rectangle of them, were modified through the array from getData()
+GJS_JSAPI_RETURN_CONVENTION
+static bool markDirty_func(JSContext* cx, unsigned argc, JS::Value* vp) {
+    GJS_GET_THIS(cx, argc, vp, rec, obj);
+
+    // A partial rectangle would silently default to one reaching the edges
+    if (argc != 0 && argc != 4) {
+        gjs_throw(cx, "markDirty() takes either 0 or 4 arguments, not %u",
+                  argc);
+        return false;
+    }
+
+    int x = 0, y = 0, width = -1, height = -1;
+    if (!gjs_parse_call_args(cx, "markDirty", rec, "|iiii", "x", &x, "y", &y,
+                             "width", &width, "height", &height))
+        return false;
+
+    cairo_surface_t* surface = CairoSurface::for_js(cx, obj);
+    if (!surface)
+        return false;
+
+    if (argc == 0)
+        cairo_surface_mark_dirty(surface);
+    else
+        cairo_surface_mark_dirty_rectangle(surface, x, y, width, height);
+
+    if (!gjs_cairo_check_status(cx, cairo_surface_status(surface), "surface"))
+        return false;
+
+    rec.rval().setUndefined();
+    return true;
+}
+
 void CairoImageSurface::add_associated_memory(JSObject* obj,
                                               cairo_surface_t* surface) {
     add_associated_memory_for_surface(obj, surface);
@@ -168,11 +336,12 @@ void CairoImageSurface::add_associated_memory(JSObject* obj,
 
 const JSFunctionSpec CairoImageSurface::proto_funcs[] = {
     JS_FN("createFromPNG", createFromPNG_func, 0, 0),
-    // getData
+    JS_FN("getData", getData_func, 0, 0),
     JS_FN("getFormat", getFormat_func, 0, 0),
     JS_FN("getWidth", getWidth_func, 0, 0),
     JS_FN("getHeight", getHeight_func, 0, 0),
-    JS_FN("getStride", getStride_func, 0, 0), JS_FS_END};
+    JS_FN("getStride", getStride_func, 0, 0),
+    JS_FN("markDirty", markDirty_func, 0, 0), JS_FS_END};
 
 const JSFunctionSpec CairoImageSurface::static_funcs[] = {
     JS_FN("createFromPNG", createFromPNG_func, 1, GJS_MODULE_PROP_FLAGS),
@@ -22,6 +22,10 @@
 #    include <readline/readline.h>
 #endif
 
+#include <stddef.h>  // for size_t
+#include <stdint.h>
+
+#include <array>
 #include <string>
 
 #include <glib.h>
@@ -35,14 +39,21 @@
 #include <js/CallAndConstruct.h>
 #include <js/CallArgs.h>
 #include <js/CharacterEncoding.h>  // for JS_EncodeStringToUTF8
+#include <js/Class.h>
+#include <js/ColumnNumber.h>  // for TaggedColumnNumberOneOrigin
 #include <js/CompilationAndEvaluation.h>
 #include <js/CompileOptions.h>
 #include <js/ErrorReport.h>
 #include <js/Exception.h>
 #include <js/GlobalObject.h>  // for CurrentGlobalOrNull
+#include <js/Object.h>        // for GetClass, GetMaybePtrFromReservedSlot
 #include <js/PropertyAndElement.h>
+#include <js/PropertySpec.h>  // for JS_FN, JSFunctionSpec, JS_FS_END
 #include <js/RootingAPI.h>
+#include <js/SavedFrameAPI.h>
 #include <js/SourceText.h>
+#include <js/Stack.h>  // for CaptureCurrentStack, MaxFrames
+#include <js/TracingAPI.h>
 #include <js/TypeDecls.h>
 #include <js/Utility.h>  // for UniqueChars
 #include <js/Value.h>
@@ -57,6 +68,7 @@
 #include "gjs/global.h"
 #include "gjs/jsapi-util.h"
 #include "gjs/macros.h"
+#include "libgjs-private/gjs-util.h"
 #include "modules/console.h"
 #include "util/console.h"
 
@@ -371,10 +383,271 @@ static bool gjs_console_interact(JSContext* cx, unsigned argc, JS::Value* vp) {
     return true;
 }
 
+/* Native backend of the console object in modules/esm/console.js. It emits
+ * messages with g_log_structured_array(), so that logging a line does not cost
+ * marshalling a dictionary of fields through GLib.log_structured(). The log
+ * domain, and the CODE_FILE, CODE_LINE, and CODE_FUNC fields of the most
+ * recent call sites, are kept already encoded. */
+class LogWriter {
+    // Fields that are the same for every message logged from one place
+    struct CallSite {
+        JS::Heap<JSString*> source;
+        uint32_t line = 0;
+        uint32_t column = 0;
+        std::string file;
+        std::string line_string;
+        std::string func;
+    };
+
+    // console.js's own frames on the stack above the caller, at most
+    static constexpr unsigned MAX_FRAMES = 8;
+    static constexpr size_t N_CALL_SITES = 16;
+
+    std::string m_domain;
+    std::array<CallSite, N_CALL_SITES> m_call_sites;
+    size_t m_next_call_site = 0;
+
+ public:
+    explicit LogWriter(const char* domain) : m_domain(domain) {}
+
+    void set_domain(const char* domain) { m_domain = domain; }
+
+    [[nodiscard]] bool would_drop(GLogLevelFlags level) const {
+        // A custom writer function, or one that an embedder may have installed,
+        // may want messages that the default writer would drop
+        return gjs_log_writer_is_default() &&
+               g_log_writer_default_would_drop(level, m_domain.c_str());
+    }
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool lookup_call_site(JSContext*, const CallSite** site_out);
+
+    GJS_JSAPI_RETURN_CONVENTION
+    bool log(JSContext*, GLogLevelFlags, JS::HandleString message,
+             bool with_call_site);
+
+    void trace(JSTracer* trc) {
+        for (CallSite& site : m_call_sites)
+            JS::TraceNullableEdge(trc, &site.source, "LogWriter::source");
+    }
+};
+
+// Finds the innermost frame on the stack that is not in console.js, which must
+// be the caller of the native function
+bool LogWriter::lookup_call_site(JSContext* cx, const CallSite** site_out) {
+    *site_out = nullptr;
+
+    JS::RootedObject frame{cx};
+    if (!JS::CaptureCurrentStack(cx, &frame,
+                                 JS::StackCapture{JS::MaxFrames{MAX_FRAMES}}))
+        return false;
+
+    auto ok = JS::SavedFrameResult::Ok;
+    JS::RootedString own_source{cx}, source{cx};
+    if (!frame ||
+        JS::GetSavedFrameSource(cx, nullptr, frame, &own_source) != ok)
+        return true;
+
+    // Source URLs are atoms, so they can be compared by pointer
+    do {
+        if (JS::GetSavedFrameParent(cx, nullptr, frame, &frame) != ok || !frame)
+            return true;
+        if (JS::GetSavedFrameSource(cx, nullptr, frame, &source) != ok)
+            return true;
+    } while (source.get() == own_source.get());
+
+    uint32_t line;
+    JS::TaggedColumnNumberOneOrigin column;
+    if (JS::GetSavedFrameLine(cx, nullptr, frame, &line) != ok ||
+        JS::GetSavedFrameColumn(cx, nullptr, frame, &column) != ok)
+        return true;
+
+    for (const CallSite& site : m_call_sites) {
+        if (site.source.unbarrieredGet() == source && site.line == line &&
+            site.column == column.oneOriginValue()) {
+            *site_out = &site;
+            return true;
+        }
+    }
+
+    JS::RootedString func{cx};
+    if (JS::GetSavedFrameFunctionDisplayName(cx, nullptr, frame, &func) != ok)
+        return true;
+
+    JS::UniqueChars file_utf8{JS_EncodeStringToUTF8(cx, source)};
+    if (!file_utf8)
+        return false;
+    JS::UniqueChars func_utf8;
+    if (func && !(func_utf8 = JS_EncodeStringToUTF8(cx, func)))
+        return false;
+
+    CallSite& site = m_call_sites[m_next_call_site];
+    m_next_call_site = (m_next_call_site + 1) % N_CALL_SITES;
+
+    site.source = source;
+    site.line = line;
+    site.column = column.oneOriginValue();
+    site.file = file_utf8.get();
+    site.line_string = std::to_string(line);
+    site.func = func_utf8 ? func_utf8.get() : "";
+
+    *site_out = &site;
+    return true;
+}
+
+// Same mapping to syslog priorities as GLib uses for g_log_structured()
+static const char* log_level_priority(GLogLevelFlags level) {
+    if (level & G_LOG_LEVEL_ERROR)
+        return "3";
+    if (level & (G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING))
+        return "4";
+    if (level & G_LOG_LEVEL_INFO)
+        return "6";
+    if (level & G_LOG_LEVEL_DEBUG)
+        return "7";
+    return "5";
+}
+
+bool LogWriter::log(JSContext* cx, GLogLevelFlags level,
+                    JS::HandleString message, bool with_call_site) {
+    JS::UniqueChars message_utf8{JS_EncodeStringToUTF8(cx, message)};
+    if (!message_utf8)
+        return false;
+
+    const CallSite* site = nullptr;
+    if (with_call_site && !lookup_call_site(cx, &site))
+        return false;
+
+    std::array<GLogField, 6> fields;
+    size_t n_fields = 0;
+    fields[n_fields++] = {"PRIORITY", log_level_priority(level), -1};
+    fields[n_fields++] = {"GLIB_DOMAIN", m_domain.c_str(), -1};
+    fields[n_fields++] = {"MESSAGE", message_utf8.get(), -1};
+    if (site) {
+        fields[n_fields++] = {"CODE_FILE", site->file.c_str(), -1};
+        fields[n_fields++] = {"CODE_LINE", site->line_string.c_str(), -1};
+        if (!site->func.empty())
+            fields[n_fields++] = {"CODE_FUNC", site->func.c_str(), -1};
+    }
+
+    g_log_structured_array(level, fields.data(), n_fields);
+    return true;
+}
+
+static void log_writer_finalize(JS::GCContext*, JSObject* obj) {
+    delete JS::GetMaybePtrFromReservedSlot<LogWriter>(obj, 0);
+}
+
+static void log_writer_trace(JSTracer* trc, JSObject* obj) {
+    if (auto* writer = JS::GetMaybePtrFromReservedSlot<LogWriter>(obj, 0))
+        writer->trace(trc);
+}
+
+static constexpr JSClassOps log_writer_class_ops = {
+    nullptr,  // addProperty
+    nullptr,  // deleteProperty
+    nullptr,  // enumerate
+    nullptr,  // newEnumerate
+    nullptr,  // resolve
+    nullptr,  // mayResolve
+    &log_writer_finalize,
+    nullptr,  // call
+    nullptr,  // construct
+    &log_writer_trace,
+};
+
+static constexpr JSClass log_writer_class = {
+    "GjsConsoleLogWriter",
+    JSCLASS_HAS_RESERVED_SLOTS(1) | JSCLASS_FOREGROUND_FINALIZE,
+    &log_writer_class_ops,
+};
+
+// The methods can only be called internally, so OK to assert correct arguments
+static LogWriter* log_writer_from_this(const JS::CallArgs& args) {
+    g_assert(args.thisv().isObject() &&
+             JS::GetClass(&args.thisv().toObject()) == &log_writer_class &&
+             "LogWriter method called on the wrong object");
+    return JS::GetMaybePtrFromReservedSlot<LogWriter>(
+        &args.thisv().toObject(), 0);
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool log_writer_set_domain(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    g_assert(args.length() == 1 && args[0].isString() &&
+             "setDomain takes a string");
+
+    JS::RootedString domain{cx, args[0].toString()};
+    JS::UniqueChars domain_utf8{JS_EncodeStringToUTF8(cx, domain)};
+    if (!domain_utf8)
+        return false;
+
+    log_writer_from_this(args)->set_domain(domain_utf8.get());
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool log_writer_would_drop(JSContext*, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    g_assert(args.length() == 1 && args[0].isInt32() &&
+             "wouldDrop takes a log level");
+
+    auto level = static_cast<GLogLevelFlags>(args[0].toInt32());
+    args.rval().setBoolean(log_writer_from_this(args)->would_drop(level));
+    return true;
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool log_writer_log(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    g_assert(args.length() == 3 && args[0].isInt32() && args[1].isString() &&
+             args[2].isBoolean() &&
+             "log takes a log level, a message, and whether to find the "
+             "call site");
+
+    auto level = static_cast<GLogLevelFlags>(args[0].toInt32());
+    JS::RootedString message{cx, args[1].toString()};
+    args.rval().setUndefined();
+    return log_writer_from_this(args)->log(cx, level, message,
+                                           args[2].toBoolean());
+}
+
+static constexpr JSFunctionSpec log_writer_funcs[] = {
+    JS_FN("setDomain", log_writer_set_domain, 1, GJS_MODULE_PROP_FLAGS),
+    JS_FN("wouldDrop", log_writer_would_drop, 1, GJS_MODULE_PROP_FLAGS),
+    JS_FN("log", log_writer_log, 3, GJS_MODULE_PROP_FLAGS),
+    JS_FS_END};
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool create_log_writer(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    g_assert(args.length() == 1 && args[0].isString() &&
+             "createLogWriter takes a log domain");
+
+    JS::RootedString domain{cx, args[0].toString()};
+    JS::UniqueChars domain_utf8{JS_EncodeStringToUTF8(cx, domain)};
+    if (!domain_utf8)
+        return false;
+
+    JS::RootedObject writer{cx, JS_NewObject(cx, &log_writer_class)};
+    if (!writer)
+        return false;
+    JS::SetReservedSlot(writer, 0,
+                        JS::PrivateValue(new LogWriter{domain_utf8.get()}));
+
+    if (!JS_DefineFunctions(cx, writer, log_writer_funcs))
+        return false;
+
+    args.rval().setObject(*writer);
+    return true;
+}
+
 bool gjs_define_console_stuff(JSContext* cx, JS::MutableHandleObject module) {
     module.set(JS_NewPlainObject(cx));
     const GjsAtoms& atoms = GjsContextPrivate::atoms(cx);
     return JS_DefineFunctionById(cx, module, atoms.interact(),
                                  gjs_console_interact, 1,
-                                 GJS_MODULE_PROP_FLAGS);
+                                 GJS_MODULE_PROP_FLAGS) &&
+           JS_DefineFunction(cx, module, "createLogWriter", create_log_writer,
+                             1, GJS_MODULE_PROP_FLAGS);
 }
@@ -6,6 +6,8 @@ var GjsPrivate = imports.gi.GjsPrivate;
 const Signals = imports._signals;
 const {_createWrappersForPlatformSpecificNamespace} = imports._common;
 const {setMainLoopHook} = imports._promiseNative;
+const {makeMethodCallHandler, makeProxyMethods} = imports._dbusNative;
+const {listModelGetItems} = imports._gi;
 var Gio;
 
 // Ensures that a Gio.UnixFDList being passed into or out of a DBus method with
@@ -57,6 +59,8 @@ function _validateFDVariant(variant, fdList) {
     throw new Error('Assertion failure: this code should not be reached');
 }
 
+// Invokes methods whose in arguments include file descriptors; other methods
+// are invoked natively, see _makeProxyMethods()
 function _proxyInvoker(methodName, sync, inSignature, argArray) {
     var replyFunc;
     var flags = 0;
@@ -176,19 +180,24 @@ function _propertySetter(name, signature, value) {
         });
 }
 
-function _addDBusConvenience(proxyInstance) {
-    const info = proxyInstance.g_interface_info;
-    if (!info)
-        return;
-
-    if (info.signals.length > 0)
-        proxyInstance.connect('g-signal', _convertToNativeSignal);
-
+// Creates the fooRemote(), fooSync(), and fooAsync() methods for each method of
+// a D-Bus interface. The in signatures are parsed once here, and the methods
+// are invoked natively, except for those taking file descriptors.
+function _makeProxyMethods(info) {
+    const methods = {};
     for (const method of info.methods) {
+        const {name} = method;
+        const nativeMethods = makeProxyMethods(method);
+        if (nativeMethods) {
+            [methods[`${name}Remote`], methods[`${name}Sync`],
+                methods[`${name}Async`]] = nativeMethods;
+            continue;
+        }
+
         const remoteMethod = _makeProxyMethod(method, false);
-        proxyInstance[`${method.name}Remote`] = remoteMethod;
-        proxyInstance[`${method.name}Sync`] = _makeProxyMethod(method, true);
-        proxyInstance[`${method.name}Async`] = function (...args) {
+        methods[`${name}Remote`] = remoteMethod;
+        methods[`${name}Sync`] = _makeProxyMethod(method, true);
+        methods[`${name}Async`] = function (...args) {
             return new Promise((resolve, reject) => {
                 args.push((result, error, fdList) => {
                     if (error)
@@ -202,6 +211,24 @@ function _addDBusConvenience(proxyInstance) {
             });
         };
     }
+    return methods;
+}
+
+// Methods of proxies created by a proxy wrapper class, which are created once
+// per class rather than once per proxy
+const _proxyWrapperMethods = new WeakMap();
+
+function _addDBusConvenience(proxyInstance) {
+    const info = proxyInstance.g_interface_info;
+    if (!info)
+        return;
+
+    if (info.signals.length > 0)
+        proxyInstance.connect('g-signal', _convertToNativeSignal);
+
+    const methods = _proxyWrapperMethods.get(proxyInstance) ??
+        _makeProxyMethods(info);
+    Object.assign(proxyInstance, methods);
 
     for (const {name, signature, flags} of info.properties) {
         let getter = () => {
@@ -229,6 +256,7 @@ function _addDBusConvenience(proxyInstance) {
 function _makeProxyWrapper(interfaceXml) {
     var info = _newInterfaceInfo(interfaceXml);
     var iname = info.name;
+    const methods = _makeProxyMethods(info);
     return class extends Gio.DBusProxy {
         constructor(bus, name, object, asyncCallback, cancellable = null,
             flags = Gio.DBusProxyFlags.NONE) {
@@ -240,6 +268,7 @@ function _makeProxyWrapper(interfaceXml) {
                 g_flags: flags,
                 g_object_path: object,
             });
+            _proxyWrapperMethods.set(obj, methods);
 
             if (asyncCallback) {
                 obj.init_async(GLib.PRIORITY_DEFAULT, cancellable)
@@ -263,6 +292,7 @@ function _makeProxyWrapper(interfaceXml) {
                 g_flags: flags,
                 g_object_path: object,
             });
+            _proxyWrapperMethods.set(obj, methods);
 
             return new Promise((resolve, reject) =>
                 obj.init_async(GLib.PRIORITY_DEFAULT, cancellable)
@@ -312,113 +342,6 @@ function _wrapFunction(klass, method, addition) {
     };
 }
 
-function _makeOutSignature(args) {
-    var ret = '(';
-    for (var i = 0; i < args.length; i++)
-        ret += args[i].signature;
-
-    return `${ret})`;
-}
-
-function _handleDBusReply(invocation, ret) {
-    if (ret === undefined) {
-        // undefined (no return value) is the empty tuple
-        ret = new GLib.Variant('()', []);
-    }
-
-    try {
-        let outFdList = null;
-        if (!(ret instanceof GLib.Variant)) {
-            // attempt packing according to out signature
-            const outArgs = invocation.get_method_info().out_args;
-            const outSignature = _makeOutSignature(outArgs);
-            if (outSignature.includes('h') &&
-                ret[ret.length - 1] instanceof Gio.UnixFDList) {
-                outFdList = ret.pop();
-            } else if (outArgs.length === 1) {
-                // if one arg, we don't require the handler wrapping it
-                // into an Array
-                ret = [ret];
-            }
-            ret = new GLib.Variant(outSignature, ret);
-        }
-        invocation.return_value_with_unix_fd_list(ret, outFdList);
-    } catch (e) {
-        logError(e, `Exception in method call: ${invocation.get_method_name()}`);
-
-        // if we don't do this, the other side will never see a reply
-        invocation.return_dbus_error('org.gnome.gjs.JSError.ValueError',
-            'Service implementation returned an incorrect value type');
-    }
-}
-
-function _handleDBusError(invocation, e) {
-    if (e instanceof GLib.Error) {
-        invocation.return_gerror(e);
-        return;
-    }
-
-    let {name} = e;
-    if (!name.includes('.')) {
-        // likely to be a normal JS error
-        name = `org.gnome.gjs.JSError.${name}`;
-    }
-    logError(e, `Exception in method call: ${invocation.get_method_name()}`);
-    invocation.return_dbus_error(name, e.message);
-}
-
-function _handleMethodCall(methodName, parameters, invocation) {
-    // prefer a sync version if available
-    const method = this[methodName];
-    if (method) {
-        let retval;
-        try {
-            const args = parameters.deepUnpack();
-            args.push(invocation.get_message().get_unix_fd_list());
-            retval = method.apply(this, args);
-        } catch (e) {
-            _handleDBusError(invocation, e);
-            return;
-        }
-
-        // eslint-disable-next-line no-unused-expressions
-        retval?.then?.(r => _handleDBusReply(invocation, r))?.catch?.(
-            e => _handleDBusError(invocation, e)) ??
-            _handleDBusReply(invocation, retval);
-
-        return;
-    }
-
-    const asyncMethod = this[`${methodName}Async`];
-    if (asyncMethod) {
-        function maybeHandleError(e) {
-            if (_methodInvocations.has(invocation)) {
-                logError(e, `Exception in method call: ${invocation.get_method_name()}`);
-                return;
-            }
-
-            _handleDBusError(invocation, e);
-        };
-
-        const fdList = invocation.get_message().get_unix_fd_list();
-        let ret;
-        try {
-            ret = asyncMethod.call(this, parameters.deepUnpack(), invocation, fdList);
-        } catch (e) {
-            maybeHandleError(e);
-            return;
-        }
-
-        ret?.catch?.(maybeHandleError);
-    } else {
-        logError(new Error(), `Missing handler for DBus method ${methodName}`);
-        invocation.return_gerror(new Gio.DBusError({
-            code: Gio.DBusError.UNKNOWN_METHOD,
-            message: `Method ${methodName} is not implemented`,
-        }));
-    }
-}
-
 function _handlePropertyGet(info, impl, propertyName) {
     let propInfo = info.lookup_property(propertyName);
     let jsval = this[propertyName];
@@ -443,9 +366,10 @@ function _wrapJSObject(interfaceInfo, jsObj) {
     info.cache_build();
 
     var impl = new GjsPrivate.DBusImplementation({g_interface_info: info});
-    impl.connect('handle-method-call', function (_, ...args) {
-        return _handleMethodCall.apply(jsObj, args);
-    });
+    // Arguments and replies are converted natively, according to signatures
+    // looked up once here
+    impl.connect('handle-method-call',
+        makeMethodCallHandler(info, jsObj, _methodInvocations));
     impl.connect('handle-property-get', function (self, propertyName) {
         return _handlePropertyGet.call(jsObj, info, self, propertyName);
     });
@@ -456,11 +380,20 @@ function _wrapJSObject(interfaceInfo, jsObj) {
     return impl;
 }
 
+// Items are fetched natively in batches, rather than with one introspected
+// call per item. The number of items is read again for each batch, so changes
+// to the model during the iteration are seen from the next batch on.
+const LIST_MODEL_ITERATOR_BATCH_SIZE = 256;
+
 function* _listModelIterator() {
-    let _index = 0;
-    const _len = this.get_n_items();
-    while (_index < _len)
-        yield this.get_item(_index++);
+    let index = 0;
+    let nItems;
+    while (index < (nItems = this.get_n_items())) {
+        const count = Math.min(LIST_MODEL_ITERATOR_BATCH_SIZE, nItems - index);
+        const batch = listModelGetItems(this, index, count);
+        yield* batch;
+        index += batch.length;
+    }
 }
 
 function _promisify(proto, asyncFunc, finishFunc = undefined) {
@@ -632,6 +565,9 @@ function _init() {
     Gio.DBusExportedObject.wrapJSObject = _wrapJSObject;
 
     // ListStore
+    Gio.ListModel.prototype.getItems = function (start, count) {
+        return listModelGetItems(this, start, count);
+    };
     Gio.ListStore.prototype[Symbol.iterator] = _listModelIterator;
     Gio.ListStore.prototype.insert_sorted = function (item, compareFunc) {
         return GjsPrivate.list_store_insert_sorted(this, item, compareFunc);
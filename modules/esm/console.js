@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: MIT OR LGPL-2.0-or-later
 // SPDX-FileCopyrightText: 2021 Evan Welsh <contact@evanwelsh.com>
 
+const {createLogWriter} = import.meta.importSync('console');
+
 const DEFAULT_LOG_DOMAIN = 'Gjs-Console';
 
 // A line-by-line implementation of https://console.spec.whatwg.org/.
@@ -62,6 +64,42 @@ function formatOptimally(item) {
     return JSON.stringify(item, null, 4);
 }
 
+/**
+ * Maps WHATWG log severity to {@see GLib.LogLevelFlags}.
+ *
+ * @param {string} logLevel the log level (log tag)
+ * @returns {GLib.LogLevelFlags}
+ */
+function getSeverity(logLevel) {
+    const GLib = imports.gi.GLib;
+
+    switch (logLevel) {
+    case 'log':
+    case 'dir':
+    case 'dirxml':
+    case 'trace':
+    case 'group':
+    case 'groupCollapsed':
+    case 'timeLog':
+    case 'timeEnd':
+        return GLib.LogLevelFlags.LEVEL_MESSAGE;
+    case 'debug':
+        return GLib.LogLevelFlags.LEVEL_DEBUG;
+    case 'count':
+    case 'info':
+        return GLib.LogLevelFlags.LEVEL_INFO;
+    case 'warn':
+    case 'countReset':
+    case 'reportWarning':
+        return GLib.LogLevelFlags.LEVEL_WARNING;
+    case 'error':
+    case 'assert':
+        return GLib.LogLevelFlags.LEVEL_CRITICAL;
+    default:
+        return GLib.LogLevelFlags.LEVEL_MESSAGE;
+    }
+}
+
 /**
  * Implementation of the WHATWG Console object.
  */
@@ -70,6 +108,7 @@ class Console {
     #countLabels = {};
     #timeLabels = {};
     #logDomain = DEFAULT_LOG_DOMAIN;
+    #writer = createLogWriter(DEFAULT_LOG_DOMAIN);
 
     get [Symbol.toStringTag]() {
         return 'Console';
@@ -363,6 +402,7 @@ class Console {
      */
     setLogDomain(logDomain) {
         this.#logDomain = String(logDomain);
+        this.#writer.setDomain(this.#logDomain);
     }
 
     /**
@@ -391,21 +431,25 @@ class Console {
         if (args.length === 0)
             return;
 
+        // Don't format a message that would not be shown anyway
+        if (this.#writer.wouldDrop(getSeverity(logLevel)))
+            return undefined;
+
         const [first, ...rest] = args;
 
         if (rest.length === 0) {
-            this.#printer(logLevel, [first]);
+            this.#print(logLevel, [first]);
             return undefined;
         }
 
         // If first does not contain any format specifiers, don't call Formatter
         if (typeof first !== 'string' || !hasFormatSpecifiers(first)) {
-            this.#printer(logLevel, args);
+            this.#print(logLevel, args);
             return undefined;
         }
 
         // Otherwise, perform print the result of Formatter.
-        this.#printer(logLevel, this.#formatter([first, ...rest]));
+        this.#print(logLevel, this.#formatter([first, ...rest]));
 
         return undefined;
     }
@@ -495,6 +539,7 @@ class Console {
      *
      * This implementation of Printer maps WHATWG log severity to
      * {@see GLib.LogLevelFlags} and outputs using GLib structured logging.
+     * Messages that GLib's default log writer would drop are not formatted.
      *
      * @param {string} logLevel the log level (log tag) the args should be
      *   emitted with
@@ -505,39 +550,26 @@ class Console {
      * @returns {void}
      */
     #printer(logLevel, args, options) {
+        // Skip formatting entirely if the message would not be shown
+        if (this.#writer.wouldDrop(getSeverity(logLevel)))
+            return;
+
+        this.#print(logLevel, args, options);
+    }
+
+    /**
+     * Printer, for messages already known not to be dropped
+     *
+     * @param {string} logLevel the log level (log tag) the args should be
+     *   emitted with
+     * @param {unknown[]} args the arguments to print
+     * @param {PrinterOptions} [options] additional options for the
+     *   printer
+     * @returns {void}
+     */
+    #print(logLevel, args, options) {
         const GLib = imports.gi.GLib;
-        let severity;
-
-        switch (logLevel) {
-        case 'log':
-        case 'dir':
-        case 'dirxml':
-        case 'trace':
-        case 'group':
-        case 'groupCollapsed':
-        case 'timeLog':
-        case 'timeEnd':
-            severity = GLib.LogLevelFlags.LEVEL_MESSAGE;
-            break;
-        case 'debug':
-            severity = GLib.LogLevelFlags.LEVEL_DEBUG;
-            break;
-        case 'count':
-        case 'info':
-            severity = GLib.LogLevelFlags.LEVEL_INFO;
-            break;
-        case 'warn':
-        case 'countReset':
-        case 'reportWarning':
-            severity = GLib.LogLevelFlags.LEVEL_WARNING;
-            break;
-        case 'error':
-        case 'assert':
-            severity = GLib.LogLevelFlags.LEVEL_CRITICAL;
-            break;
-        default:
-            severity = GLib.LogLevelFlags.LEVEL_MESSAGE;
-        }
+        const severity = getSeverity(logLevel);
 
         const output = args
             .map(a => {
@@ -557,11 +589,19 @@ class Console {
             .join(' ');
 
         let formattedOutput = this.#groupIndentation + output;
+        const withCallSite = severity <= GLib.LogLevelFlags.LEVEL_WARNING;
+
+        // Unless a stack trace or extra fields are involved, the native writer
+        // finds the call site and emits the fields itself
+        if (logLevel !== 'trace' && !options?.stackTrace && !options?.fields) {
+            this.#writer.log(severity, formattedOutput, withCallSite);
+            return;
+        }
+
         const extraFields = {};
 
         let stackTrace = options?.stackTrace;
-        if (!stackTrace &&
-            (logLevel === 'trace' || severity <= GLib.LogLevelFlags.LEVEL_WARNING)) {
+        if (!stackTrace && (logLevel === 'trace' || withCallSite)) {
             stackTrace = new Error().stack;
             const currentFile = stackTrace.match(/^[^@]*@(.*):\d+:\d+$/m)?.at(1);
             const index = stackTrace.lastIndexOf(currentFile) + currentFile.length;
@@ -4,6 +4,7 @@
 declare var moduleGlobalThis: Global;
 
 declare var atob: (text: string) => string;
+declare var clearResolutionCache: () => void;
 declare var compileInternalModule: CompileFunc;
 declare var compileModule: CompileFunc;
 declare var getRegistry: (global: Global) => Map<string, Module>;
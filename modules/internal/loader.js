@@ -11,6 +11,32 @@ import {SourceMapConsumer} from './source-map/source-map-consumer.js';
 
 const DATA_URI_PREFIX = 'data:application/json;base64,';
 
+/**
+ * A set of module URI globs that clears the native module resolution cache
+ * whenever it is modified, since cached resolutions of bare specifiers depend
+ * on the module search path.
+ *
+ * @augments {Set<string>}
+ */
+class ModuleURISet extends Set {
+    /** @param {string} uri a module URI glob */
+    add(uri) {
+        clearResolutionCache();
+        return super.add(uri);
+    }
+
+    /** @param {string} uri a module URI glob */
+    delete(uri) {
+        clearResolutionCache();
+        return super.delete(uri);
+    }
+
+    clear() {
+        clearResolutionCache();
+        super.clear();
+    }
+}
+
 class ModuleLoader extends InternalModuleLoader {
     /**
      * @param {typeof moduleGlobalThis} global the global object to register modules with.
@@ -30,7 +56,7 @@ class ModuleLoader extends InternalModuleLoader {
          *
          * @type {Set<string>}
          */
-        this.moduleURIs = new Set([
+        this.moduleURIs = new ModuleURISet([
             'resource:///org/gnome/gjs/modules/esm/*.js',
         ]);
 
@@ -25,6 +25,8 @@
 #include <js/Value.h>
 #include <jsapi.h>  // for JS_NewPlainObject
 
+#include "gjs/buffered-output.h"
+#include "gjs/context-private.h"
 #include "gjs/deprecation.h"
 #include "gjs/global.h"
 #include "gjs/jsapi-util.h"
@@ -124,7 +126,13 @@ static bool gjs_print(JSContext* cx, unsigned argc, JS::Value* vp) {
     if (!gjs_print_parse_args(cx, args, &buffer))
         return false;
 
-    g_print("%s\n", buffer.c_str());
+    if (Gjs::BufferedOutput* output =
+            GjsContextPrivate::from_cx(cx)->buffered_output()) {
+        buffer += '\n';
+        output->write(Gjs::BufferedOutput::STDOUT, buffer);
+    } else {
+        g_print("%s\n", buffer.c_str());
+    }
 
     args.rval().setUndefined();
     return true;
@@ -138,7 +146,13 @@ static bool gjs_printerr(JSContext* cx, unsigned argc, JS::Value* vp) {
     if (!gjs_print_parse_args(cx, args, &buffer))
         return false;
 
-    g_printerr("%s\n", buffer.c_str());
+    if (Gjs::BufferedOutput* output =
+            GjsContextPrivate::from_cx(cx)->buffered_output()) {
+        buffer += '\n';
+        output->write(Gjs::BufferedOutput::STDERR, buffer);
+    } else {
+        g_printerr("%s\n", buffer.c_str());
+    }
 
     args.rval().setUndefined();
     return true;
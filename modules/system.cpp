@@ -11,9 +11,14 @@
 #include <stdio.h>
 #include <time.h>    // for tzset
 
+#include <algorithm>  // for min
+#include <chrono>
+#include <vector>
+
 #include <glib-object.h>
 #include <glib.h>
 
+#include <js/Array.h>  // for NewArrayObject
 #include <js/CallArgs.h>
 #include <js/Date.h>                // for ResetTimeZone
 #include <js/ErrorReport.h>         // for ReportUncatchableException
@@ -30,13 +35,18 @@
 #include <jsfriendapi.h>  // for GetFunctionNativeReserved, NewFunctionByIdW...
 
 #include "gi/object.h"
+#include "gi/toggle.h"
 #include "gjs/atoms.h"
 #include "gjs/auto.h"
+#include "gjs/call-stats.h"
 #include "gjs/context-private.h"
+#include "gjs/event-loop-monitor.h"
 #include "gjs/jsapi-util-args.h"
 #include "gjs/jsapi-util.h"
 #include "gjs/macros.h"
+#include "gjs/mem-private.h"
 #include "gjs/profiler-private.h"
+#include "gjs/signal-stats.h"
 #include "modules/system.h"
 #include "util/log.h"
 #include "util/misc.h"  // for LogFile
@@ -178,38 +188,27 @@ static bool write_gc_info(const char16_t* buf, uint32_t len, void* data) {
     return true;
 }
 
-static bool gjs_dump_memory_info(JSContext* cx, unsigned argc, JS::Value* vp) {
-    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
-
-    Gjs::AutoChar filename;
-    if (!gjs_parse_call_args(cx, "dumpMemoryInfo", args, "|F", "filename",
-                             &filename))
-        return false;
-
-    int64_t gc_counters[Gjs::GCCounters::N_COUNTERS];
-
-    // The object returned from NewMemoryInfoObject has gcBytes and mallocBytes
-    // properties which are the sum (over all zones) of bytes used. gcBytes is
-    // the number of bytes in garbage-collectable things (GC things).
-    // mallocBytes is the number of bytes allocated with malloc (reported with
-    // JS::AddAssociatedMemory).
-    //
-    // This info leaks internal state of the JS engine, which is why it is not
-    // returned to the caller, only dumped to a file and piped to Sysprof.
-    //
-    // The object also has a zone property with its own gcBytes and mallocBytes
-    // properties, representing the bytes used in the zone that the memory
-    // object belongs to. We only have one zone in GJS's context, so
-    // zone.gcBytes and zone.mallocBytes are a good measure for how much memory
-    // the actual user program is occupying. These are the values that we expose
-    // as counters in Sysprof. The difference between these values and the sum
-    // values is due to the self-hosting zone and atoms zone, that represent
-    // overhead of the JS engine.
-
-    JS::RootedObject gc_info(cx, js::gc::NewMemoryInfoObject(cx));
-    if (!gc_info)
-        return false;
-
+// The object returned from NewMemoryInfoObject has gcBytes and mallocBytes
+// properties which are the sum (over all zones) of bytes used. gcBytes is the
+// number of bytes in garbage-collectable things (GC things). mallocBytes is the
+// number of bytes allocated with malloc (reported with
+// JS::AddAssociatedMemory).
+//
+// This info leaks internal state of the JS engine, which is why the object is
+// not returned to the caller, only dumped to a file and piped to Sysprof. Only
+// the two numbers below are returned, by System.getMetrics().
+//
+// The object also has a zone property with its own gcBytes and mallocBytes
+// properties, representing the bytes used in the zone that the memory object
+// belongs to. We only have one zone in GJS's context, so zone.gcBytes and
+// zone.mallocBytes are a good measure for how much memory the actual user
+// program is occupying. These are the values that we expose as counters in
+// Sysprof. The difference between these values and the sum values is due to
+// the self-hosting zone and atoms zone, that represent overhead of the JS
+// engine.
+GJS_JSAPI_RETURN_CONVENTION
+static bool get_gc_counters(JSContext* cx, JS::HandleObject gc_info,
+                            int64_t gc_counters[Gjs::GCCounters::N_COUNTERS]) {
     const GjsAtoms& atoms = GjsContextPrivate::atoms(cx);
     int32_t val;
     JS::RootedObject zone_info(cx);
@@ -223,6 +222,21 @@ static bool gjs_dump_memory_info(JSContext* cx, unsigned argc, JS::Value* vp) {
                                      atoms.malloc_bytes(), &val))
         return false;
     gc_counters[Gjs::GCCounters::MALLOC_HEAP_BYTES] = static_cast<int64_t>(val);
+    return true;
+}
+
+static bool gjs_dump_memory_info(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+
+    Gjs::AutoChar filename;
+    if (!gjs_parse_call_args(cx, "dumpMemoryInfo", args, "|F", "filename",
+                             &filename))
+        return false;
+
+    int64_t gc_counters[Gjs::GCCounters::N_COUNTERS];
+    JS::RootedObject gc_info(cx, js::gc::NewMemoryInfoObject(cx));
+    if (!gc_info || !get_gc_counters(cx, gc_info, gc_counters))
+        return false;
 
     auto* gjs = GjsContextPrivate::from_cx(cx);
     if (gjs->profiler() &&
@@ -250,6 +264,360 @@ static bool gjs_dump_memory_info(JSContext* cx, unsigned argc, JS::Value* vp) {
     return true;
 }
 
+static bool gjs_dump_call_stats(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+
+    Gjs::AutoChar filename;
+    if (!gjs_parse_call_args(cx, "dumpCallStats", args, "|F", "filename",
+                             &filename))
+        return false;
+
+    Gjs::CallStats* stats = GjsContextPrivate::from_cx(cx)->call_stats();
+    if (!stats) {
+        gjs_throw(cx,
+                  "GI call statistics are not enabled; set GJS_CALL_STATS in "
+                  "the environment");
+        return false;
+    }
+
+    LogFile file(filename);
+    if (file.has_error()) {
+        gjs_throw(cx, "Cannot dump GI call statistics to %s: %s",
+                  filename.get(), file.errmsg());
+        return false;
+    }
+    stats->report(file.fp());
+
+    args.rval().setUndefined();
+    return true;
+}
+
+static constexpr double DEFAULT_EVENT_LOOP_RESOLUTION_MS = 10.0;
+
+static bool gjs_start_event_loop_monitor(JSContext* cx, unsigned argc,
+                                         JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    double resolution_ms = DEFAULT_EVENT_LOOP_RESOLUTION_MS;
+    if (!gjs_parse_call_args(cx, "startEventLoopMonitor", args, "|f",
+                             "resolution", &resolution_ms))
+        return false;
+
+    if (!(resolution_ms >= 0.001)) {
+        gjs_throw(cx,
+                  "Event loop monitor resolution must be at least 0.001 ms");
+        return false;
+    }
+
+    GjsContextPrivate* gjs = GjsContextPrivate::from_cx(cx);
+    gjs->event_loop_monitor(/* create = */ true)
+        ->start(static_cast<int64_t>(resolution_ms * 1000));
+
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool gjs_stop_event_loop_monitor(JSContext* cx, unsigned argc,
+                                        JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "stopEventLoopMonitor", args, ""))
+        return false;
+
+    Gjs::EventLoopMonitor* monitor =
+        GjsContextPrivate::from_cx(cx)->event_loop_monitor();
+    if (monitor)
+        monitor->stop();
+
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool gjs_reset_event_loop_monitor(JSContext* cx, unsigned argc,
+                                         JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "resetEventLoopMonitor", args, ""))
+        return false;
+
+    Gjs::EventLoopMonitor* monitor =
+        GjsContextPrivate::from_cx(cx)->event_loop_monitor();
+    if (monitor)
+        monitor->reset();
+
+    args.rval().setUndefined();
+    return true;
+}
+
+static inline double us_to_ms(double us) { return us / 1000.0; }
+
+// Returns the histogram of main loop delays in milliseconds, or null if the
+// monitor was never started
+static bool gjs_get_event_loop_delay(JSContext* cx, unsigned argc,
+                                     JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "getEventLoopDelay", args, ""))
+        return false;
+
+    Gjs::EventLoopMonitor* monitor =
+        GjsContextPrivate::from_cx(cx)->event_loop_monitor();
+    if (!monitor) {
+        args.rval().setNull();
+        return true;
+    }
+
+    const Gjs::Histogram& delay = monitor->delay();
+    JS::RootedObject retval{cx, JS_NewPlainObject(cx)};
+    JS::RootedObject percentiles{cx, JS_NewPlainObject(cx)};
+    if (!retval || !percentiles)
+        return false;
+
+    static const struct {
+        const char* name;
+        double value;
+    } percentile_points[] = {
+        {"50", 50.0}, {"75", 75.0}, {"90", 90.0}, {"99", 99.0}, {"99.9", 99.9},
+    };
+    for (const auto& point : percentile_points) {
+        if (!JS_DefineProperty(cx, percentiles, point.name,
+                               us_to_ms(delay.percentile(point.value)),
+                               JSPROP_ENUMERATE))
+            return false;
+    }
+
+    if (!JS_DefineProperty(cx, retval, "count", double(delay.count()),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "min", us_to_ms(delay.min()),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "max", us_to_ms(delay.max()),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "mean", us_to_ms(delay.mean()),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "stddev", us_to_ms(delay.stddev()),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "resolution",
+                           us_to_ms(monitor->resolution()), JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "percentiles", percentiles,
+                           JSPROP_ENUMERATE))
+        return false;
+
+    args.rval().setObject(*retval);
+    return true;
+}
+
+// Returns idle and active time in milliseconds since the monitor was started
+// or reset, and the ratio of active time to elapsed time
+static bool gjs_get_event_loop_utilization(JSContext* cx, unsigned argc,
+                                           JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "getEventLoopUtilization", args, ""))
+        return false;
+
+    Gjs::EventLoopMonitor* monitor =
+        GjsContextPrivate::from_cx(cx)->event_loop_monitor();
+    int64_t elapsed = monitor ? monitor->elapsed() : 0;
+    int64_t idle = monitor ? std::min(monitor->idle(), elapsed) : 0;
+    int64_t active = elapsed - idle;
+
+    JS::RootedObject retval{cx, JS_NewPlainObject(cx)};
+    if (!retval ||
+        !JS_DefineProperty(cx, retval, "idle", us_to_ms(idle),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "active", us_to_ms(active),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "utilization",
+                           elapsed > 0 ? double(active) / elapsed : 0.0,
+                           JSPROP_ENUMERATE))
+        return false;
+
+    args.rval().setObject(*retval);
+    return true;
+}
+
+GJS_JSAPI_RETURN_CONVENTION
+static bool define_event_loop_metrics(JSContext* cx, JS::HandleObject metrics) {
+    Gjs::EventLoopMonitor* monitor =
+        GjsContextPrivate::from_cx(cx)->event_loop_monitor();
+    if (!monitor)
+        return JS_DefineProperty(cx, metrics, "eventLoop", JS::NullHandleValue,
+                                 JSPROP_ENUMERATE);
+
+    const Gjs::Histogram& delay = monitor->delay();
+    int64_t elapsed = monitor->elapsed();
+    int64_t idle = std::min(monitor->idle(), elapsed);
+    int64_t active = elapsed - idle;
+
+    JS::RootedObject event_loop{cx, JS_NewPlainObject(cx)};
+    return event_loop &&
+           JS_DefineProperty(cx, event_loop, "delayCount",
+                             double(delay.count()), JSPROP_ENUMERATE) &&
+           JS_DefineProperty(cx, event_loop, "delayMean",
+                             us_to_ms(delay.mean()), JSPROP_ENUMERATE) &&
+           JS_DefineProperty(cx, event_loop, "delayMax", us_to_ms(delay.max()),
+                             JSPROP_ENUMERATE) &&
+           JS_DefineProperty(cx, event_loop, "delayP99",
+                             us_to_ms(delay.percentile(99.0)),
+                             JSPROP_ENUMERATE) &&
+           JS_DefineProperty(cx, event_loop, "idle", us_to_ms(idle),
+                             JSPROP_ENUMERATE) &&
+           JS_DefineProperty(cx, event_loop, "active", us_to_ms(active),
+                             JSPROP_ENUMERATE) &&
+           JS_DefineProperty(cx, event_loop, "utilization",
+                             elapsed > 0 ? double(active) / elapsed : 0.0,
+                             JSPROP_ENUMERATE) &&
+           JS_DefineProperty(cx, metrics, "eventLoop", event_loop,
+                             JSPROP_ENUMERATE);
+}
+
+// Returns a snapshot of the runtime's counters as a tree of plain objects with
+// number values, for scraping by monitoring tools. The property names are
+// static strings, so taking a snapshot formats nothing.
+static bool gjs_get_metrics(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "getMetrics", args, ""))
+        return false;
+
+    int64_t gc_counters[Gjs::GCCounters::N_COUNTERS];
+    JS::RootedObject gc_info{cx, js::gc::NewMemoryInfoObject(cx)};
+    if (!gc_info || !get_gc_counters(cx, gc_info, gc_counters))
+        return false;
+
+    JS::RootedObject retval{cx, JS_NewPlainObject(cx)};
+    JS::RootedObject counters{cx, JS_NewPlainObject(cx)};
+    JS::RootedObject gc{cx, JS_NewPlainObject(cx)};
+    if (!retval || !counters || !gc)
+        return false;
+
+#define DEFINE_COUNTER(name, ix)                                     \
+    if (!JS_DefineProperty(cx, counters, #name,                      \
+                           double(GJS_GET_COUNTER(name)),            \
+                           JSPROP_ENUMERATE))                        \
+        return false;
+    DEFINE_COUNTER(everything, -1)
+    GJS_FOR_EACH_COUNTER(DEFINE_COUNTER)
+#undef DEFINE_COUNTER
+
+    auto* gjs = GjsContextPrivate::from_cx(cx);
+    if (!JS_DefineProperty(cx, gc, "heapBytes",
+                           double(gc_counters[Gjs::GCCounters::GC_HEAP_BYTES]),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(
+            cx, gc, "mallocBytes",
+            double(gc_counters[Gjs::GCCounters::MALLOC_HEAP_BYTES]),
+            JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, gc, "majorCount",
+                           JS_GetGCParameter(cx, JSGC_MAJOR_GC_NUMBER),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, gc, "minorCount",
+                           JS_GetGCParameter(cx, JSGC_MINOR_GC_NUMBER),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "counters", counters,
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "gc", gc, JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "wrappedGObjects",
+                           double(ObjectInstance::num_wrapped_gobjects()),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "toggleQueueLength",
+                           double(ToggleQueue::get_default()->size()),
+                           JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, retval, "pendingMicrotasks",
+                           double(gjs->pending_jobs()), JSPROP_ENUMERATE) ||
+        !define_event_loop_metrics(cx, retval))
+        return false;
+
+    args.rval().setObject(*retval);
+    return true;
+}
+
+static bool gjs_start_signal_stats(JSContext* cx, unsigned argc,
+                                   JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "startSignalStats", args, ""))
+        return false;
+
+    GjsContextPrivate::from_cx(cx)->signal_stats(/* create = */ true)->start();
+
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool gjs_stop_signal_stats(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "stopSignalStats", args, ""))
+        return false;
+
+    Gjs::SignalStats* stats = GjsContextPrivate::from_cx(cx)->signal_stats();
+    if (stats)
+        stats->stop();
+
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool gjs_reset_signal_stats(JSContext* cx, unsigned argc,
+                                   JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "resetSignalStats", args, ""))
+        return false;
+
+    Gjs::SignalStats* stats = GjsContextPrivate::from_cx(cx)->signal_stats();
+    if (stats)
+        stats->reset();
+
+    args.rval().setUndefined();
+    return true;
+}
+
+static double duration_to_ms(Gjs::SignalStats::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Returns an array with the statistics of each signal, most handler time
+// first, or null if they were never started
+static bool gjs_get_signal_stats(JSContext* cx, unsigned argc, JS::Value* vp) {
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    if (!gjs_parse_call_args(cx, "getSignalStats", args, ""))
+        return false;
+
+    Gjs::SignalStats* stats = GjsContextPrivate::from_cx(cx)->signal_stats();
+    if (!stats) {
+        args.rval().setNull();
+        return true;
+    }
+
+    std::vector<const Gjs::SignalStats::Entry*> entries =
+        stats->sorted_entries();
+    JS::RootedObject retval{cx, JS::NewArrayObject(cx, entries.size())};
+    if (!retval)
+        return false;
+
+    JS::RootedObject item{cx};
+    JS::RootedString type_name{cx}, signal_name{cx};
+    for (size_t ix = 0; ix < entries.size(); ix++) {
+        const Gjs::SignalStats::Entry* entry = entries[ix];
+        item = JS_NewPlainObject(cx);
+        type_name = JS_NewStringCopyZ(cx, entry->type_name.c_str());
+        signal_name = JS_NewStringCopyZ(cx, entry->signal_name.c_str());
+        if (!item || !type_name || !signal_name ||
+            !JS_DefineProperty(cx, item, "type", type_name, JSPROP_ENUMERATE) ||
+            !JS_DefineProperty(cx, item, "signal", signal_name,
+                               JSPROP_ENUMERATE) ||
+            !JS_DefineProperty(cx, item, "emissions", double(entry->emissions),
+                               JSPROP_ENUMERATE) ||
+            !JS_DefineProperty(cx, item, "emissionTime",
+                               duration_to_ms(entry->emission_time),
+                               JSPROP_ENUMERATE) ||
+            !JS_DefineProperty(cx, item, "handlerCalls",
+                               double(entry->handler_calls),
+                               JSPROP_ENUMERATE) ||
+            !JS_DefineProperty(cx, item, "handlerTime",
+                               duration_to_ms(entry->handler_time),
+                               JSPROP_ENUMERATE) ||
+            !JS_DefineElement(cx, retval, ix, item, JSPROP_ENUMERATE))
+            return false;
+    }
+
+    args.rval().setObject(*retval);
+    return true;
+}
+
 static JSFunctionSpec module_funcs[] = {
     JS_FN("addressOf", gjs_address_of, 1, GJS_MODULE_PROP_FLAGS),
     JS_FN("addressOfGObject", gjs_address_of_gobject, 1, GJS_MODULE_PROP_FLAGS),
@@ -257,9 +625,25 @@ static JSFunctionSpec module_funcs[] = {
     JS_FN("breakpoint", gjs_breakpoint, 0, GJS_MODULE_PROP_FLAGS),
     JS_FN("dumpHeap", gjs_dump_heap, 1, GJS_MODULE_PROP_FLAGS),
     JS_FN("dumpMemoryInfo", gjs_dump_memory_info, 0, GJS_MODULE_PROP_FLAGS),
+    JS_FN("dumpCallStats", gjs_dump_call_stats, 0, GJS_MODULE_PROP_FLAGS),
     JS_FN("gc", gjs_gc, 0, GJS_MODULE_PROP_FLAGS),
     JS_FN("exit", gjs_exit, 0, GJS_MODULE_PROP_FLAGS),
     JS_FN("clearDateCaches", gjs_clear_date_caches, 0, GJS_MODULE_PROP_FLAGS),
+    JS_FN("startEventLoopMonitor", gjs_start_event_loop_monitor, 0,
+          GJS_MODULE_PROP_FLAGS),
+    JS_FN("stopEventLoopMonitor", gjs_stop_event_loop_monitor, 0,
+          GJS_MODULE_PROP_FLAGS),
+    JS_FN("resetEventLoopMonitor", gjs_reset_event_loop_monitor, 0,
+          GJS_MODULE_PROP_FLAGS),
+    JS_FN("getEventLoopDelay", gjs_get_event_loop_delay, 0,
+          GJS_MODULE_PROP_FLAGS),
+    JS_FN("getEventLoopUtilization", gjs_get_event_loop_utilization, 0,
+          GJS_MODULE_PROP_FLAGS),
+    JS_FN("getMetrics", gjs_get_metrics, 0, GJS_MODULE_PROP_FLAGS),
+    JS_FN("startSignalStats", gjs_start_signal_stats, 0, GJS_MODULE_PROP_FLAGS),
+    JS_FN("stopSignalStats", gjs_stop_signal_stats, 0, GJS_MODULE_PROP_FLAGS),
+    JS_FN("resetSignalStats", gjs_reset_signal_stats, 0, GJS_MODULE_PROP_FLAGS),
+    JS_FN("getSignalStats", gjs_get_signal_stats, 0, GJS_MODULE_PROP_FLAGS),
     JS_FS_END};
 
 static bool get_program_args(JSContext* cx, unsigned argc, JS::Value* vp) {
@@ -7,6 +7,11 @@
 #include <stdint.h>
 #include <string.h>  // for size_t, strlen
 
+#ifdef HAVE_SIGNAL_H
+#    include <signal.h>  // for siginfo_t, SIGUSR2
+#endif
+
+#include <chrono>
 #include <limits>
 #include <random>
 #include <string>  // for u16string, u32string
@@ -42,6 +47,7 @@
 #include "gjs/error-types.h"
 #include "gjs/gerror-result.h"
 #include "gjs/jsapi-util.h"
+#include "gjs/profiler-private.h"
 #include "gjs/profiler.h"
 #include "test/gjs-test-no-introspection-object.h"
 #include "test/gjs-test-utils.h"
@@ -231,6 +237,32 @@ static void gjstest_test_func_gjs_context_exit() {
     g_assert_cmpuint(status, ==, 42);
 }
 
+static void gjstest_test_func_gjs_context_destroy_with_thread_call() {
+    AutoError error;
+    int status;
+
+    {
+        AutoUnref<GjsContext> gjs_context{gjs_context_new()};
+        // Leave the call in flight by exiting instead of waiting for it
+        static const char testjs[] = R"js(
+            const {GLib} = imports.gi;
+            GLib.usleep.callInThread(200000).then(() => {
+                throw new Error('should not complete');
+            });
+            imports.system.exit(0);
+        )js";
+        bool ok = gjs_context_eval(gjs_context, testjs, -1, "<input>", &status,
+                                   &error);
+        g_assert_false(ok);
+        g_assert_error(error, GJS_ERROR, GJS_ERROR_SYSTEM_EXIT);
+    }
+
+    // The call completes after the context is gone
+    g_usleep(400000);
+    while (g_main_context_pending(nullptr))
+        g_main_context_iteration(nullptr, false);
+}
+
 static void gjstest_test_func_gjs_context_eval_module_file() {
     AutoUnref<GjsContext> gjs_context{gjs_context_new()};
     uint8_t exit_status;
@@ -937,6 +969,60 @@ static void gjstest_test_profiler_start_stop() {
         g_message("Temp profiler file not deleted");
 }
 
+#ifdef ENABLE_PROFILER
+static void gjstest_test_profiler_rotation() {
+    AutoChar tmpdir{g_dir_make_tmp("gjs-profiler-XXXXXX", nullptr)};
+    g_assert_nonnull(tmpdir);
+    AutoChar filename{g_build_filename(tmpdir, "rotate.syscap", nullptr)};
+
+    AutoUnref<GjsContext> gjs_context{GJS_CONTEXT(
+        g_object_new(GJS_TYPE_CONTEXT, "profiler-enabled", TRUE, nullptr))};
+    GjsProfiler* profiler = gjs_context_get_profiler(gjs_context);
+
+    gjs_profiler_set_filename(profiler, filename);
+    gjs_profiler_set_rotation(profiler, std::chrono::seconds{60}, 1);
+    gjs_profiler_start(profiler);
+
+    static const char testjs[] = "[1,5,7,1,2,3,67,8].sort()";
+    for (size_t ix = 0; ix < 100; ix++) {
+        AutoError error;
+        int estatus;
+        if (!gjs_context_eval(gjs_context, testjs, -1, "<input>", &estatus,
+                              &error))
+            g_printerr("ERROR: %s", error->message);
+    }
+
+    // Each SIGUSR2 finishes a capture file and writes a window of the kept ones
+    siginfo_t info = {};
+    info.si_signo = SIGUSR2;
+    for (size_t ix = 0; ix < 3; ix++)
+        g_assert_true(gjs_profiler_chain_signal(gjs_context, &info));
+    g_assert_true(gjs_profiler_is_running(profiler));
+
+    gjs_profiler_stop(profiler);
+
+    // One finished file and the one being written are kept, plus the windows
+    unsigned n_captures = 0, n_windows = 0;
+    GDir* dir = g_dir_open(tmpdir, 0, nullptr);
+    g_assert_nonnull(dir);
+    while (const char* name = g_dir_read_name(dir)) {
+        if (g_str_has_suffix(name, "-window.syscap"))
+            n_windows++;
+        else
+            n_captures++;
+        g_assert_true(g_str_has_prefix(name, "rotate-"));
+
+        AutoChar path{g_build_filename(tmpdir, name, nullptr)};
+        g_unlink(path);
+    }
+    g_dir_close(dir);
+    g_rmdir(tmpdir);
+
+    g_assert_cmpuint(n_captures, ==, 2);
+    g_assert_cmpuint(n_windows, >=, 1);
+}
+#endif  // ENABLE_PROFILER
+
 static void gjstest_test_safe_integer_max(GjsUnitTestFixture* fx, const void*) {
     JS::RootedObject number_class_object(fx->cx);
     JS::RootedValue safe_value(fx->cx);
@@ -1255,6 +1341,8 @@ int main(int argc, char* argv[]) {
     g_test_add_func("/gjs/context/eval/non-zero-terminated",
                     gjstest_test_func_gjs_context_eval_non_zero_terminated);
     g_test_add_func("/gjs/context/exit", gjstest_test_func_gjs_context_exit);
+    g_test_add_func("/gjs/context/destroy-with-thread-call",
+                    gjstest_test_func_gjs_context_destroy_with_thread_call);
     g_test_add_func("/gjs/context/eval-module-file",
                     gjstest_test_func_gjs_context_eval_module_file);
     g_test_add_func("/gjs/context/eval-module-file/throw",
@@ -1287,6 +1375,9 @@ int main(int argc, char* argv[]) {
                     gjstest_test_func_gjs_gobject_without_introspection);
     g_test_add_func("/gjs/profiler/start_stop",
                     gjstest_test_profiler_start_stop);
+#ifdef ENABLE_PROFILER
+    g_test_add_func("/gjs/profiler/rotation", gjstest_test_profiler_rotation);
+#endif
     g_test_add_func("/util/misc/strv/concat/null",
                     gjstest_test_func_util_misc_strv_concat_null);
     g_test_add_func("/util/misc/strv/concat/pointers",